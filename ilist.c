@@ -0,0 +1,354 @@
+/***************************************************************
+ * Implementation of an intrusive list: items embed their own  *
+ * links, so the list never allocates                          *
+ ***************************************************************/
+
+/***************************************************************
+ * Imports                                                     *
+ ***************************************************************/
+#include "ilist.h"
+#include <stdlib.h>
+
+/***************************************************************
+ * Defines                                                     *
+ ***************************************************************/
+#define LIST_IS_EMPTY				(list->size == 0)
+#define CURRENT_NODE_BEYOND_START	(list->currentIsBeyond == -1)
+#define CURRENT_NODE_BEYOND_END		(list->currentIsBeyond == 1)
+#define CURRENT_NODE_IS_HEAD		(list->current == list->head)
+#define CURRENT_NODE_IS_TAIL		(list->current == list->tail)
+
+/***************************************************************
+ * Statics                                                     *
+ ***************************************************************/
+static void linkAfter(ILIST *list, ILIST_LINK *pre, ILIST_LINK *link);
+static void detachLink(ILIST *list, ILIST_LINK *link);
+
+/***************************************************************
+ * Global Functions                                            *
+ ***************************************************************/
+
+/**
+ * Sets up an empty list in memory provided by the caller.
+ */
+void IListInit(ILIST *list) {
+	if (list == NULL) {
+		return;
+	}
+
+	list->current = NULL;
+	list->head = NULL;
+	list->tail = NULL;
+	list->size = 0;
+	list->currentIsBeyond = 0;
+}
+
+/**
+ * Returns the number of items in the list.
+ */
+int IListCount(ILIST *list) {
+	if (list != NULL) {
+		return list->size;
+	} else {
+		return 0;
+	}
+}
+
+/**
+ * Returns the first link in the list and makes it the current one.
+ * Returns NULL if the list is empty.
+ */
+ILIST_LINK *IListFirst(ILIST *list) {
+	if (list == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	list->current = list->head;
+	list->currentIsBeyond = 0;
+	return list->current;
+}
+
+/**
+ * Returns the last link in the list and makes it the current one.
+ * Returns NULL if the list is empty.
+ */
+ILIST_LINK *IListLast(ILIST *list) {
+	if (list == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	list->current = list->tail;
+	list->currentIsBeyond = 0;
+	return list->current;
+}
+
+/**
+ * Increments the current link.
+ * Returns the new current link, or NULL if it advances beyond the end of the list.
+ */
+ILIST_LINK *IListNext(ILIST *list) {
+	if (list == NULL) {
+		return NULL;
+	}
+
+	if (CURRENT_NODE_BEYOND_END || CURRENT_NODE_IS_TAIL || LIST_IS_EMPTY) {
+		list->current = NULL;
+		list->currentIsBeyond = 1;
+		return NULL;
+	}
+
+	list->current = CURRENT_NODE_BEYOND_START ? list->head : list->current->next;
+	list->currentIsBeyond = 0;
+	return list->current;
+}
+
+/**
+ * Decrements the current link.
+ * Returns the new current link, or NULL if it advances beyond the start of the list.
+ */
+ILIST_LINK *IListPrev(ILIST *list) {
+	if (list == NULL) {
+		return NULL;
+	}
+
+	if (CURRENT_NODE_BEYOND_START || CURRENT_NODE_IS_HEAD) {
+		list->current = NULL;
+		list->currentIsBeyond = -1;
+		return NULL;
+	}
+
+	list->current = CURRENT_NODE_BEYOND_END ? list->tail : list->current->previous;
+	list->currentIsBeyond = 0;
+	return list->current;
+}
+
+/**
+ * Returns the current link in the list
+ */
+ILIST_LINK *IListCurr(ILIST *list) {
+	if (list == NULL || LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START || CURRENT_NODE_BEYOND_END) {
+		return NULL;
+	}
+	return list->current;
+}
+
+/**
+ * Adds the link to the list directly after the current link and makes it the current one.
+ * If the current pointer is before the start of the list, the link is added to the start.
+ * If the current pointer is after the end of the list, the link is added to the end.
+ * Returns 0 if successful, -1 if failed.
+ */
+int IListAdd(ILIST *list, ILIST_LINK *link) {
+	if (list == NULL || link == NULL) {
+		return -1;
+	}
+
+	if (CURRENT_NODE_BEYOND_START) {
+		linkAfter(list, NULL, link);
+	} else if (CURRENT_NODE_BEYOND_END || list->current == NULL) {
+		linkAfter(list, list->tail, link);
+	} else {
+		linkAfter(list, list->current, link);
+	}
+	return 0;
+}
+
+/**
+ * Adds the link to the list directly before the current link and makes it the current one.
+ * If the current pointer is before the start of the list, the link is added to the start.
+ * If the current pointer is after the end of the list, the link is added to the end.
+ * Returns 0 if successful, -1 if failed
+ */
+int IListInsert(ILIST *list, ILIST_LINK *link) {
+	if (list == NULL || link == NULL) {
+		return -1;
+	}
+
+	if (CURRENT_NODE_BEYOND_END) {
+		linkAfter(list, list->tail, link);
+	} else if (CURRENT_NODE_BEYOND_START || list->current == NULL) {
+		linkAfter(list, NULL, link);
+	} else {
+		linkAfter(list, list->current->previous, link);
+	}
+	return 0;
+}
+
+/**
+ * Adds the link to the end of the list and makes it the current one.
+ * Returns 0 if successful, -1 if failed.
+ */
+int IListAppend(ILIST *list, ILIST_LINK *link) {
+	if (list == NULL || link == NULL) {
+		return -1;
+	}
+
+	linkAfter(list, list->tail, link);
+	return 0;
+}
+
+/**
+ * Adds the link to the front of the list and makes it the current one.
+ * Returns 0 on success, -1 on failure.
+ */
+int IListPrepend(ILIST *list, ILIST_LINK *link) {
+	if (list == NULL || link == NULL) {
+		return -1;
+	}
+
+	linkAfter(list, NULL, link);
+	return 0;
+}
+
+/**
+ * Return the current link and take it out of the list.
+ * Make the next link the current one, or the new last link if the last link was removed.
+ */
+ILIST_LINK *IListRemove(ILIST *list) {
+	if (list == NULL || LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START || CURRENT_NODE_BEYOND_END) {
+		return NULL;
+	}
+
+	ILIST_LINK *link = list->current;
+	list->current = link->next != NULL ? link->next : link->previous;
+	detachLink(list, link);
+	return link;
+}
+
+/**
+ * Adds list2 to the end of list1.
+ * The current pointer is set to the current pointer of list1.
+ * List2 is left empty.
+ */
+void IListConcat(ILIST *list1, ILIST *list2) {
+	if (list1 == NULL || list2 == NULL || list1 == list2) {
+		return;
+	}
+
+	if (list1->size == 0 && list2->size > 0) {
+		list1->head = list2->head;
+		list1->tail = list2->tail;
+		list1->current = list2->current;
+		list1->currentIsBeyond = 0;
+	} else if (list2->size > 0) {
+		list1->tail->next = list2->head;
+		list2->head->previous = list1->tail;
+		list1->tail = list2->tail;
+	}
+	list1->size += list2->size;
+
+	IListInit(list2);
+}
+
+/**
+ * Empties the list.
+ * LinkFree is a pointer to a routine that frees the object a link is embedded in,
+ * invoked as (* linkFree)(link) for each link. It may be NULL.
+ */
+void IListFree(ILIST *list, void (*linkFree)(ILIST_LINK *)) {
+	if (list == NULL) {
+		return;
+	}
+
+	ILIST_LINK *link = list->head;
+	while (link != NULL) {
+		ILIST_LINK *next = link->next;
+		link->previous = NULL;
+		link->next = NULL;
+		if (linkFree != NULL) {
+			(* linkFree)(link);
+		}
+		link = next;
+	}
+
+	IListInit(list);
+}
+
+/**
+ * Return the last link and take it out of the list.
+ * Make the new last link the current one.
+ */
+ILIST_LINK *IListTrim(ILIST *list) {
+	if (list == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	ILIST_LINK *link = list->tail;
+	list->current = link->previous;
+	detachLink(list, link);
+	return link;
+}
+
+/**
+ * Searches the list starting at the current link until the end is reached or a match is found.
+ * Comparator is invoked with a link and comparisonArg, and returns 1 if they match, 0 if not.
+ * If a match is found, it becomes the current link and is returned.
+ * If no match is found, the current pointer is left beyond the end of the list and NULL is returned.
+ */
+ILIST_LINK *IListSearch(ILIST *list, int (*comparator)(ILIST_LINK *, void *), void *comparisonArg) {
+	if (list == NULL || comparator == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	ILIST_LINK *link = CURRENT_NODE_BEYOND_START ? list->head : list->current;
+	for (; link != NULL; link = link->next) {
+		if ((* comparator)(link, comparisonArg) == 1) {
+			list->current = link;
+			list->currentIsBeyond = 0;
+			return link;
+		}
+	}
+
+	list->current = NULL;
+	list->currentIsBeyond = 1;
+	return NULL;
+}
+
+/***************************************************************
+ * Static Functions                                            *
+ ***************************************************************/
+
+/**
+ * Links a link in after pre, or at the start of the list for a NULL pre, and makes it current
+ */
+static void linkAfter(ILIST *list, ILIST_LINK *pre, ILIST_LINK *link) {
+	ILIST_LINK *post = pre != NULL ? pre->next : list->head;
+
+	link->previous = pre;
+	link->next = post;
+	if (pre != NULL) {
+		pre->next = link;
+	} else {
+		list->head = link;
+	}
+	if (post != NULL) {
+		post->previous = link;
+	} else {
+		list->tail = link;
+	}
+
+	list->current = link;
+	list->currentIsBeyond = 0;
+	list->size++;
+}
+
+/**
+ * Takes a link out of the list, leaving the current pointer alone
+ */
+static void detachLink(ILIST *list, ILIST_LINK *link) {
+	if (link->previous != NULL) {
+		link->previous->next = link->next;
+	} else {
+		list->head = link->next;
+	}
+	if (link->next != NULL) {
+		link->next->previous = link->previous;
+	} else {
+		list->tail = link->previous;
+	}
+
+	link->previous = NULL;
+	link->next = NULL;
+	list->currentIsBeyond = 0;
+	list->size--;
+}
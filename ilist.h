@@ -0,0 +1,54 @@
+#ifndef _ILIST_H_
+#define _ILIST_H_
+
+#include <stddef.h>
+
+/**
+ * Intrusive lists: callers embed an ILIST_LINK in their own objects and the list links
+ * those directly, so adding an item allocates nothing and reaching it follows no item pointer.
+ * The list head can live in the caller's memory too, set up with IListInit.
+ * Operations have the same semantics as the LIST operations of the same names, with
+ * links in place of items. A link can only be on one list at a time.
+ */
+
+/**
+ * Returns a pointer to the object of the given type that embeds link as the named member
+ */
+#define ILIST_ENTRY(link, type, member)	((type *)((char *)(link) - offsetof(type, member)))
+
+/**
+ * Structs
+ */
+typedef struct ILIST_LINK {
+	struct ILIST_LINK *previous;
+	struct ILIST_LINK *next;
+} ILIST_LINK;
+typedef struct ILIST {
+	ILIST_LINK *current;
+	ILIST_LINK *head;
+	ILIST_LINK *tail;
+	int size;
+	int currentIsBeyond; // 0 if current is not beyond the list boundaries, -1 if before, 1 if after
+} ILIST;
+
+/**
+ * Function prototypes
+ */
+void IListInit(ILIST *list);
+int IListCount(ILIST *list);
+ILIST_LINK *IListFirst(ILIST *list);
+ILIST_LINK *IListLast(ILIST *list);
+ILIST_LINK *IListNext(ILIST *list);
+ILIST_LINK *IListPrev(ILIST *list);
+ILIST_LINK *IListCurr(ILIST *list);
+int IListAdd(ILIST *list, ILIST_LINK *link);
+int IListInsert(ILIST *list, ILIST_LINK *link);
+int IListAppend(ILIST *list, ILIST_LINK *link);
+int IListPrepend(ILIST *list, ILIST_LINK *link);
+ILIST_LINK *IListRemove(ILIST *list);
+void IListConcat(ILIST *list1, ILIST *list2);
+void IListFree(ILIST *list, void (*linkFree)(ILIST_LINK *));
+ILIST_LINK *IListTrim(ILIST *list);
+ILIST_LINK *IListSearch(ILIST *list, int (*comparator)(ILIST_LINK *, void *), void *comparisonArg);
+
+#endif /* _ILIST_H_ */
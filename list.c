@@ -11,59 +11,974 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#ifdef LIST_THREAD_SAFE
+#include <pthread.h>
+#endif
+#ifdef LIST_LATENCY_HISTOGRAMS
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
 
 /***************************************************************
  * Defines                                                     *
  ***************************************************************/
-#define NODE_POOL_SIZE 100
-#define LIST_POOL_SIZE 10
+#define NODE_SLAB_BYTES (64 * 1024)
+#define NODES_PER_SLAB ((NODE_SLAB_BYTES - offsetof(NODE_SLAB, nodes)) / sizeof(NODE))
+#define LIST_SLAB_BYTES (4 * 1024)
+#define LISTS_PER_SLAB ((LIST_SLAB_BYTES - offsetof(LIST_SLAB, lists)) / sizeof(LIST))
+#define MAX_NODE_SLABS (1 << 16)
+#define MAX_LIST_SLABS (1 << 16)
+#define MAGAZINE_SIZE 64
+#define MAGAZINE_BATCH (MAGAZINE_SIZE / 2)
+#define SKIP_MAX_LEVELS 14
+#define SKIP_BRANCHING_BITS 2 // Each level holds 1 in 2^SKIP_BRANCHING_BITS towers of the level below
+#define HASH_MIN_BUCKETS 16
+#define HASH_LABEL_STEP ((uint64_t)1 << 32) // Gap left between order labels when there is room
+#define HASH_LABEL_MIDDLE ((uint64_t)1 << 63)
+#define SORT_MAX_THREADS 16
+#define SORT_MIN_CHUNK_NODES (16 * 1024) // Shorter chunks are not worth a thread
+#define SORT_MAX_RUNS 32 // Enough pending runs for any int sized list
+#define EPOCH_MIN_RUNS 16
+#define SERIAL_MAGIC "LSER"
+#define SERIAL_VERSION 1
+#define SERIAL_MAX_IOVECS 1024 // Linux's IOV_MAX
+#define SERIAL_LOAD_BATCH 256 // Items decoded before they are appended as one run
+#define SERIAL_PADDING(length) ((8 - (length) % 8) % 8)
+#define LOG_MIN_BUFFER 4096
+#define LOG_APPEND 1
+#define LOG_PREPEND 2
+#define LOG_INSERT 3 // At the position in arg
+#define LOG_REMOVE 4 // The item at the position in arg
+#define LOG_TRIM 5
+#define LOG_CONCAT 6 // The list whose id is in arg
+#define LOG_FREE 7
+#define LOG_CLEAR 8 // Empties the list, ahead of a snapshot of its items
+#define LATENCY_SUB_BITS 2 // Each power of 2 of latency is split into 2^LATENCY_SUB_BITS buckets
+#define LATENCY_BUCKETS ((65 - LATENCY_SUB_BITS) << LATENCY_SUB_BITS)
+#define LATENCY_CALIBRATION_NS 1000000 // Time spent measuring the tick rate before converting to nanoseconds
 
-#define NODE_POOL_FULL				(numNodesAvailable <= 0)
-#define LIST_POOL_FULL				(numListsAvailable <= 0)
+/* The lock-free build replaces magazines and the available node stack with a Treiber stack */
+#if defined(LIST_THREAD_SAFE) && !defined(LIST_LOCK_FREE)
+#define USE_MAGAZINES
+#endif
+
+/* File-backed pools need links that survive remapping, and a free list that holds still while it is saved */
+#if defined(LIST_COMPACT_NODES) && !defined(LIST_LOCK_FREE)
+#define USE_FILE_POOLS
+#define POOL_MAGIC "LISTPOOL"
+#define POOL_VERSION 1
+#define POOL_COPIES_MAGIC "LISTROOT"
+#define POOL_COPIES_SUFFIX ".roots"
+#endif
+
+/* The top of the lock-free free list packs an ABA tag with the top node's index + 1 (0 when empty) */
+#define FREE_TOP(tag, nodeIndexPlusOne)	(((uint64_t)(tag) << 32) | (uint32_t)(nodeIndexPlusOne))
+#define FREE_TOP_TAG(top)				((uint32_t)((top) >> 32))
+#define FREE_TOP_INDEX(top)				((int)(uint32_t)(top))
+
+#ifdef LIST_THREAD_SAFE
+#define LOCK_CONTEXT(context)		pthread_mutex_lock(&(context)->lock)
+#define UNLOCK_CONTEXT(context)		pthread_mutex_unlock(&(context)->lock)
+#define LOCK_LOG(log)				pthread_mutex_lock(&(log)->lock)
+#define UNLOCK_LOG(log)				pthread_mutex_unlock(&(log)->lock)
+#else
+#define LOCK_CONTEXT(context)
+#define UNLOCK_CONTEXT(context)
+#define LOCK_LOG(log)
+#define UNLOCK_LOG(log)
+#endif
+
+/* Nodes waiting for readers count towards a node limit; RECLAIM_RETIRED needs the context locked */
+#ifdef LIST_THREAD_SAFE
+#define EPOCH_RECLAIM(context)		((context)->config.epochReclaim)
+#define RECLAIM_RETIRED(context)	(advanceEpoch(context) + advanceEpoch(context))
+#else
+#define EPOCH_RECLAIM(context)		0
+#define RECLAIM_RETIRED(context)	0
+#endif
+
+#define NODE_POOL_EMPTY(context)	((context)->numNodesAvailable <= 0)
+#define LIST_POOL_EMPTY(context)	((context)->numListsAvailable <= 0)
+#define NODES_IN_USE(context)		((context)->numNodeSlabs * (int)NODES_PER_SLAB - (context)->numNodesAvailable)
+#define LISTS_IN_USE(context)		((context)->numListSlabs * (int)LISTS_PER_SLAB - (context)->numListsAvailable)
 #define LIST_IS_EMPTY				(list->size == 0)
 #define CURRENT_NODE_BEYOND_START	(list->currentIsBeyond == -1)
 #define CURRENT_NODE_BEYOND_END		(list->currentIsBeyond == 1)
 #define CURRENT_NODE_IS_HEAD		(list->current == list->head)
 #define CURRENT_NODE_IS_TAIL		(list->current == list->tail)
 
+/* A list's currentIndex is unknown after jumping straight to a node, until something needs it */
+#define POSITION_UNKNOWN				(-2)
+#define POSITION_AFTER(position, offset)	((position) == POSITION_UNKNOWN ? POSITION_UNKNOWN : (position) + (offset))
+
+/* Links that epoch readers follow are published with release stores in the thread-safe build */
+#ifdef LIST_THREAD_SAFE
+#define LOAD_SHARED(field)			__atomic_load_n(&(field), __ATOMIC_ACQUIRE)
+#define STORE_SHARED(field, value)	__atomic_store_n(&(field), (value), __ATOMIC_RELEASE)
+#else
+#define LOAD_SHARED(field)			(field)
+#define STORE_SHARED(field, value)	((field) = (value))
+#endif
+
+/* Node links are pointers, or pool indices + 1 in the compact build; NEXT and PREVIOUS need a list in scope */
+#ifdef LIST_COMPACT_NODES
+#define NEXT(node)					nodeOf(list->context, LOAD_SHARED((node)->next))
+#define PREVIOUS(node)				nodeOf(list->context, LOAD_SHARED((node)->previous))
+#else
+#define NEXT(node)					LOAD_SHARED((node)->next)
+#define PREVIOUS(node)				LOAD_SHARED((node)->previous)
+#endif
+#define SET_NEXT(node, target)		STORE_SHARED((node)->next, linkOf(target))
+#define SET_PREVIOUS(node, target)	STORE_SHARED((node)->previous, linkOf(target))
+#define SET_HEAD(list, node)		STORE_SHARED((list)->head, (node))
+#define SET_TAIL(list, node)		STORE_SHARED((list)->tail, (node))
+#define NOTE_EDIT(list)				STORE_SHARED((list)->edits, (list)->edits + 1)
+
+/* Statistics counters live in a block private to the calling thread, so counting never contends */
+#ifdef LIST_NO_STATS
+#define COUNT_CALL(op)
+#define COUNT_POOL_EXHAUSTED(op)
+#define COUNT_VISITS(numNodes)		((void)(numNodes))
+#define COUNT_SKIP_REBUILD()		((void)0)
+#define NULL_ARGS(op, condition)	(condition)
+#define NOTE_PEAK(peak, value)
+#else
+#ifdef LIST_THREAD_SAFE
+#define THREAD_STATS				(threadStats.registered ? &threadStats : registerThreadStats())
+#define STATS_ADD(counter, n)		__atomic_store_n(&(counter), (counter) + (n), __ATOMIC_RELAXED)
+#define STATS_LOAD(counter)			__atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#else
+#define THREAD_STATS				(&threadStats)
+#define STATS_ADD(counter, n)		((counter) += (n))
+#define STATS_LOAD(counter)			(counter)
+#endif
+#ifdef LIST_LATENCY_HISTOGRAMS
+#define COUNT_CALL(op)				STATS_ADD(THREAD_STATS->calls[op], 1); \
+	LATENCY_TIMER latencyTimer __attribute__((cleanup(stopLatencyTimer))) = { (op), LATENCY_TICKS() }
+#else
+#define COUNT_CALL(op)				STATS_ADD(THREAD_STATS->calls[op], 1)
+#endif
+#define COUNT_POOL_EXHAUSTED(op)	STATS_ADD(THREAD_STATS->poolFailures[op], 1)
+#define COUNT_VISITS(numNodes)		STATS_ADD(THREAD_STATS->searchNodesVisited, (numNodes))
+#define COUNT_SKIP_REBUILD()		STATS_ADD(THREAD_STATS->skipIndexRebuilds, 1)
+#define NULL_ARGS(op, condition)	((condition) ? (STATS_ADD(THREAD_STATS->nullArgFailures[op], 1), 1) : 0)
+#define NOTE_PEAK(peak, value)		notePeak(&(peak), (value))
+#endif
+
+/* The lock-free build counts the nodes it hands out when it has a limit to enforce or a peak to record */
+#ifdef LIST_NO_STATS
+#define COUNTS_NODES(context)		((context)->config.maxNodes > 0)
+#else
+#define COUNTS_NODES(context)		1
+#endif
+#define NODE_LIMIT(context)			((context)->config.maxNodes > 0 ? (context)->config.maxNodes : INT_MAX)
+
+/* Latency is timed with the TSC where there is one, and converted to nanoseconds when it is read */
+#if defined(__x86_64__) || defined(__i386__)
+#define LATENCY_TICKS()				__rdtsc()
+#else
+#define LATENCY_TICKS()				monotonicNs()
+#endif
+
+/**
+ * A slab of nodes. Slabs are allocated aligned to NODE_SLAB_BYTES so the slab
+ * (and therefore the pool index) of any node can be recovered from its address.
+ */
+typedef struct NODE_SLAB {
+	int baseIndex;
+	NODE nodes[];
+} NODE_SLAB;
+
+/**
+ * A slab of list heads, aligned to LIST_SLAB_BYTES in the same way as node slabs.
+ * Slabs are never moved, so list pointers stay valid as the pool grows.
+ */
+typedef struct LIST_SLAB {
+	int baseIndex;
+	LIST lists[];
+} LIST_SLAB;
+
+/**
+ * A chunk of a list being sorted by ListSortParallel: a run of nodes linked by next only,
+ * sorted in place by sortChunkWorker.
+ */
+typedef struct SORT_CHUNK {
+	LIST *list;
+	int (*comparator)(void *, void *);
+	NODE *run;
+} SORT_CHUNK;
+
+/**
+ * The header of a serialized list. It is followed by count records, each a uint64_t length
+ * and that many bytes padded to a multiple of 8, in the byte order of the machine that wrote them.
+ */
+typedef struct SERIAL_HEADER {
+	char magic[4];
+	uint32_t version;
+	uint64_t count;
+	uint64_t payloadBytes; // Bytes of records after the header
+} SERIAL_HEADER;
+
+/**
+ * An item's encoding, gathered by ListSerialize before anything is written
+ */
+typedef struct SERIAL_RECORD {
+	uint64_t length;
+	const void *bytes;
+} SERIAL_RECORD;
+
+/**
+ * The header of a record in a mutation log, followed by length bytes of encoded item padded
+ * to a multiple of 8. The checksum covers the header, taking the checksum itself as 0, and
+ * the item bytes, so that a record torn by a crash is recognised on replay.
+ */
+typedef struct LOG_RECORD {
+	uint32_t type;
+	uint32_t id;
+	uint64_t arg;
+	uint32_t length;
+	uint32_t checksum;
+} LOG_RECORD;
+
+/**
+ * A mutation log. The lists it records add records to the buffer as they change, and the
+ * buffer is written and synced as a group. A list changed in a way the log cannot record
+ * is marked dirty, and the next commit writes out all of its items instead.
+ */
+struct LIST_LOG {
+	LIST_LOG_CONFIG config;
+	LIST_CODEC codec;
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_t lock; // Guards everything below
+#endif
+	char *path;
+	int fd;
+	off_t size; // Bytes committed to the file
+	int torn; // The file ends in part of a record, so nothing more is written to it until a checkpoint
+	int replacedFd; // The file a checkpoint renamed over, open until the rename is synced, or -1
+	unsigned char *buffer; // Records not yet written
+	size_t bufferUsed;
+	size_t bufferCapacity;
+	int numPending;
+	LIST *lists[LIST_LOG_MAX_LISTS];
+	char dirty[LIST_LOG_MAX_LISTS];
+};
+
+#ifndef LIST_NO_STATS
+/**
+ * One thread's statistics counters. Only the owning thread writes them; in the thread-safe
+ * build ListGetStats reads every registered block, and a thread's counts are folded into
+ * those of exited threads when it exits.
+ */
+typedef struct STATS_BLOCK {
+	uint64_t calls[LIST_NUM_OPS];
+	uint64_t nullArgFailures[LIST_NUM_OPS];
+	uint64_t poolFailures[LIST_NUM_OPS];
+	uint64_t searchNodesVisited;
+	uint64_t skipIndexRebuilds;
+#ifdef LIST_LATENCY_HISTOGRAMS
+	uint64_t latency[LIST_NUM_OPS][LATENCY_BUCKETS]; // Calls by latency bucket, see latencyBucket
+#endif
+#ifdef LIST_THREAD_SAFE
+	int registered;
+	struct STATS_BLOCK *next; // Next registered block
+#endif
+} STATS_BLOCK;
+#endif
+
+#ifdef LIST_LATENCY_HISTOGRAMS
+/**
+ * The start of a timed call, stopped by stopLatencyTimer when the call's scope is left
+ */
+typedef struct LATENCY_TIMER {
+	LIST_OP op;
+	uint64_t start;
+} LATENCY_TIMER;
+#endif
+
+#ifdef LIST_THREAD_SAFE
+/**
+ * A chain of released nodes, linked first to last through their next pointers,
+ * waiting for readers to leave the epoch it was released in.
+ */
+typedef struct EPOCH_RUN {
+	NODE *first;
+	NODE *last;
+	int count;
+} EPOCH_RUN;
+
+/**
+ * The runs released during epochs of one parity. Runs are recorded whole rather than
+ * chained together, so a reader still on a released node follows the same links it
+ * would have before the node was released.
+ */
+typedef struct EPOCH_LIMBO {
+	EPOCH_RUN *runs;
+	int numRuns;
+	int capacity;
+} EPOCH_LIMBO;
+#endif
+
+#ifdef USE_FILE_POOLS
+/**
+ * A list saved at a root slot of a pool file, with its nodes given by link
+ */
+typedef struct POOL_ROOT {
+	NODE_LINK head;
+	NODE_LINK tail;
+	NODE_LINK current;
+	int32_t size;
+	int32_t currentIsBeyond;
+	int32_t currentIndex;
+	int32_t inUse;
+} POOL_ROOT;
+
+/**
+ * The first NODE_SLAB_BYTES of a pool file; node slab i is stored at (i + 1) * NODE_SLAB_BYTES.
+ * The roots and free chain saved here are only read back from a file that was closed cleanly,
+ * as nodes are relinked in place between checkpoints. A file that was not is rebuilt from
+ * the root copies the last checkpoint wrote beside it, and every other node is free.
+ */
+typedef struct POOL_HEADER {
+	char magic[8];
+	uint32_t version;
+	uint32_t nodeSize; // Files are only opened by builds with the same node layout
+	int32_t numNodeSlabs;
+	int32_t clean; // Nonzero if the file was closed by ListContextDestroy
+	NODE_LINK freeNodes;
+	int32_t numNodesAvailable;
+	POOL_ROOT roots[LIST_MAX_ROOTS];
+} POOL_HEADER;
+_Static_assert(sizeof(POOL_HEADER) <= NODE_SLAB_BYTES, "pool header must fit before the first slab");
+
+/**
+ * The file beside a pool file, named with POOL_COPIES_SUFFIX, that holds the items of its roots
+ * as of the last checkpoint: this header, then a POOL_ROOT_COPY and its items for each root.
+ */
+typedef struct POOL_COPIES_HEADER {
+	char magic[8];
+	uint32_t version;
+	int32_t numRoots;
+} POOL_COPIES_HEADER;
+typedef struct POOL_ROOT_COPY {
+	int32_t slot;
+	int32_t size;
+	int32_t currentIsBeyond;
+	int32_t currentIndex; // Known whenever there is a current item
+} POOL_ROOT_COPY;
+#endif
+
+/**
+ * An allocator context: the node and list head pools along with their free lists.
+ * Lists only ever take nodes from the context they were created in.
+ * The slab directories are allocated once at their full size so that slabs never
+ * move and a node can be found from its index without holding the lock.
+ */
+struct LIST_CONTEXT {
+	LIST_CONTEXT_CONFIG config;
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_t lock; // Guards everything below except the slabs themselves
+#endif
+
+	NODE_SLAB **nodeSlabs;
+	int numNodeSlabs;
+#ifdef LIST_LOCK_FREE
+	uint64_t freeNodeTop; // Free nodes are chained through their next pointers
+	int numNodesInUse; // Only maintained when the context has a node limit or stats are built in
+#else
+	NODE *freeNodes; // Free nodes are chained through their next pointers, so a whole list can be pushed at once
+	int numNodesAvailable;
+#endif
+
+	LIST_SLAB **listSlabs;
+	int numListSlabs;
+	int *availableListArr;
+	char *listInUse;
+	int numListsAvailable;
+
+#ifndef LIST_NO_STATS
+	int peakNodesInUse;
+	int peakListsInUse;
+#endif
+
+#ifdef LIST_THREAD_SAFE
+	/* Epoch reclamation: readers count themselves in under the epoch's parity */
+	unsigned epoch;
+	int numReaders[2];
+	EPOCH_LIMBO limbo[2]; // Nodes released during epochs of each parity
+#endif
+
+#ifdef USE_FILE_POOLS
+	/* File-backed pool: the header and node slabs are mapped from the file */
+	int fd;
+	POOL_HEADER *header; // NULL if the pool lives in memory
+	char *copiesPath; // The file each checkpoint copies the roots to
+	LIST *roots[LIST_MAX_ROOTS];
+#endif
+};
+
+#ifdef USE_MAGAZINES
+/**
+ * A thread's private cache of free node indices from one context.
+ * Nodes move between a magazine and its context's pool MAGAZINE_BATCH at a time,
+ * so the context lock is only taken once per batch of allocations or releases.
+ */
+typedef struct NODE_MAGAZINE {
+	LIST_CONTEXT *context;
+	int numNodes;
+	int nodeIndices[MAGAZINE_SIZE];
+} NODE_MAGAZINE;
+#endif
+
+/**
+ * A tower of the skip index, standing on one node of the list. The level 0 towers hold
+ * roughly 1 in 2^SKIP_BRANCHING_BITS of the nodes, and each level above holds the same
+ * fraction of the level below. The width of a link is the number of positions it spans,
+ * and is only meaningful while the link has a next tower.
+ */
+typedef struct SKIP_TOWER {
+	NODE *node; // NULL for the head tower, which stands before position 0
+	int height;
+	struct SKIP_LINK {
+		struct SKIP_TOWER *next;
+		int width;
+	} links[];
+} SKIP_TOWER;
+
+/**
+ * An order-statistic skip index over a list's nodes.
+ * Operations that move nodes around in bulk drop the towers instead of updating them,
+ * and the index is rebuilt the next time it is used.
+ */
+struct SKIP_INDEX {
+	int valid;
+	int height; // Highest level any tower has reached
+	uint32_t randomState;
+	SKIP_TOWER *head; // Always SKIP_MAX_LEVELS high
+};
+
+/**
+ * An entry of the hash index, one for each node of the list.
+ * Labels increase along the list, so two nodes can be put in list order without walking it.
+ */
+typedef struct HASH_ENTRY {
+	NODE *node;
+	uint64_t label;
+	unsigned long hash;
+	int next; // Next entry in the bucket, or in the free chain; -1 for none
+} HASH_ENTRY;
+
+/**
+ * A hash index from keys to the nodes holding them.
+ * Entries live in one array and refer to each other by position, so it can be grown with realloc.
+ * If an entry cannot be allocated the index is dropped, and rebuilt on the next ListFind.
+ */
+struct HASH_INDEX {
+	int valid;
+	void *(*keyOf)(void *);
+	unsigned long (*hash)(void *);
+	int (*comparator)(void *, void *);
+	int *buckets;
+	int numBuckets; // Always a power of 2
+	HASH_ENTRY *entries;
+	int numEntries; // Entries in use
+	int entryCapacity;
+	int freeEntry; // Head of the chain of unused entries, -1 for none
+};
+
 /***************************************************************
  * Statics                                                     *
  ***************************************************************/
-static NODE nodePool[NODE_POOL_SIZE];
-static LIST listPool[LIST_POOL_SIZE];
-static int availableNodeArr[NODE_POOL_SIZE];
-static int availableListArr[LIST_POOL_SIZE];
-static int numNodesAvailable = NODE_POOL_SIZE;
-static int numListsAvailable = LIST_POOL_SIZE;
-static int initialisationFlag = 0;
-
-static void addItemToEmptyList(LIST *list, void *item);
-static void addItemToListSizeOne(LIST *list, void *item, int afterHead);
-static void addItemBetweenTwoOthers(LIST *list, void *item, NODE *pre, NODE *post);
+#ifdef LIST_THREAD_SAFE
+static LIST_CONTEXT defaultContext = { .lock = PTHREAD_MUTEX_INITIALIZER };
+#else
+static LIST_CONTEXT defaultContext;
+#endif
+
+#ifdef USE_MAGAZINES
+static _Thread_local NODE_MAGAZINE magazine;
+static pthread_key_t magazineKey;
+static pthread_once_t magazineKeyOnce = PTHREAD_ONCE_INIT;
+
+static int refillMagazine(LIST_CONTEXT *context);
+static void spillMagazine(int numNodes);
+static void createMagazineKey(void);
+static void flushMagazineOnExit(void *unused);
+#endif
+
+static const char *const opNames[LIST_NUM_OPS] = {
+	"ListCreate", "ListCount", "ListFirst", "ListLast", "ListNext", "ListPrev", "ListCurr",
+	"ListAdd", "ListInsert", "ListAppend", "ListPrepend", "ListAppendN", "ListPrependN", "ListAddN",
+	"ListRemove", "ListConcat", "ListFree", "ListTrim", "ListSearch", "ListSearchPtr",
+	"ListRemoveIf", "ListSort", "ListSeek", "ListFind", "ListCursorSearch", "ListCompact", "ListContextCompact",
+};
+
+#ifndef LIST_NO_STATS
+#ifdef LIST_THREAD_SAFE
+static _Thread_local STATS_BLOCK threadStats;
+static STATS_BLOCK *statsBlocks; // Blocks of the running threads that have counted anything
+static STATS_BLOCK exitedStats; // Counts of the threads that have exited
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t statsKey;
+static pthread_once_t statsKeyOnce = PTHREAD_ONCE_INIT;
+
+static STATS_BLOCK *registerThreadStats(void);
+static void createStatsKey(void);
+static void retireStatsOnExit(void *block);
+#else
+static STATS_BLOCK threadStats;
+#endif
+static void addStats(LIST_STATS *stats, STATS_BLOCK *block);
+static void notePeak(int *peak, int value);
+#endif
+
+#ifdef LIST_LATENCY_HISTOGRAMS
+static uint64_t latencyBaseline[LIST_NUM_OPS][LATENCY_BUCKETS]; // Counts as of the last ListResetLatency
+
+static void stopLatencyTimer(LATENCY_TIMER *timer);
+static inline int latencyBucket(uint64_t ticks);
+static uint64_t latencyBucketLimit(int bucket);
+static void sumLatency(uint64_t (*counts)[LATENCY_BUCKETS]);
+static double measureNsPerTick(void);
+static uint64_t monotonicNs(void);
+#endif
+
+#ifdef LIST_LOCK_FREE
+static NODE *popFreeNode(LIST_CONTEXT *context);
+static void pushFreeNodes(LIST_CONTEXT *context, NODE *first, NODE *last);
+#else
+static NODE *takeFreeNodes(LIST_CONTEXT *context, int count);
+static void giveFreeNodes(LIST_CONTEXT *context, NODE *first, NODE *last, int count);
+#endif
+
+static NODE *allocNode(LIST_CONTEXT *context, void *item);
+static NODE *allocNodeRun(LIST_CONTEXT *context, void **items, int count, NODE **last);
+static void releaseNode(LIST_CONTEXT *context, NODE *node);
+static void releaseNodeRun(LIST_CONTEXT *context, NODE *first, NODE *last, int count);
+static int growNodePool(LIST_CONTEXT *context);
+static int growListPool(LIST_CONTEXT *context);
+static void releaseList(LIST *list);
+static int moveNodesToContext(LIST *list, LIST_CONTEXT *context);
+static inline NODE *nodeAtIndex(LIST_CONTEXT *context, int nodeIndex);
+static inline int indexOfNode(NODE *node);
+static inline NODE *nodeOf(LIST_CONTEXT *context, NODE_LINK link);
+static inline NODE_LINK linkOf(NODE *node);
+static LIST *listAtIndex(LIST_CONTEXT *context, int listIndex);
+static int indexOfList(LIST *list);
+static void addNodeToEmptyList(LIST *list, NODE *node);
+static void addNodeToListSizeOne(LIST *list, NODE *node, int afterHead);
+static void addNodeBetweenTwoOthers(LIST *list, NODE *node, NODE *pre, NODE *post, int position);
+static void appendNode(LIST *list, NODE *node);
+static void prependNode(LIST *list, NODE *node);
+static void *removeTail(LIST *list);
+static void *searchList(LIST *list, int (*comparator)(void *, void *), void *comparisonArg);
+static void spliceNodes(LIST *list, NODE *pre, NODE *post, NODE *first, NODE *last, int count);
+static void nodesAdded(LIST *list, NODE *first, int count, int position);
+static void nodeRemoved(LIST *list, NODE *node, int position);
+static int skipIndexInsert(SKIP_INDEX *index, NODE *node, int position);
+static void skipIndexRemove(SKIP_INDEX *index, int position);
+static NODE *skipIndexFind(LIST *list, int position);
+static int skipIndexRebuild(LIST *list);
+static void skipIndexInvalidate(SKIP_INDEX *index);
+static void skipIndexConcat(LIST *list1, LIST *list2);
+static int skipIndexRandomHeight(SKIP_INDEX *index);
+static int hashIndexAdd(LIST *list, NODE *first, int count, NODE *pre, NODE *post);
+static void hashIndexRemove(LIST *list, NODE *node);
+static int hashIndexEntryOf(HASH_INDEX *index, NODE *node, unsigned long hash);
+static int hashIndexReserve(HASH_INDEX *index, int count);
+static void hashIndexRelabel(LIST *list);
+static int hashIndexRebuild(LIST *list);
+static void hashIndexInvalidate(HASH_INDEX *index);
+static int checkItems(void **items, int count);
+static void layOutNodes(LIST *list, NODE **nodes, void **items, int currentPosition);
+static int compareNodeAddresses(const void *a, const void *b);
+static void *sortChunkWorker(void *arg);
+static NODE *mergeRuns(LIST *list, NODE *a, NODE *b, int (*comparator)(void *, void *));
+static void cursorEnter(LIST_CURSOR *cursor, LIST_CURSOR *saved);
+#ifdef LIST_THREAD_SAFE
+static void retireNodes(LIST_CONTEXT *context, NODE *first, NODE *last, int count);
+static int advanceEpoch(LIST_CONTEXT *context);
+#ifdef LIST_LOCK_FREE
+static int reclaimRetired(LIST_CONTEXT *context);
+#endif
+#endif
+static void cursorLeave(LIST_CURSOR *cursor, LIST_CURSOR *saved, int change, int position, NODE *removedNode);
+static NODE_SLAB *allocNodeSlab(LIST_CONTEXT *context);
+static int writeFully(int fd, struct iovec *iov, int count);
+static int readFully(int fd, void *buffer, size_t length);
+static int checkSerialHeader(const SERIAL_HEADER *header, uint64_t available);
+static int loadRecords(LIST *list, const unsigned char *records, const SERIAL_HEADER *header, const LIST_CODEC *codec);
+static void logRecord(LIST *list, uint32_t type, uint64_t arg, void *item);
+static void logTouched(LIST *list);
+static void logConcat(LIST *list1, LIST *list2);
+static void logFree(LIST *list);
+static void commitFullGroup(LIST_LOG *log);
+static int bufferRecord(LIST_LOG *log, uint32_t type, uint32_t id, uint64_t arg, void *item);
+static int bufferSnapshot(LIST_LOG *log, int id);
+static uint32_t recordChecksum(const LOG_RECORD *record, const void *bytes);
+static int commitLog(LIST_LOG *log);
+static int checkpointLog(LIST_LOG *log);
+static int syncRename(LIST_LOG *log);
+static int syncDirectoryOf(char *path);
+static int replayRecord(LIST_CONTEXT *context, const LIST_CODEC *codec, LIST **lists, int numLists,
+	const LOG_RECORD *record, const void *bytes);
+#ifdef USE_FILE_POOLS
+static int openPool(LIST_CONTEXT *context, const char *path);
+static void *mapPoolSlab(int fd, off_t offset);
+static void unmapPool(LIST_CONTEXT *context);
+static int loadRoots(LIST_CONTEXT *context);
+static int loadRootCopies(LIST_CONTEXT *context);
+static void rebuildFreeNodes(LIST_CONTEXT *context);
+static void releaseUnrootedNodes(LIST_CONTEXT *context);
+static int checkpointPool(LIST_CONTEXT *context, int clean);
+static void *copyRoots(LIST_CONTEXT *context, size_t *bytes);
+static int writeRootCopies(LIST_CONTEXT *context, void *copies, size_t bytes);
+#endif
 
 /***************************************************************
  * Global Functions                                            *
  ***************************************************************/
 
+/**
+ * Creates a new allocator context and returns a pointer to it.
+ * Passing a NULL config gives a context with no limits on its pools.
+ * Returns NULL if the context could not be allocated.
+ */
+LIST_CONTEXT *ListContextCreate(const LIST_CONTEXT_CONFIG *config) {
+	LIST_CONTEXT *context = calloc(1, sizeof(LIST_CONTEXT));
+	if (context == NULL) {
+		return NULL;
+	}
+
+	if (config != NULL) {
+		context->config = *config;
+	}
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_init(&context->lock, NULL);
+#endif
+	return context;
+}
+
+/**
+ * Opens a context whose node pool lives in the given file, creating the file if it does not exist.
+ * Nodes link to each other by pool index, so the file can be mapped anywhere, and the lists
+ * saved at its root slots are available from ListContextRoot as soon as it is open.
+ * Items are saved as they are, so they must mean the same thing to every process that opens
+ * the file: small integers, offsets, or pointers into memory mapped at a fixed address.
+ * If the file was not closed by ListContextDestroy, each root list is rebuilt as it was at
+ * the last checkpoint from the copy beside the file, and every other node is free.
+ * Only available in the compact build without LIST_LOCK_FREE.
+ * Returns NULL if the file could not be opened or mapped, or was written by a different build.
+ */
+LIST_CONTEXT *ListContextOpen(const char *path, const LIST_CONTEXT_CONFIG *config) {
+#ifdef USE_FILE_POOLS
+	if (path == NULL) {
+		return NULL;
+	}
+
+	LIST_CONTEXT *context = ListContextCreate(config);
+	if (context == NULL) {
+		return NULL;
+	}
+
+	context->fd = -1;
+	if (openPool(context, path) != 0) {
+		unmapPool(context);
+		ListContextDestroy(context);
+		return NULL;
+	}
+	return context;
+#else
+	(void)path;
+	(void)config;
+	return NULL;
+#endif
+}
+
+/**
+ * Deletes a context along with all of its pools.
+ * Every list created in the context is invalid after the operation.
+ * The default context used by ListCreate cannot be destroyed.
+ * A file-backed context saves its roots and closes its file, and the nodes of every list
+ * outside the roots are free when the file is next opened.
+ * In the thread-safe build, every other thread that used the context must have called
+ * ListThreadFlush (or exited) first.
+ */
+void ListContextDestroy(LIST_CONTEXT *context) {
+	if (context == NULL || context == &defaultContext) {
+		return;
+	}
+
+#ifdef USE_FILE_POOLS
+	/* Put every node outside the roots back on the free chain so that it can be saved with them */
+	if (context->header != NULL) {
+#ifdef USE_MAGAZINES
+		if (magazine.context == context) {
+			ListThreadFlush();
+		}
+#endif
+		LOCK_CONTEXT(context);
+		if (EPOCH_RECLAIM(context)) {
+			(void)RECLAIM_RETIRED(context);
+		}
+		releaseUnrootedNodes(context);
+		UNLOCK_CONTEXT(context);
+		checkpointPool(context, 1);
+		unmapPool(context);
+	}
+#endif
+
+#ifdef USE_MAGAZINES
+	if (magazine.context == context) {
+		magazine.context = NULL;
+		magazine.numNodes = 0;
+	}
+#endif
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_destroy(&context->lock);
+#endif
+
+	for (int i = 0; i < context->numNodeSlabs; i++) {
+		free(context->nodeSlabs[i]);
+	}
+	for (int i = 0; i < context->numListSlabs; i++) {
+		free(context->listSlabs[i]);
+	}
+	free(context->nodeSlabs);
+#ifdef LIST_THREAD_SAFE
+	free(context->limbo[0].runs);
+	free(context->limbo[1].runs);
+#endif
+	free(context->listSlabs);
+	free(context->availableListArr);
+	free(context->listInUse);
+	free(context);
+}
+
+/**
+ * Returns the list at a root slot of a file-backed context, creating an empty one there
+ * if the slot is unused. Each checkpoint saves the lists at the root slots; freeing a
+ * list clears its slot.
+ * Returns NULL if the context is not file-backed, the slot is out of range or no list could be created.
+ */
+LIST *ListContextRoot(LIST_CONTEXT *context, int slot) {
+#ifdef USE_FILE_POOLS
+	if (context == NULL || context->header == NULL || slot < 0 || slot >= LIST_MAX_ROOTS) {
+		return NULL;
+	}
+
+	LOCK_CONTEXT(context);
+	LIST *list = context->roots[slot];
+	UNLOCK_CONTEXT(context);
+	if (list != NULL) {
+		return list;
+	}
+
+	list = ListCreateIn(context);
+	if (list == NULL) {
+		return NULL;
+	}
+
+	/* Another thread may have filled the slot while the list was being created */
+	LOCK_CONTEXT(context);
+	LIST *existing = context->roots[slot];
+	if (existing == NULL) {
+		context->roots[slot] = list;
+	}
+	UNLOCK_CONTEXT(context);
+	if (existing != NULL) {
+		releaseList(list);
+		return existing;
+	}
+	return list;
+#else
+	(void)context;
+	(void)slot;
+	return NULL;
+#endif
+}
+
+/**
+ * Saves the lists at the root slots of a file-backed context and syncs the file, returning
+ * once everything they use has reached it. Their items are also copied to a file beside it,
+ * named by adding ".roots" to its path, which is what a crash before the next checkpoint
+ * brings them back from. Lists at the root slots must not be changed while it runs.
+ * Returns 0 if successful, -1 if the context is not file-backed or the file could not be synced.
+ */
+int ListContextCheckpoint(LIST_CONTEXT *context) {
+#ifdef USE_FILE_POOLS
+	if (context == NULL || context->header == NULL) {
+		return -1;
+	}
+	return checkpointPool(context, 0);
+#else
+	(void)context;
+	return -1;
+#endif
+}
+
+/**
+ * Packs the nodes of every list in the context into consecutive pool slots from the start
+ * of the pool, one list after another, each in traversal order, and chains the remaining
+ * free nodes in address order so that they are handed out in that order. Items, current
+ * items and positions are unchanged, but each list's items move to other nodes, so skip
+ * and hash indexes are rebuilt when next used and cursors must be moved with ListCursorFirst,
+ * ListCursorLast or ListCursorInit before they are used again.
+ * Nothing else may use the context while it runs. In the thread-safe build every other
+ * thread that used the context must have called ListThreadFlush (or exited) first, and
+ * no reader may be inside ListEpochEnter. A file-backed context should be checkpointed
+ * afterwards, as a crash during the pass leaves the file's lists scrambled.
+ * Returns 0 if successful, -1 if the context is NULL, released nodes are still held back
+ * for readers, or the pass could not allocate its working space.
+ */
+int ListContextCompact(LIST_CONTEXT *context) {
+	COUNT_CALL(LIST_OP_CONTEXT_COMPACT);
+	if (NULL_ARGS(LIST_OP_CONTEXT_COMPACT, context == NULL)) {
+		return -1;
+	}
+
+#ifdef USE_MAGAZINES
+	if (magazine.context == context) {
+		ListThreadFlush();
+	}
+#endif
+	LOCK_CONTEXT(context);
+#ifdef LIST_THREAD_SAFE
+	if (EPOCH_RECLAIM(context)) {
+		(void)RECLAIM_RETIRED(context);
+	}
+	if (context->limbo[0].numRuns > 0 || context->limbo[1].numRuns > 0) {
+		UNLOCK_CONTEXT(context);
+		return -1;
+	}
+#endif
+
+	/* Read every list's items first, as laying out one list overwrites nodes of the others */
+	int numListSlots = context->numListSlabs * (int)LISTS_PER_SLAB;
+	int numNodes = 0;
+	for (int listIndex = 0; listIndex < numListSlots; listIndex++) {
+		if (context->listInUse[listIndex]) {
+			numNodes += listAtIndex(context, listIndex)->size;
+		}
+	}
+	void **items = malloc(((size_t)numNodes + 1) * sizeof(void *));
+	NODE **nodes = malloc(((size_t)numNodes + 1) * sizeof(NODE *));
+	int *currentPositions = malloc(((size_t)numListSlots + 1) * sizeof(int));
+	if (items == NULL || nodes == NULL || currentPositions == NULL) {
+		UNLOCK_CONTEXT(context);
+		free(items);
+		free(nodes);
+		free(currentPositions);
+		return -1;
+	}
+	int numRead = 0;
+	for (int listIndex = 0; listIndex < numListSlots; listIndex++) {
+		if (!context->listInUse[listIndex]) {
+			continue;
+		}
+		LIST *list = listAtIndex(context, listIndex);
+		currentPositions[listIndex] = -1;
+		for (NODE *node = list->head; node != NULL; node = NEXT(node)) {
+			if (node == list->current) {
+				currentPositions[listIndex] = numRead;
+			}
+			items[numRead++] = node->item;
+		}
+	}
+
+	/* Hand each list the next run of slots */
+	for (int i = 0; i < numNodes; i++) {
+		nodes[i] = nodeAtIndex(context, i);
+	}
+	int firstSlot = 0;
+	for (int listIndex = 0; listIndex < numListSlots; listIndex++) {
+		if (!context->listInUse[listIndex]) {
+			continue;
+		}
+		LIST *list = listAtIndex(context, listIndex);
+		int currentPosition = currentPositions[listIndex] >= 0 ? currentPositions[listIndex] - firstSlot : -1;
+		layOutNodes(list, &nodes[firstSlot], &items[firstSlot], currentPosition);
+		firstSlot += list->size;
+	}
+
+	/* Chain the free nodes behind the packed ones in address order */
+	int numSlots = context->numNodeSlabs * (int)NODES_PER_SLAB;
+	for (int i = numNodes; i < numSlots; i++) {
+		NODE *node = nodeAtIndex(context, i);
+		node->item = NULL;
+		SET_PREVIOUS(node, NULL);
+		SET_NEXT(node, i + 1 < numSlots ? nodeAtIndex(context, i + 1) : NULL);
+	}
+#ifdef LIST_LOCK_FREE
+	uint64_t top = __atomic_load_n(&context->freeNodeTop, __ATOMIC_RELAXED);
+	__atomic_store_n(&context->freeNodeTop, FREE_TOP(FREE_TOP_TAG(top) + 1, numNodes < numSlots ? numNodes + 1 : 0),
+		__ATOMIC_RELEASE);
+#else
+	context->freeNodes = numNodes < numSlots ? nodeAtIndex(context, numNodes) : NULL;
+#endif
+	UNLOCK_CONTEXT(context);
+
+	free(items);
+	free(nodes);
+	free(currentPositions);
+	return 0;
+}
+
+/**
+ * Returns the nodes cached by the calling thread to their context.
+ * Only has an effect in the thread-safe build, where it is also done when a thread exits.
+ * The lock-free build does not cache nodes per thread.
+ */
+void ListThreadFlush(void) {
+#ifdef USE_MAGAZINES
+	if (magazine.context != NULL) {
+		spillMagazine(magazine.numNodes);
+		magazine.context = NULL;
+	}
+#endif
+}
+
 /** 
- * Creates a new list and returns a pointer to it.
+ * Creates a new list in the default context and returns a pointer to it.
  */
 LIST *ListCreate(void) {
+	return ListCreateIn(&defaultContext);
+}
+
+/**
+ * Creates a new list in the given context and returns a pointer to it.
+ * Returns NULL if the context is NULL or its list limit has been reached.
+ */
+LIST *ListCreateIn(LIST_CONTEXT *context) {
 	LIST list;
 
-	/* Set all of the indices of the available nodes when the first list is created */
-	if (!initialisationFlag) {
-		for (int i = 0; i < NODE_POOL_SIZE; i++) {
-			availableNodeArr[i] = i;
-		}
-		for (int i = 0; i < LIST_POOL_SIZE; i++) {
-			availableListArr[i] = i;
-		}
-		initialisationFlag = 1;
+	COUNT_CALL(LIST_OP_CREATE);
+	if (NULL_ARGS(LIST_OP_CREATE, context == NULL)) {
+		return NULL;
+	}
+
+	LOCK_CONTEXT(context);
+	if (context->config.maxLists > 0 && LISTS_IN_USE(context) >= context->config.maxLists) {
+		UNLOCK_CONTEXT(context);
+		COUNT_POOL_EXHAUSTED(LIST_OP_CREATE);
+		return NULL;
 	}
 
-	/* Ensure there is space in the list pool */
-	if (LIST_POOL_FULL) {
+	/* Ensure there is space in the list pool, adding a slab if there is not */
+	if (LIST_POOL_EMPTY(context) && growListPool(context) != 0) {
+		UNLOCK_CONTEXT(context);
+		COUNT_POOL_EXHAUSTED(LIST_OP_CREATE);
 		return NULL;
 	}
 
@@ -73,19 +988,30 @@ LIST *ListCreate(void) {
 	list.tail = NULL;
 	list.size = 0;
 	list.currentIsBeyond = 0;
+	list.currentIndex = 0;
+	list.context = context;
+	list.skipIndex = NULL;
+	list.hashIndex = NULL;
+	list.log = NULL;
+	list.logId = 0;
+	list.edits = 0;
 
 	/* Add local new list to the list pool and return it */
-	int listIndex = availableListArr[numListsAvailable - 1];
-	listPool[listIndex] = list;
-	numListsAvailable--;
-	return &listPool[listIndex];
+	int listIndex = context->availableListArr[context->numListsAvailable - 1];
+	*listAtIndex(context, listIndex) = list;
+	context->listInUse[listIndex] = 1;
+	context->numListsAvailable--;
+	NOTE_PEAK(context->peakListsInUse, LISTS_IN_USE(context));
+	UNLOCK_CONTEXT(context);
+	return listAtIndex(context, listIndex);
 }
 
 /** 
  * Returns the number of items in the list.
  */
 int ListCount(LIST *list) {
-	if (list != NULL) {
+	COUNT_CALL(LIST_OP_COUNT);
+	if (!NULL_ARGS(LIST_OP_COUNT, list == NULL)) {
 		return list->size;
 	} else {
 		return 0;
@@ -97,12 +1023,14 @@ int ListCount(LIST *list) {
  * Returns NULL if the list is empty.
  */
 void *ListFirst(LIST *list) {
-	if (list == NULL || LIST_IS_EMPTY) {
+	COUNT_CALL(LIST_OP_FIRST);
+	if (NULL_ARGS(LIST_OP_FIRST, list == NULL) || LIST_IS_EMPTY) {
 		return NULL;
 	}
 
 	list->current = list->head;
 	list->currentIsBeyond = 0;
+	list->currentIndex = 0;
 	return list->current->item;
 }
 
@@ -111,11 +1039,14 @@ void *ListFirst(LIST *list) {
  * Returns NULL if the list is empty.
  */
 void *ListLast(LIST *list) {
-	if (list == NULL || LIST_IS_EMPTY) {
+	COUNT_CALL(LIST_OP_LAST);
+	if (NULL_ARGS(LIST_OP_LAST, list == NULL) || LIST_IS_EMPTY) {
 		return NULL;
 	}
 
 	list->current = list->tail;
+	list->currentIsBeyond = 0;
+	list->currentIndex = list->size - 1;
 	return list->current->item;
 }
 
@@ -125,23 +1056,27 @@ void *ListLast(LIST *list) {
  * Returns NULL if the current item advances beyond the end of the list.
  */
 void *ListNext(LIST *list) {
-	if (list == NULL) {
+	COUNT_CALL(LIST_OP_NEXT);
+	if (NULL_ARGS(LIST_OP_NEXT, list == NULL)) {
 		return NULL;
 	}
 
 	if (CURRENT_NODE_BEYOND_END || CURRENT_NODE_IS_TAIL || LIST_IS_EMPTY) {
 		list->current = NULL;
 		list->currentIsBeyond = 1;
+		list->currentIndex = list->size;
 		return NULL;
 	}
 
 	if (CURRENT_NODE_BEYOND_START) {
 		list->current = list->head;
 		list->currentIsBeyond = 0;
+		list->currentIndex = 0;
 		return list->current->item;
 	}
 
-	list->current = list->current->next;
+	list->current = NEXT(list->current);
+	list->currentIndex = POSITION_AFTER(list->currentIndex, 1);
 	return list->current->item;
 }
 
@@ -151,23 +1086,27 @@ void *ListNext(LIST *list) {
  * Returns NULL if the current item advances beyond the start of the list.
  */
 void *ListPrev(LIST *list) {
-	if (list == NULL) {
+	COUNT_CALL(LIST_OP_PREV);
+	if (NULL_ARGS(LIST_OP_PREV, list == NULL)) {
 		return NULL;
 	}
 
 	if (CURRENT_NODE_BEYOND_START || CURRENT_NODE_IS_HEAD) {
 		list->current = NULL;
 		list->currentIsBeyond = -1;
+		list->currentIndex = -1;
 		return NULL;
 	}
 
 	if (CURRENT_NODE_BEYOND_END) {
 		list->current = list->tail;
 		list->currentIsBeyond = 0;
+		list->currentIndex = list->size - 1;
 		return list->current->item;
 	}
 
-	list->current = list->current->previous;
+	list->current = PREVIOUS(list->current);
+	list->currentIndex = POSITION_AFTER(list->currentIndex, -1);
 	return list->current->item;
 }
 
@@ -175,7 +1114,8 @@ void *ListPrev(LIST *list) {
  * Returns a pointer to the current item in the list
  */
 void *ListCurr(LIST *list) {
-	if (list == NULL || LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START || CURRENT_NODE_BEYOND_END) {
+	COUNT_CALL(LIST_OP_CURR);
+	if (NULL_ARGS(LIST_OP_CURR, list == NULL) || LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START || CURRENT_NODE_BEYOND_END) {
 		return NULL;
 	}	
 	return list->current->item;
@@ -188,20 +1128,31 @@ void *ListCurr(LIST *list) {
  * Returns 0 if successful, -1 if failed.
  */
 int ListAdd(LIST *list, void *item) {
-	if (list == NULL || item == NULL || NODE_POOL_FULL) {
+	COUNT_CALL(LIST_OP_ADD);
+	if (NULL_ARGS(LIST_OP_ADD, list == NULL || item == NULL)) {
+		return -1;
+	}
+
+	NODE *node = allocNode(list->context, item);
+	if (node == NULL) {
+		COUNT_POOL_EXHAUSTED(LIST_OP_ADD);
 		return -1;
 	}
 
 	if (LIST_IS_EMPTY) {
-		addItemToEmptyList(list, item);
+		addNodeToEmptyList(list, node);
 	} else if (list->size == 1) {
-		addItemToListSizeOne(list, item, CURRENT_NODE_BEYOND_START ? 0 : 1);
+		addNodeToListSizeOne(list, node, CURRENT_NODE_BEYOND_START ? 0 : 1);
 	} else if (CURRENT_NODE_BEYOND_START) {
-		ListPrepend(list, item);
+		prependNode(list, node);
 	} else if (CURRENT_NODE_BEYOND_END || CURRENT_NODE_IS_TAIL) {
-		ListAppend(list, item);
+		appendNode(list, node);
 	} else {
-		addItemBetweenTwoOthers(list, item, list->current, list->current->next);
+		addNodeBetweenTwoOthers(list, node, list->current, NEXT(list->current),
+			POSITION_AFTER(list->currentIndex, 1));
+	}
+	if (list->log != NULL) {
+		logRecord(list, LOG_INSERT, ListIndexOfCurrent(list), item);
 	}
 	return 0;
 }
@@ -213,20 +1164,30 @@ int ListAdd(LIST *list, void *item) {
  * Returns 0 if successful, -1 if failed
  */
 int ListInsert(LIST *list, void *item) {
-	if (list == NULL || item == NULL || NODE_POOL_FULL) {
+	COUNT_CALL(LIST_OP_INSERT);
+	if (NULL_ARGS(LIST_OP_INSERT, list == NULL || item == NULL)) {
+		return -1;
+	}
+
+	NODE *node = allocNode(list->context, item);
+	if (node == NULL) {
+		COUNT_POOL_EXHAUSTED(LIST_OP_INSERT);
 		return -1;
 	}
 
 	if (LIST_IS_EMPTY) {
-		addItemToEmptyList(list, item);
+		addNodeToEmptyList(list, node);
 	} else if (list->size == 1) {
-		addItemToListSizeOne(list, item, CURRENT_NODE_BEYOND_END ? 1 : 0);
+		addNodeToListSizeOne(list, node, CURRENT_NODE_BEYOND_END ? 1 : 0);
 	} else if (CURRENT_NODE_BEYOND_START || CURRENT_NODE_IS_HEAD) {
-		ListPrepend(list, item);
+		prependNode(list, node);
 	} else if (CURRENT_NODE_BEYOND_END) {
-		ListAppend(list, item);
+		appendNode(list, node);
 	} else {
-		addItemBetweenTwoOthers(list, item, list->current->previous, list->current);
+		addNodeBetweenTwoOthers(list, node, PREVIOUS(list->current), list->current, list->currentIndex);
+	}
+	if (list->log != NULL) {
+		logRecord(list, LOG_INSERT, ListIndexOfCurrent(list), item);
 	}
 	return 0;
 }
@@ -236,34 +1197,25 @@ int ListInsert(LIST *list, void *item) {
  * Returns 0 if successful, -1 if failed.
  */
 int ListAppend(LIST *list, void *item) {
-	NODE node;
+	COUNT_CALL(LIST_OP_APPEND);
+	if (NULL_ARGS(LIST_OP_APPEND, list == NULL || item == NULL)) {
+		return -1;
+	}
 
-	if (list == NULL || item == NULL || NODE_POOL_FULL) {
+	NODE *node = allocNode(list->context, item);
+	if (node == NULL) {
+		COUNT_POOL_EXHAUSTED(LIST_OP_APPEND);
 		return -1;
 	}
+
 	if (LIST_IS_EMPTY) {
-		addItemToEmptyList(list, item);
-		return 0;
+		addNodeToEmptyList(list, node);
+	} else {
+		appendNode(list, node);
 	}
-
-	node.item = item;
-	node.previous = list->tail;
-	node.next = NULL;
-	
-	int nodeIndex = availableNodeArr[numNodesAvailable - 1];
-	nodePool[nodeIndex] = node;
-	numNodesAvailable--;
-
-	if (list->size == 1) {
-		list->head->next = &nodePool[nodeIndex];
+	if (list->log != NULL) {
+		logRecord(list, LOG_APPEND, 0, item);
 	}
-	list->tail->next = &nodePool[nodeIndex];
-	list->tail->next->previous = list->tail;
-	list->tail = list->tail->next;
-	list->current = list->tail;
-	list->size++;
-	list->currentIsBeyond = 0;
-
 	return 0;
 }
 
@@ -272,105 +1224,224 @@ int ListAppend(LIST *list, void *item) {
  * Returns 0 on success, -1 on failure.
  */
 int ListPrepend(LIST *list, void *item) {
-	NODE node;
+	COUNT_CALL(LIST_OP_PREPEND);
+	if (NULL_ARGS(LIST_OP_PREPEND, list == NULL || item == NULL)) {
+		return -1;
+	}
 
-	if (list == NULL || item == NULL || NODE_POOL_FULL) {
+	NODE *node = allocNode(list->context, item);
+	if (node == NULL) {
+		COUNT_POOL_EXHAUSTED(LIST_OP_PREPEND);
 		return -1;
 	}
 
 	if (LIST_IS_EMPTY) {
-		addItemToEmptyList(list, item);
-		return 0;
+		addNodeToEmptyList(list, node);
+	} else {
+		prependNode(list, node);
+	}
+	if (list->log != NULL) {
+		logRecord(list, LOG_PREPEND, 0, item);
 	}
-
-	node.item = item;
-	node.previous = NULL;
-	node.next = list->head;
-
-	int nodeIndex = availableNodeArr[numNodesAvailable - 1];
-	nodePool[nodeIndex] = node;
-	numNodesAvailable--;
-
-	list->head->previous = &nodePool[nodeIndex];
-	list->head = &nodePool[nodeIndex];
-	list->size++;
-	list->current = list->head;
-	list->currentIsBeyond = 0;
-
 	return 0;
 }
 
 /**
- * Return current item and take it out of the list.
- * Make the next item the current one.
+ * Adds count items from the array to the end of the list, in array order.
+ * The last added item becomes the current one.
+ * Nothing is added unless there are nodes for every item.
+ * Returns 0 if successful, -1 if failed.
  */
-void *ListRemove(LIST *list) {
-	if (list == NULL || LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START || CURRENT_NODE_BEYOND_END) {
-		return NULL;
+int ListAppendN(LIST *list, void **items, int count) {
+	COUNT_CALL(LIST_OP_APPEND_N);
+	if (NULL_ARGS(LIST_OP_APPEND_N, list == NULL || checkItems(items, count) != 0)) {
+		return -1;
 	}
-
-	void *item = list->current->item;
-	ptrdiff_t nodeIndex = list->current - nodePool;
-
-	if (list->size == 1) {
-		list->head = NULL;
-		list->current = NULL;
-		list->tail = NULL;
-	} else if (CURRENT_NODE_IS_HEAD) {
-		list->head = list->head->next;
-		list->head->previous = NULL;
-		list->current = list->head;
-	} else if (CURRENT_NODE_IS_TAIL) {
-		return ListTrim(list);
-	} else {
-		NODE *preRemovedNode = list->current->previous;
-		NODE *postRemovedNode = list->current->next;
-		preRemovedNode->next = postRemovedNode;
-		postRemovedNode->previous = preRemovedNode;
-		list->current = postRemovedNode;
+	if (count == 0) {
+		return 0;
 	}
 
-	list->currentIsBeyond = 0;
-	list->size--;
-
-	availableNodeArr[numNodesAvailable] = nodeIndex;
-	numNodesAvailable++;
-	return item;
+	NODE *last;
+	NODE *first = allocNodeRun(list->context, items, count, &last);
+	if (first == NULL) {
+		COUNT_POOL_EXHAUSTED(LIST_OP_APPEND_N);
+		return -1;
+	}
+	spliceNodes(list, list->tail, NULL, first, last, count);
+	for (int i = 0; list->log != NULL && i < count; i++) {
+		logRecord(list, LOG_APPEND, 0, items[i]);
+	}
+	return 0;
 }
 
 /**
- * Adds list2 to the end of list1. 
- * The current pointer is set to the current pointer of list1. 
- * List2 no longer exists after the operation.
+ * Adds count items from the array to the front of the list, in array order.
+ * The last added item becomes the current one.
+ * Nothing is added unless there are nodes for every item.
+ * Returns 0 if successful, -1 if failed.
  */
-void ListConcat(LIST *list1, LIST *list2) {
-	if (list1 == NULL || list2 == NULL) {
-		return;
+int ListPrependN(LIST *list, void **items, int count) {
+	COUNT_CALL(LIST_OP_PREPEND_N);
+	if (NULL_ARGS(LIST_OP_PREPEND_N, list == NULL || checkItems(items, count) != 0)) {
+		return -1;
+	}
+	if (count == 0) {
+		return 0;
 	}
 
-	if (list1->size == 1 && list2->size == 1) {
-		list1->head->next = list2->head;
-		list1->tail = list2->head;
-		list1->tail->previous = list1->head;
-	} else if (list1->size == 1 && list2->size > 1) {
-		list1->head->next = list2->head;
-		list1->tail = list2->tail;
-		list2->head->previous = list1->tail;
-	} else if (list1->size > 1 && list2->size >= 1) {
-		list1->tail->next = list2->head;
-		list2->head->previous = list1->tail;
-		list1->tail = list2->tail;
-	} else if (list1->size == 0 && list2->size > 0) {
-		list1->head = list2->head;
-		list1->tail = list2->tail;
+	NODE *last;
+	NODE *first = allocNodeRun(list->context, items, count, &last);
+	if (first == NULL) {
+		COUNT_POOL_EXHAUSTED(LIST_OP_PREPEND_N);
+		return -1;
+	}
+	spliceNodes(list, NULL, list->head, first, last, count);
+	for (int i = count - 1; list->log != NULL && i >= 0; i--) {
+		logRecord(list, LOG_PREPEND, 0, items[i]);
+	}
+	return 0;
+}
+
+/**
+ * Adds count items from the array directly after the current item, in array order.
+ * If the current pointer is before the start of the list, the items are added to the start.
+ * If the current pointer is after the end of the list, the items are added to the end.
+ * The last added item becomes the current one.
+ * Nothing is added unless there are nodes for every item.
+ * Returns 0 if successful, -1 if failed.
+ */
+int ListAddN(LIST *list, void **items, int count) {
+	COUNT_CALL(LIST_OP_ADD_N);
+	if (NULL_ARGS(LIST_OP_ADD_N, list == NULL || checkItems(items, count) != 0)) {
+		return -1;
+	}
+	if (count == 0) {
+		return 0;
+	}
+
+	NODE *last;
+	NODE *first = allocNodeRun(list->context, items, count, &last);
+	if (first == NULL) {
+		COUNT_POOL_EXHAUSTED(LIST_OP_ADD_N);
+		return -1;
+	}
+
+	if (LIST_IS_EMPTY || CURRENT_NODE_BEYOND_END) {
+		spliceNodes(list, list->tail, NULL, first, last, count);
+	} else if (CURRENT_NODE_BEYOND_START) {
+		spliceNodes(list, NULL, list->head, first, last, count);
+	} else {
+		spliceNodes(list, list->current, NEXT(list->current), first, last, count);
+	}
+	if (list->log != NULL) {
+		logTouched(list);
+	}
+	return 0;
+}
+
+/**
+ * Return current item and take it out of the list.
+ * Make the next item the current one.
+ */
+void *ListRemove(LIST *list) {
+	COUNT_CALL(LIST_OP_REMOVE);
+	if (NULL_ARGS(LIST_OP_REMOVE, list == NULL) || LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START || CURRENT_NODE_BEYOND_END) {
+		return NULL;
+	}
+
+	/* The log records removals by position */
+	if (list->log != NULL) {
+		ListIndexOfCurrent(list);
+	}
+	void *item = list->current->item;
+	NODE *removedNode = list->current;
+	int position = list->currentIndex;
+
+	if (list->size == 1) {
+		SET_HEAD(list, NULL);
+		list->current = NULL;
+		SET_TAIL(list, NULL);
+		list->currentIndex = 0;
+	} else if (CURRENT_NODE_IS_HEAD) {
+		SET_HEAD(list, NEXT(list->head));
+		SET_PREVIOUS(list->head, NULL);
+		list->current = list->head;
+	} else if (CURRENT_NODE_IS_TAIL) {
+		return removeTail(list);
+	} else {
+		NODE *preRemovedNode = PREVIOUS(list->current);
+		NODE *postRemovedNode = NEXT(list->current);
+		SET_NEXT(preRemovedNode, postRemovedNode);
+		SET_PREVIOUS(postRemovedNode, preRemovedNode);
+		list->current = postRemovedNode;
+	}
+
+	list->currentIsBeyond = 0;
+	list->size--;
+	nodeRemoved(list, removedNode, position);
+	if (list->log != NULL) {
+		logRecord(list, LOG_REMOVE, position, NULL);
+	}
+
+	releaseNode(list->context, removedNode);
+	return item;
+}
+
+/**
+ * Adds list2 to the end of list1. 
+ * The current pointer is set to the current pointer of list1. 
+ * List2 no longer exists after the operation.
+ * If the lists are from different contexts and list1's context cannot hold list2's items,
+ * neither list is changed.
+ */
+void ListConcat(LIST *list1, LIST *list2) {
+	COUNT_CALL(LIST_OP_CONCAT);
+	if (NULL_ARGS(LIST_OP_CONCAT, list1 == NULL || list2 == NULL)) {
+		return;
+	}
+
+	/* Nodes must be returned to the context they came from, so move list2's over first */
+	if (list2->context != list1->context && moveNodesToContext(list2, list1->context) != 0) {
+		COUNT_POOL_EXHAUSTED(LIST_OP_CONCAT);
+		return;
+	}
+
+	skipIndexConcat(list1, list2);
+	NODE *list1Tail = list1->tail;
+	if (list1->size == 0 && list2->size > 0) {
+		SET_HEAD(list1, list2->head);
+		SET_TAIL(list1, list2->tail);
+		/* List1 takes list2's position, including one beyond either end */
 		list1->current = list2->current;
-		list1->currentIsBeyond = 0;
+		list1->currentIsBeyond = list2->currentIsBeyond;
+		list1->currentIndex = list2->currentIndex;
+	} else if (list2->size > 0) {
+		SET_NEXT(list1->tail, list2->head);
+		SET_PREVIOUS(list2->head, list1->tail);
+		SET_TAIL(list1, list2->tail);
+		if (list1->currentIsBeyond == 1) {
+			list1->currentIndex += list2->size;
+		}
 	}
 	list1->size += list2->size;
+	NOTE_EDIT(list1);
+	if (list1->hashIndex != NULL && list1->hashIndex->valid
+			&& hashIndexAdd(list1, list2->head, list2->size, list1Tail, NULL) != 0) {
+		hashIndexInvalidate(list1->hashIndex);
+	}
+
+	if (list1->log != NULL || list2->log != NULL) {
+		logConcat(list1, list2);
+	}
+
+	/* List2's nodes now belong to list1, so a later ListFree(list2) must not release them */
+	list2->current = NULL;
+	SET_HEAD(list2, NULL);
+	SET_TAIL(list2, NULL);
+	list2->size = 0;
+	list2->currentIsBeyond = 0;
 
-	ptrdiff_t listIndex2 = list2 - listPool;
-	availableListArr[numListsAvailable] = listIndex2;
-	numListsAvailable++;
+	releaseList(list2);
 	list2 = NULL;
 }
 
@@ -380,36 +1451,32 @@ void ListConcat(LIST *list1, LIST *list2) {
  * It should be invoked (within ListFree) as: (* itemFree)(itemToBeFreed);
  */
 void ListFree(LIST *list, void (*itemFree)(void *)) {
-	if (list == NULL) {
+	COUNT_CALL(LIST_OP_FREE);
+	if (NULL_ARGS(LIST_OP_FREE, list == NULL)) {
 		return;
 	}
 
-	NODE *nodeToDelete = list->head;
-	while (nodeToDelete != NULL) {
-		if (itemFree != NULL) {
-			(* itemFree)(nodeToDelete->item);
+	if (list->log != NULL) {
+		logFree(list);
+	}
+	if (itemFree != NULL) {
+		for (NODE *node = list->head; node != NULL; node = NEXT(node)) {
+			(* itemFree)(node->item);
 		}
+	}
 
-		ptrdiff_t nodeIndex = nodeToDelete - nodePool;
-		availableNodeArr[numNodesAvailable] = nodeIndex;
-		numNodesAvailable++;
-
-		NODE *oldNode = nodeToDelete;
-		nodeToDelete = nodeToDelete->next;
-		oldNode->item = NULL;
-		oldNode->previous = NULL;
-		oldNode->next = NULL;
+	/* The nodes are already chained head to tail, so they go back to the pool in one step */
+	if (list->head != NULL) {
+		releaseNodeRun(list->context, list->head, list->tail, list->size);
 	}
 
 	list->current = NULL;
-	list->head = NULL;
-	list->tail = NULL;
+	SET_HEAD(list, NULL);
+	SET_TAIL(list, NULL);
 	list->size = 0;
 	list->currentIsBeyond = 0;
 
-	ptrdiff_t listIndex = list - listPool;
-	availableListArr[numListsAvailable] = listIndex;
-	numListsAvailable++;
+	releaseList(list);
 }
 
 /**
@@ -417,28 +1484,11 @@ void ListFree(LIST *list, void (*itemFree)(void *)) {
  * Make the new last item the current one.
  */
 void *ListTrim(LIST *list) {
-	if (list == NULL || LIST_IS_EMPTY) {
+	COUNT_CALL(LIST_OP_TRIM);
+	if (NULL_ARGS(LIST_OP_TRIM, list == NULL) || LIST_IS_EMPTY) {
 		return NULL;
 	}
-
-	void *item = list->tail->item;
-	ptrdiff_t nodeIndex = list->tail - nodePool;
-	availableNodeArr[numNodesAvailable] = nodeIndex;
-	numNodesAvailable++;
-
-	if (list->size > 1) {
-		list->tail = list->tail->previous;
-		list->tail->next = NULL;
-		list->current = list->tail;
-	} else {
-		list->tail = NULL;
-		list->head = NULL;
-		list->current = NULL;
-	}
-	list->size--;
-	list->currentIsBeyond = 0;
-
-	return item;
+	return removeTail(list);
 }
 
 /**
@@ -451,98 +1501,3853 @@ void *ListTrim(LIST *list) {
  * If no match is found, the current pointer is left beyond the end of the list and a NULL pointer is returned.
  */
 void *ListSearch(LIST *list, int (*comparator)(void *, void *), void *comparisonArg) {
-	if (list == NULL || comparator == NULL || LIST_IS_EMPTY) {
+	COUNT_CALL(LIST_OP_SEARCH);
+	if (NULL_ARGS(LIST_OP_SEARCH, list == NULL || comparator == NULL) || LIST_IS_EMPTY) {
 		return NULL;
 	}
+	return searchList(list, comparator, comparisonArg);
+}
 
-	NODE *searchNode = (list->current == NULL && list->currentIsBeyond == -1) ? 
+/**
+ * Searches list for the exact item pointer, starting at the current item, without a comparator.
+ * The current pointer is left exactly as ListSearch would leave it with a comparator
+ * that matches identical pointers.
+ */
+void *ListSearchPtr(LIST *list, void *item) {
+	COUNT_CALL(LIST_OP_SEARCH_PTR);
+	if (NULL_ARGS(LIST_OP_SEARCH_PTR, list == NULL) || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	NODE *searchNode = (list->current == NULL && list->currentIsBeyond == -1) ?
 		list->head : list->current;
-	while (searchNode != NULL) {
-		if ((* comparator)(searchNode->item, comparisonArg) == 1) {
-			list->current = searchNode;
-			list->currentIsBeyond = 0;
-			return list->current->item;
+	int searchIndex = searchNode == list->head ? 0 : list->currentIndex;
+	long numVisited = 0;
+	while (searchNode != NULL && searchNode->item != item) {
+		searchNode = NEXT(searchNode);
+		searchIndex = POSITION_AFTER(searchIndex, 1);
+		numVisited++;
+	}
+
+	COUNT_VISITS(searchNode != NULL ? numVisited + 1 : numVisited);
+	if (searchNode == NULL) {
+		list->current = NULL;
+		list->currentIsBeyond = 1;
+		list->currentIndex = list->size;
+		return NULL;
+	}
+
+	list->current = searchNode;
+	list->currentIsBeyond = 0;
+	list->currentIndex = searchIndex;
+	return item;
+}
+
+/**
+ * Removes every item for which comparator returns 1, in a single pass from the head of the list.
+ * Comparator is called as in ListSearch, with an item pointer and comparisonArg.
+ * If itemFree is not NULL it is called on each removed item.
+ * If the current item is removed, the next remaining item becomes the current one,
+ * or the new tail if no item after it remains. Otherwise the current pointer is unchanged.
+ * Returns the number of items removed, or -1 if list or comparator is NULL.
+ */
+int ListRemoveIf(LIST *list, int (*comparator)(void *, void *), void *comparisonArg, void (*itemFree)(void *)) {
+	COUNT_CALL(LIST_OP_REMOVE_IF);
+	if (NULL_ARGS(LIST_OP_REMOVE_IF, list == NULL || comparator == NULL)) {
+		return -1;
+	}
+
+	NODE *removedHead = NULL;
+	NODE *removedTail = NULL;
+	NODE *kept = NULL;
+	int numKept = 0;
+	int numRemoved = 0;
+	int numPending = 0; // Removed nodes not yet released
+	int currentRemoved = 0;
+
+	NODE *node = list->head;
+	while (node != NULL) {
+		NODE *next = NEXT(node);
+
+		if ((* comparator)(node->item, comparisonArg) != 1) {
+			/* Relink only across the gaps left by removed nodes */
+			if (PREVIOUS(node) != kept) {
+				SET_PREVIOUS(node, kept);
+				if (kept != NULL) {
+					SET_NEXT(kept, node);
+				} else {
+					SET_HEAD(list, node);
+				}
+
+				/* Under epoch reclamation each gap is released as it closes, with its links untouched */
+				if (EPOCH_RECLAIM(list->context)) {
+					releaseNodeRun(list->context, removedHead, removedTail, numPending);
+					removedHead = NULL;
+					removedTail = NULL;
+					numPending = 0;
+				}
+			}
+			if (node == list->current || (currentRemoved && list->current == NULL)) {
+				list->current = node;
+				list->currentIndex = numKept;
+			}
+			kept = node;
+			numKept++;
+		} else {
+			if (node == list->current) {
+				currentRemoved = 1;
+				list->current = NULL;
+			}
+			if (list->hashIndex != NULL && list->hashIndex->valid) {
+				hashIndexRemove(list, node);
+			}
+			if (itemFree != NULL) {
+				(* itemFree)(node->item);
+			}
+			if (removedTail == NULL) {
+				removedHead = node;
+			} else if (!EPOCH_RECLAIM(list->context)) {
+				SET_NEXT(removedTail, node);
+			}
+			removedTail = node;
+			numPending++;
+			numRemoved++;
 		}
-		searchNode = searchNode->next;
+		node = next;
 	}
 
-	list->current = NULL;
-	list->currentIsBeyond = 1;
-	return NULL;
+	if (numRemoved == 0) {
+		return 0;
+	}
+
+	if (kept != NULL) {
+		SET_NEXT(kept, NULL);
+	} else {
+		SET_HEAD(list, NULL);
+	}
+	SET_TAIL(list, kept);
+	if (currentRemoved && list->current == NULL) {
+		list->current = kept;
+		list->currentIndex = numKept > 0 ? numKept - 1 : 0;
+	}
+	if (currentRemoved) {
+		list->currentIsBeyond = 0;
+	}
+	list->size -= numRemoved;
+	NOTE_EDIT(list);
+	if (CURRENT_NODE_BEYOND_END) {
+		list->currentIndex = list->size;
+	}
+	if (list->skipIndex != NULL) {
+		skipIndexInvalidate(list->skipIndex);
+	}
+
+	if (list->log != NULL) {
+		logTouched(list);
+	}
+
+	if (removedHead != NULL) {
+		releaseNodeRun(list->context, removedHead, removedTail, numPending);
+	}
+	return numRemoved;
 }
 
+/**
+ * Sorts the list into ascending order with a stable merge sort, relinking the existing
+ * nodes rather than allocating. Comparator is called with two items and returns a
+ * negative number, zero or a positive number as the first sorts before, with or after
+ * the second; items that compare equal keep their order.
+ * The first item becomes the current one.
+ * Returns 0 if successful, -1 if list or comparator is NULL.
+ */
+int ListSort(LIST *list, int (*comparator)(void *, void *)) {
+	return ListSortParallel(list, comparator, 1);
+}
 
-/***************************************************************
- * Static Functions                                            *
- ***************************************************************/
+/**
+ * As ListSort, but splits a large list into up to numThreads chunks that are sorted on
+ * worker threads and then merged, so comparator must be safe to call from several threads
+ * at once. Lists too short to be worth splitting, and lists in builds without
+ * LIST_THREAD_SAFE, are sorted on the calling thread.
+ * Returns 0 if successful, -1 if list or comparator is NULL.
+ */
+int ListSortParallel(LIST *list, int (*comparator)(void *, void *), int numThreads) {
+	COUNT_CALL(LIST_OP_SORT);
+	if (NULL_ARGS(LIST_OP_SORT, list == NULL || comparator == NULL)) {
+		return -1;
+	}
+	if (list->size < 2) {
+		return 0;
+	}
+
+	int numChunks = numThreads;
+	if (numChunks > SORT_MAX_THREADS) {
+		numChunks = SORT_MAX_THREADS;
+	}
+	if (numChunks > list->size / SORT_MIN_CHUNK_NODES) {
+		numChunks = list->size / SORT_MIN_CHUNK_NODES;
+	}
+	if (numChunks < 1) {
+		numChunks = 1;
+	}
+#ifndef LIST_THREAD_SAFE
+	numChunks = 1;
+#endif
+
+	/* Cut the list into chunks of nearly equal size, each ending in a NULL next link */
+	SORT_CHUNK chunks[SORT_MAX_THREADS];
+	NODE *node = list->head;
+	for (int i = 0; i < numChunks; i++) {
+		int chunkSize = list->size / numChunks + (i < list->size % numChunks ? 1 : 0);
+		chunks[i].list = list;
+		chunks[i].comparator = comparator;
+		chunks[i].run = node;
+		for (int j = 1; j < chunkSize; j++) {
+			node = NEXT(node);
+		}
+		NODE *next = NEXT(node);
+		SET_NEXT(node, NULL);
+		node = next;
+	}
+
+#ifdef LIST_THREAD_SAFE
+	/* The calling thread sorts the first chunk itself, and any chunk a thread could not be started for */
+	pthread_t threads[SORT_MAX_THREADS];
+	int started[SORT_MAX_THREADS] = { 0 };
+	for (int i = 1; i < numChunks; i++) {
+		started[i] = pthread_create(&threads[i], NULL, sortChunkWorker, &chunks[i]) == 0;
+	}
+	for (int i = 0; i < numChunks; i++) {
+		if (started[i]) {
+			pthread_join(threads[i], NULL);
+		} else {
+			sortChunkWorker(&chunks[i]);
+		}
+	}
+#else
+	sortChunkWorker(&chunks[0]);
+#endif
+
+	/* Merge neighbouring chunks, earlier chunk first so that equal items keep their order */
+	for (int width = 1; width < numChunks; width *= 2) {
+		for (int i = 0; i + width < numChunks; i += 2 * width) {
+			chunks[i].run = mergeRuns(list, chunks[i].run, chunks[i + width].run, comparator);
+		}
+	}
+
+	/* Only next links were kept up while merging, so put the previous links back */
+	NODE *previous = NULL;
+	for (node = chunks[0].run; node != NULL; node = NEXT(node)) {
+		SET_PREVIOUS(node, previous);
+		previous = node;
+	}
+	SET_HEAD(list, chunks[0].run);
+	SET_TAIL(list, previous);
+	NOTE_EDIT(list);
+	list->current = list->head;
+	list->currentIsBeyond = 0;
+	list->currentIndex = 0;
+
+	if (list->skipIndex != NULL) {
+		skipIndexInvalidate(list->skipIndex);
+	}
+	if (list->hashIndex != NULL && list->hashIndex->valid) {
+		hashIndexRelabel(list);
+	}
+	if (list->log != NULL) {
+		logTouched(list);
+	}
+	return 0;
+}
 
 /**
- * Add item to empty list
+ * Moves the list's items between its own nodes so that traversal order follows address
+ * order, letting ListNext and ListSearch stream through memory after churn has scattered
+ * the nodes. The list keeps the same nodes, so it takes no nodes from the pool; the nodes
+ * only end up in consecutive slots if they were allocated together, which
+ * ListContextCompact arranges for every list in a context. Items, the current item and
+ * positions are unchanged. The skip and hash indexes are rebuilt when next used, and
+ * cursors on the list must be moved with ListCursorFirst, ListCursorLast or ListCursorInit
+ * before they are used again. The list must not be read by another thread while this runs.
+ * Returns 0 if successful, -1 if the list is NULL or its working space could not be allocated.
  */
-static void addItemToEmptyList(LIST *list, void *item) {
-	NODE node;
-	node.item = item;
-	node.previous = NULL;
-	node.next = NULL;
+int ListCompact(LIST *list) {
+	COUNT_CALL(LIST_OP_COMPACT);
+	if (NULL_ARGS(LIST_OP_COMPACT, list == NULL)) {
+		return -1;
+	}
+	if (list->size < 2) {
+		return 0;
+	}
 
-	int nodeIndex = availableNodeArr[numNodesAvailable - 1];
-	nodePool[nodeIndex] = node;
-	numNodesAvailable--;
+	NODE **nodes = malloc(list->size * sizeof(NODE *));
+	void **items = malloc(list->size * sizeof(void *));
+	if (nodes == NULL || items == NULL) {
+		free(nodes);
+		free(items);
+		return -1;
+	}
+	int currentPosition = -1;
+	int i = 0;
+	for (NODE *node = list->head; node != NULL; node = NEXT(node), i++) {
+		if (node == list->current) {
+			currentPosition = i;
+		}
+		nodes[i] = node;
+		items[i] = node->item;
+	}
 
-	list->current = &nodePool[nodeIndex];
-	list->head = &nodePool[nodeIndex];
-	list->tail = &nodePool[nodeIndex];
-	list->size++;
+	qsort(nodes, list->size, sizeof(NODE *), compareNodeAddresses);
+	layOutNodes(list, nodes, items, currentPosition);
+	free(nodes);
+	free(items);
+	return 0;
 }
 
 /**
- * Add item to list with only one item
+ * Gives the list a skip index, so that ListSeek takes O(log n) steps instead of O(n).
+ * The index is kept up to date by the single item operations and rebuilt on the next
+ * seek after the bulk ones. It costs about one tower for every few items.
+ * Returns 0 if successful, -1 if failed.
  */
-static void addItemToListSizeOne(LIST *list, void *item, int afterHead) {
-	NODE node;
-	node.item = item;
-	if (afterHead) {
-		node.previous = list->head;
-		node.next = NULL;
-	} else {
-		node.previous = NULL;
-		node.next = list->head;
+int ListEnableSkipIndex(LIST *list) {
+	if (list == NULL) {
+		return -1;
+	}
+	if (list->skipIndex != NULL) {
+		return 0;
 	}
 
-	int nodeIndex = availableNodeArr[numNodesAvailable - 1];
-	nodePool[nodeIndex] = node;
-	numNodesAvailable--;
+	SKIP_INDEX *index = calloc(1, sizeof(SKIP_INDEX));
+	if (index == NULL) {
+		return -1;
+	}
+	index->head = calloc(1, sizeof(SKIP_TOWER) + SKIP_MAX_LEVELS * sizeof(struct SKIP_LINK));
+	if (index->head == NULL) {
+		free(index);
+		return -1;
+	}
+	index->head->height = SKIP_MAX_LEVELS;
+	index->randomState = (uint32_t)(uintptr_t)list | 1;
+	list->skipIndex = index;
+	return skipIndexRebuild(list);
+}
 
-	list->current = &nodePool[nodeIndex];
-	if (afterHead) {
-		list->head->next = &nodePool[nodeIndex];
-		list->tail = &nodePool[nodeIndex];
+/**
+ * Removes the list's skip index, if it has one.
+ */
+void ListDisableSkipIndex(LIST *list) {
+	if (list == NULL || list->skipIndex == NULL) {
+		return;
+	}
+
+	skipIndexInvalidate(list->skipIndex);
+	free(list->skipIndex->head);
+	free(list->skipIndex);
+	list->skipIndex = NULL;
+}
+
+/**
+ * Returns the item at the given position of the list, counting from 0, and makes it the current item.
+ * Uses the list's skip index if it has one. Otherwise it walks from whichever of the head,
+ * the tail and the current item is closest.
+ * Returns NULL and leaves the current pointer unchanged if the position is out of range.
+ */
+void *ListSeek(LIST *list, int index) {
+	COUNT_CALL(LIST_OP_SEEK);
+	if (NULL_ARGS(LIST_OP_SEEK, list == NULL) || index < 0 || index >= list->size) {
+		return NULL;
+	}
+
+	NODE *node = NULL;
+	if (list->skipIndex != NULL && (list->skipIndex->valid || (COUNT_SKIP_REBUILD(), skipIndexRebuild(list) == 0))) {
+		node = skipIndexFind(list, index);
 	} else {
-		list->head = &nodePool[nodeIndex];
-		list->tail = list->head->next;
-		list->tail->previous = list->head;
+		int start = 0;
+		node = list->head;
+		if (list->size - 1 - index < index) {
+			start = list->size - 1;
+			node = list->tail;
+		}
+		if (list->current != NULL && list->currentIndex != POSITION_UNKNOWN
+				&& abs(list->currentIndex - index) < abs(start - index)) {
+			start = list->currentIndex;
+			node = list->current;
+		}
+		for (; start < index; start++) {
+			node = NEXT(node);
+		}
+		for (; start > index; start--) {
+			node = PREVIOUS(node);
+		}
 	}
+
+	list->current = node;
 	list->currentIsBeyond = 0;
-	list->size++;
+	list->currentIndex = index;
+	return node->item;
 }
 
 /**
- * Add item between two index items of a non-empty list
+ * Returns the position of the current item in the list, counting from 0.
+ * If the current item was reached by ListFind, its position is counted once here.
+ * Returns -1 if there is no current item.
  */
-static void addItemBetweenTwoOthers(LIST *list, void *item, NODE *pre, NODE *post) {
-	NODE node;
-	node.item = item;
-	node.previous = pre;
-	node.next = post;
+int ListIndexOfCurrent(LIST *list) {
+	if (list == NULL || list->current == NULL) {
+		return -1;
+	}
 
-	int nodeIndex = availableNodeArr[numNodesAvailable - 1];
-	nodePool[nodeIndex] = node;
-	numNodesAvailable--;
-	
-	pre->next = &nodePool[nodeIndex];
-	post->previous = &nodePool[nodeIndex];
+	if (list->currentIndex == POSITION_UNKNOWN) {
+		list->currentIndex = 0;
+		for (NODE *node = PREVIOUS(list->current); node != NULL; node = PREVIOUS(node)) {
+			list->currentIndex++;
+		}
+	}
+	return list->currentIndex;
+}
 
-	list->current = &nodePool[nodeIndex];
-	list->size++;
+/**
+ * Gives the list a hash index, so that ListFind finds an item by key in O(1) expected time.
+ * KeyOf returns the key of an item and hash returns the hash of a key.
+ * Comparator is called as in ListSearch, with an item pointer and a key, and returns 1 if they match.
+ * An item may only match keys with the same hash as its own key.
+ * The index is kept up to date by every operation that adds or removes items.
+ * Returns 0 if successful, -1 if failed.
+ */
+int ListEnableHashIndex(LIST *list, void *(*keyOf)(void *), unsigned long (*hash)(void *), int (*comparator)(void *, void *)) {
+	if (list == NULL || keyOf == NULL || hash == NULL || comparator == NULL) {
+		return -1;
+	}
+	ListDisableHashIndex(list);
+
+	HASH_INDEX *index = calloc(1, sizeof(HASH_INDEX));
+	if (index == NULL) {
+		return -1;
+	}
+	index->keyOf = keyOf;
+	index->hash = hash;
+	index->comparator = comparator;
+	index->freeEntry = -1;
+	list->hashIndex = index;
+	return hashIndexRebuild(list);
+}
+
+/**
+ * Removes the list's hash index, if it has one.
+ */
+void ListDisableHashIndex(LIST *list) {
+	if (list == NULL || list->hashIndex == NULL) {
+		return;
+	}
+
+	hashIndexInvalidate(list->hashIndex);
+	free(list->hashIndex);
+	list->hashIndex = NULL;
+}
+
+/**
+ * Finds an item by key using the list's hash index.
+ * The result and the current pointer are exactly as for ListSearch with the index's comparator
+ * and the key: the first match from the current item on becomes the current item and is returned.
+ * If no match is found, the current pointer is left beyond the end of the list and NULL is returned.
+ * Returns NULL without changing the list if it has no hash index.
+ */
+void *ListFind(LIST *list, void *key) {
+	COUNT_CALL(LIST_OP_FIND);
+	if (NULL_ARGS(LIST_OP_FIND, list == NULL) || list->hashIndex == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	HASH_INDEX *index = list->hashIndex;
+	if (!index->valid && hashIndexRebuild(list) != 0) {
+		return searchList(list, index->comparator, key);
+	}
+
+	NODE *start = (list->current == NULL && CURRENT_NODE_BEYOND_START) ? list->head : list->current;
+	NODE *found = NULL;
+	if (start != NULL) {
+		uint64_t startLabel = 0;
+		if (start != list->head) {
+			unsigned long startHash = (* index->hash)((* index->keyOf)(start->item));
+			startLabel = index->entries[hashIndexEntryOf(index, start, startHash)].label;
+		}
+
+		/* Of the matches from the start on, the one with the lowest label is the first in the list */
+		unsigned long hash = (* index->hash)(key);
+		uint64_t foundLabel = 0;
+		for (int e = index->buckets[hash & (index->numBuckets - 1)]; e != -1; e = index->entries[e].next) {
+			HASH_ENTRY *entry = &index->entries[e];
+			if (entry->hash == hash && entry->label >= startLabel && (found == NULL || entry->label < foundLabel)
+					&& (* index->comparator)(entry->node->item, key) == 1) {
+				found = entry->node;
+				foundLabel = entry->label;
+			}
+		}
+	}
+
+	if (found == NULL) {
+		list->current = NULL;
+		list->currentIsBeyond = 1;
+		list->currentIndex = list->size;
+		return NULL;
+	}
+
+	if (found != list->current) {
+		list->current = found;
+		list->currentIndex = POSITION_UNKNOWN;
+	}
 	list->currentIsBeyond = 0;
-}
\ No newline at end of file
+	return found->item;
+}
+
+/**
+ * Sets up a cursor on the list, positioned before its first item.
+ * A cursor is a current pointer of its own: moving it or searching with it leaves
+ * the list and every other cursor alone, so any number of cursors can read the
+ * same list at once, from different threads, as long as nothing changes the list.
+ */
+void ListCursorInit(LIST_CURSOR *cursor, LIST *list) {
+	if (cursor == NULL) {
+		return;
+	}
+
+	cursor->list = list;
+	cursor->current = NULL;
+	cursor->currentIsBeyond = -1;
+	cursor->currentIndex = -1;
+	cursor->edits = list != NULL ? LOAD_SHARED(list->edits) : 0;
+}
+
+/**
+ * Moves the cursor to the first item of its list and returns that item.
+ * Returns NULL if the list is empty.
+ */
+void *ListCursorFirst(LIST_CURSOR *cursor) {
+	if (cursor == NULL || cursor->list == NULL) {
+		return NULL;
+	}
+
+	unsigned edits = LOAD_SHARED(cursor->list->edits);
+	NODE *head = LOAD_SHARED(cursor->list->head);
+	if (head == NULL) {
+		return NULL;
+	}
+	cursor->current = head;
+	cursor->currentIsBeyond = 0;
+	cursor->currentIndex = 0;
+	cursor->edits = edits;
+	return head->item;
+}
+
+/**
+ * Moves the cursor to the last item of its list and returns that item.
+ * Returns NULL if the list is empty.
+ */
+void *ListCursorLast(LIST_CURSOR *cursor) {
+	if (cursor == NULL || cursor->list == NULL) {
+		return NULL;
+	}
+
+	unsigned edits = LOAD_SHARED(cursor->list->edits);
+	NODE *tail = LOAD_SHARED(cursor->list->tail);
+	if (tail == NULL) {
+		return NULL;
+	}
+	cursor->current = tail;
+	cursor->currentIsBeyond = 0;
+	cursor->currentIndex = LOAD_SHARED(cursor->list->size) - 1;
+	cursor->edits = edits;
+	return tail->item;
+}
+
+/**
+ * Advances the cursor and returns its new item.
+ * Returns NULL if the cursor advances beyond the end of the list.
+ */
+void *ListCursorNext(LIST_CURSOR *cursor) {
+	if (cursor == NULL || cursor->list == NULL) {
+		return NULL;
+	}
+
+	LIST *list = cursor->list;
+	NODE *next = NULL;
+	if (cursor->currentIsBeyond == -1) {
+		next = LOAD_SHARED(list->head);
+	} else if (cursor->currentIsBeyond == 0 && cursor->current != NULL) {
+		next = NEXT(cursor->current);
+	}
+
+	if (cursor->currentIsBeyond != 1) {
+		cursor->currentIndex = POSITION_AFTER(cursor->currentIndex, 1);
+	}
+	cursor->current = next;
+	cursor->currentIsBeyond = next != NULL ? 0 : 1;
+	return next != NULL ? next->item : NULL;
+}
+
+/**
+ * Moves the cursor back and returns its new item.
+ * Returns NULL if the cursor moves beyond the start of the list.
+ */
+void *ListCursorPrev(LIST_CURSOR *cursor) {
+	if (cursor == NULL || cursor->list == NULL) {
+		return NULL;
+	}
+
+	LIST *list = cursor->list;
+	NODE *previous = NULL;
+	if (cursor->currentIsBeyond == 1) {
+		previous = LOAD_SHARED(list->tail);
+	} else if (cursor->currentIsBeyond == 0 && cursor->current != NULL) {
+		previous = PREVIOUS(cursor->current);
+	}
+
+	if (cursor->currentIsBeyond != -1) {
+		cursor->currentIndex = POSITION_AFTER(cursor->currentIndex, -1);
+	}
+	cursor->current = previous;
+	cursor->currentIsBeyond = previous != NULL ? 0 : -1;
+	return previous != NULL ? previous->item : NULL;
+}
+
+/**
+ * Returns the item the cursor is on, or NULL if it is beyond either end of the list.
+ */
+void *ListCursorCurr(LIST_CURSOR *cursor) {
+	if (cursor == NULL || cursor->currentIsBeyond != 0 || cursor->current == NULL) {
+		return NULL;
+	}
+	return cursor->current->item;
+}
+
+/**
+ * Searches the list from the cursor's item on, exactly as ListSearch does from the
+ * list's current item, but moves the cursor instead of the list's current pointer.
+ */
+void *ListCursorSearch(LIST_CURSOR *cursor, int (*comparator)(void *, void *), void *comparisonArg) {
+	COUNT_CALL(LIST_OP_CURSOR_SEARCH);
+	if (NULL_ARGS(LIST_OP_CURSOR_SEARCH, cursor == NULL || cursor->list == NULL || comparator == NULL)
+			|| LOAD_SHARED(cursor->list->head) == NULL) {
+		return NULL;
+	}
+
+	LIST *list = cursor->list;
+	NODE *searchNode = (cursor->current == NULL && cursor->currentIsBeyond == -1) ?
+		LOAD_SHARED(list->head) : cursor->current;
+	int searchIndex = cursor->currentIsBeyond == -1 ? 0 : cursor->currentIndex;
+	long numVisited = 0;
+	while (searchNode != NULL) {
+		numVisited++;
+		if ((* comparator)(searchNode->item, comparisonArg) == 1) {
+			cursor->current = searchNode;
+			cursor->currentIsBeyond = 0;
+			cursor->currentIndex = searchIndex;
+			COUNT_VISITS(numVisited);
+			return searchNode->item;
+		}
+		searchNode = NEXT(searchNode);
+		searchIndex = POSITION_AFTER(searchIndex, 1);
+	}
+
+	COUNT_VISITS(numVisited);
+	cursor->current = NULL;
+	cursor->currentIsBeyond = 1;
+	cursor->currentIndex = searchIndex;
+	return NULL;
+}
+
+/**
+ * Adds the item after the cursor's item, as ListAdd does after the current item,
+ * and moves the cursor to it. The list's own current item stays where it was.
+ * Returns 0 if successful, -1 if failed.
+ */
+int ListCursorAdd(LIST_CURSOR *cursor, void *item) {
+	if (cursor == NULL || cursor->list == NULL) {
+		return -1;
+	}
+
+	LIST_CURSOR saved;
+	cursorEnter(cursor, &saved);
+	int result = ListAdd(cursor->list, item);
+	cursorLeave(cursor, &saved, result == 0 ? 1 : 0, cursor->list->currentIndex, NULL);
+	return result;
+}
+
+/**
+ * Adds the item before the cursor's item, as ListInsert does before the current item,
+ * and moves the cursor to it. The list's own current item stays where it was.
+ * Returns 0 if successful, -1 if failed.
+ */
+int ListCursorInsert(LIST_CURSOR *cursor, void *item) {
+	if (cursor == NULL || cursor->list == NULL) {
+		return -1;
+	}
+
+	LIST_CURSOR saved;
+	cursorEnter(cursor, &saved);
+	int result = ListInsert(cursor->list, item);
+	cursorLeave(cursor, &saved, result == 0 ? 1 : 0, cursor->list->currentIndex, NULL);
+	return result;
+}
+
+/**
+ * Removes the cursor's item and returns it, moving the cursor on as ListRemove moves
+ * the current pointer. If the list's own current item is the one removed, it moves
+ * on in the same way; otherwise it stays where it was.
+ * Any other cursor on the removed item must be moved with ListCursorFirst, ListCursorLast
+ * or ListCursorInit before it is used again.
+ */
+void *ListCursorRemove(LIST_CURSOR *cursor) {
+	if (cursor == NULL || cursor->list == NULL) {
+		return NULL;
+	}
+
+	NODE *removedNode = cursor->currentIsBeyond == 0 ? cursor->current : NULL;
+	LIST_CURSOR saved;
+	cursorEnter(cursor, &saved);
+	int position = cursor->list->currentIndex;
+	void *item = ListRemove(cursor->list);
+	cursorLeave(cursor, &saved, item != NULL ? -1 : 0, position, item != NULL ? removedNode : NULL);
+	return item;
+}
+
+/**
+ * Writes the list to a file descriptor: a header, then each item as a length-prefixed
+ * record from codec->encode, gathered into as few writev calls as possible. The bytes
+ * an encoding points at are written in place, so they must stay put until this returns.
+ * The current item is not changed.
+ * Returns 0 if successful, -1 if failed, in which case part of the list may have been written.
+ */
+int ListSerialize(LIST *list, int fd, const LIST_CODEC *codec) {
+	if (list == NULL || codec == NULL || codec->encode == NULL) {
+		return -1;
+	}
+
+	/* Gather every encoding first, as the header needs the total length */
+	SERIAL_RECORD *records = malloc(((size_t)list->size + 1) * sizeof(SERIAL_RECORD));
+	if (records == NULL) {
+		return -1;
+	}
+	SERIAL_HEADER header = { .magic = SERIAL_MAGIC, .version = SERIAL_VERSION, .count = list->size };
+	int i = 0;
+	for (NODE *node = list->head; node != NULL; node = NEXT(node), i++) {
+		records[i].length = (* codec->encode)(node->item, &records[i].bytes, codec->arg);
+		header.payloadBytes += sizeof(uint64_t) + records[i].length + SERIAL_PADDING(records[i].length);
+	}
+
+	static const char padding[8];
+	struct iovec iov[SERIAL_MAX_IOVECS];
+	int numIovecs = 1;
+	int result = 0;
+	iov[0].iov_base = &header;
+	iov[0].iov_len = sizeof(header);
+	for (i = 0; i < list->size && result == 0; i++) {
+		iov[numIovecs].iov_base = &records[i].length;
+		iov[numIovecs].iov_len = sizeof(uint64_t);
+		numIovecs++;
+		if (records[i].length > 0) {
+			iov[numIovecs].iov_base = (void *)records[i].bytes;
+			iov[numIovecs].iov_len = records[i].length;
+			numIovecs++;
+		}
+		if (SERIAL_PADDING(records[i].length) > 0) {
+			iov[numIovecs].iov_base = (void *)padding;
+			iov[numIovecs].iov_len = SERIAL_PADDING(records[i].length);
+			numIovecs++;
+		}
+		if (numIovecs > SERIAL_MAX_IOVECS - 3) {
+			result = writeFully(fd, iov, numIovecs);
+			numIovecs = 0;
+		}
+	}
+	if (result == 0 && numIovecs > 0) {
+		result = writeFully(fd, iov, numIovecs);
+	}
+
+	free(records);
+	return result;
+}
+
+/**
+ * Reads a list written by ListSerialize from a file descriptor into a new list in the given context,
+ * leaving the descriptor just past it. A regular file is mapped rather than read where it can be, and
+ * each record is handed to codec->decode where it lies, so decode must copy whatever the item needs to keep.
+ * Items are appended in runs as they are decoded, and the first item becomes the current one.
+ * Returns NULL if the data is not a serialized list, an item could not be decoded or nodes ran out;
+ * items decoded before a failure are passed to codec->itemFree.
+ */
+LIST *ListDeserialize(LIST_CONTEXT *context, int fd, const LIST_CODEC *codec) {
+	if (context == NULL || codec == NULL || codec->decode == NULL) {
+		return NULL;
+	}
+
+	LIST *list = ListCreateIn(context);
+	if (list == NULL) {
+		return NULL;
+	}
+
+	int result = -1;
+	int mapped = 0;
+	struct stat fileStat;
+	off_t start = lseek(fd, 0, SEEK_CUR);
+	if (start >= 0 && fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode)) {
+		/* Map from the page holding the start of the list to the end of the file */
+		off_t mapStart = start & ~((off_t)sysconf(_SC_PAGESIZE) - 1);
+		size_t mapLength = fileStat.st_size > mapStart ? (size_t)(fileStat.st_size - mapStart) : 0;
+		unsigned char *map = mapLength > 0 ? mmap(NULL, mapLength, PROT_READ, MAP_PRIVATE, fd, mapStart) : MAP_FAILED;
+		if (map != MAP_FAILED) {
+			/* The list can start at any offset, so its header is copied out rather than read in place */
+			SERIAL_HEADER header;
+			const unsigned char *data = map + (start - mapStart);
+			uint64_t available = mapLength - (start - mapStart);
+			mapped = 1;
+			if (available >= sizeof(SERIAL_HEADER)) {
+				memcpy(&header, data, sizeof(SERIAL_HEADER));
+				if (checkSerialHeader(&header, available - sizeof(SERIAL_HEADER)) == 0) {
+					result = loadRecords(list, data + sizeof(SERIAL_HEADER), &header, codec);
+					lseek(fd, start + sizeof(SERIAL_HEADER) + header.payloadBytes, SEEK_SET);
+				}
+			}
+			munmap(map, mapLength);
+		}
+	}
+	if (!mapped) {
+		/* Pipes, sockets and files that cannot be mapped are read into one buffer for the whole list */
+		SERIAL_HEADER header;
+		if (readFully(fd, &header, sizeof(header)) == 0 && checkSerialHeader(&header, SIZE_MAX) == 0) {
+			unsigned char *records = malloc(header.payloadBytes > 0 ? header.payloadBytes : 1);
+			if (records != NULL && readFully(fd, records, header.payloadBytes) == 0) {
+				result = loadRecords(list, records, &header, codec);
+			}
+			free(records);
+		}
+	}
+
+	if (result != 0) {
+		ListFree(list, codec->itemFree);
+		return NULL;
+	}
+	ListFirst(list);
+	return list;
+}
+
+/**
+ * Opens a mutation log at the given path, creating the file if it does not exist and adding
+ * to the end of it if it does. Lists given to ListEnableLog record each append, prepend,
+ * add, insert, remove, trim, concatenation and free, with items encoded by the codec.
+ * Records are written and synced config->groupSize at a time, so a crash loses at most the
+ * records of an unfinished group, and ListLogCommit makes everything before it durable.
+ * When the file has grown past config->checkpointBytes, ListLogCommit also checkpoints it, so
+ * no logged list may be changed while it runs; commits made because a group filled never do.
+ * A NULL config syncs only on ListLogCommit and never checkpoints by itself.
+ * Returns NULL if the file could not be opened.
+ */
+LIST_LOG *ListLogOpen(const char *path, const LIST_CODEC *codec, const LIST_LOG_CONFIG *config) {
+	if (path == NULL || codec == NULL || codec->encode == NULL) {
+		return NULL;
+	}
+
+	LIST_LOG *log = calloc(1, sizeof(LIST_LOG));
+	if (log == NULL) {
+		return NULL;
+	}
+	log->path = malloc(strlen(path) + 1);
+	log->fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (log->path == NULL || log->fd < 0) {
+		if (log->fd >= 0) {
+			close(log->fd);
+		}
+		free(log->path);
+		free(log);
+		return NULL;
+	}
+	strcpy(log->path, path);
+	log->size = lseek(log->fd, 0, SEEK_END);
+	log->replacedFd = -1;
+	log->codec = *codec;
+	if (config != NULL) {
+		log->config = *config;
+	}
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_init(&log->lock, NULL);
+#endif
+	return log;
+}
+
+/**
+ * Commits whatever the log holds, stops its lists being logged and closes it.
+ * Call ListLogCommit first to find out whether the last records reached the file.
+ */
+void ListLogClose(LIST_LOG *log) {
+	if (log == NULL) {
+		return;
+	}
+
+	ListLogCommit(log);
+	for (int id = 0; id < LIST_LOG_MAX_LISTS; id++) {
+		if (log->lists[id] != NULL) {
+			log->lists[id]->log = NULL;
+		}
+	}
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_destroy(&log->lock);
+#endif
+	if (log->replacedFd >= 0) {
+		close(log->replacedFd);
+	}
+	close(log->fd);
+	free(log->buffer);
+	free(log->path);
+	free(log);
+}
+
+/**
+ * Starts recording the list's changes in the log under the given id, which ListLogReplay
+ * uses to put its records back together. The list's items are recorded first, so the log
+ * holds the list as it is now.
+ * Lists logged to one log may be used from different threads in the thread-safe build,
+ * as long as none is changed during a checkpoint.
+ * Returns 0 if successful, -1 if the id is out of range or taken, or the list is already logged.
+ */
+int ListEnableLog(LIST *list, LIST_LOG *log, int id) {
+	if (list == NULL || log == NULL || list->log != NULL || id < 0 || id >= LIST_LOG_MAX_LISTS) {
+		return -1;
+	}
+
+	LOCK_LOG(log);
+	if (log->lists[id] != NULL) {
+		UNLOCK_LOG(log);
+		return -1;
+	}
+	log->lists[id] = list;
+	if (bufferSnapshot(log, id) != 0) {
+		log->lists[id] = NULL;
+		UNLOCK_LOG(log);
+		return -1;
+	}
+	list->log = log;
+	list->logId = id;
+	UNLOCK_LOG(log);
+	return 0;
+}
+
+/**
+ * Stops recording the list's changes. Records already made are kept, so a replay brings
+ * the list back as it was at this point.
+ */
+void ListDisableLog(LIST *list) {
+	if (list == NULL || list->log == NULL) {
+		return;
+	}
+
+	LIST_LOG *log = list->log;
+	LOCK_LOG(log);
+	log->lists[list->logId] = NULL;
+	log->dirty[list->logId] = 0;
+	list->log = NULL;
+	UNLOCK_LOG(log);
+}
+
+/**
+ * Writes every record made so far to the log file with one write and one sync,
+ * checkpointing afterwards if the file has grown past the configured size, in which case
+ * no logged list may be changed by another thread while it runs.
+ * Returns 0 if successful, -1 if the write failed, in which case the records are kept for
+ * the next commit, or if a list's changes could not be recorded for lack of memory;
+ * such a list is written out whole with its next change or checkpoint.
+ */
+int ListLogCommit(LIST_LOG *log) {
+	if (log == NULL) {
+		return -1;
+	}
+
+	LOCK_LOG(log);
+	int result = commitLog(log);
+	if (result == 0 && log->config.checkpointBytes > 0 && log->size >= log->config.checkpointBytes) {
+		result = checkpointLog(log);
+	}
+	for (int id = 0; id < LIST_LOG_MAX_LISTS && result == 0; id++) {
+		result = log->dirty[id] ? -1 : 0;
+	}
+	UNLOCK_LOG(log);
+	return result;
+}
+
+/**
+ * Replaces the log file with one that holds just the current items of each logged list,
+ * so that replay no longer has to go through their history. The new file is written and
+ * synced beside the old one, then renamed over it, and the directory is synced. It reads
+ * every logged list, so none of them may be changed by another thread while it runs.
+ * Returns 0 if successful, -1 if failed, in which case the old file is still in use; if only
+ * the directory sync failed, the new file is in use and commits fail until it succeeds.
+ */
+int ListLogCheckpoint(LIST_LOG *log) {
+	if (log == NULL) {
+		return -1;
+	}
+
+	LOCK_LOG(log);
+	int result = checkpointLog(log);
+	UNLOCK_LOG(log);
+	return result;
+}
+
+/**
+ * Rebuilds lists from the log file at the given path, in the given context, before it is
+ * opened again with ListLogOpen. The list logged under id i is left in lists[i], which should
+ * be NULL or a list to replay onto; ids of freed lists are left NULL. Records for ids of numLists
+ * or more are skipped, though a list concatenated from one of them onto a lower id cannot be rebuilt.
+ * Items are made with codec->decode, and the items of removed records are passed to codec->itemFree.
+ * A record torn by a crash ends the log, and is cut off the file. Current items are not restored.
+ * Returns the number of records read, skipped ones included, or -1 if the file could not be read
+ * or a record did not fit the lists built so far.
+ */
+int ListLogReplay(const char *path, LIST_CONTEXT *context, const LIST_CODEC *codec, LIST **lists, int numLists) {
+	if (path == NULL || context == NULL || codec == NULL || codec->decode == NULL || lists == NULL || numLists < 0) {
+		return -1;
+	}
+
+	int fd = open(path, O_RDWR);
+	if (fd < 0) {
+		return errno == ENOENT ? 0 : -1;
+	}
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0) {
+		close(fd);
+		return -1;
+	}
+	if (fileStat.st_size == 0) {
+		close(fd);
+		return 0;
+	}
+	size_t size = fileStat.st_size;
+	unsigned char *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		close(fd);
+		return -1;
+	}
+
+	size_t offset = 0;
+	int numReplayed = 0;
+	int result = 0;
+	while (size - offset >= sizeof(LOG_RECORD)) {
+		LOG_RECORD record;
+		memcpy(&record, map + offset, sizeof(LOG_RECORD));
+		const unsigned char *bytes = map + offset + sizeof(LOG_RECORD);
+		size_t recordBytes = sizeof(LOG_RECORD) + record.length + SERIAL_PADDING(record.length);
+		if (recordBytes > size - offset || recordChecksum(&record, bytes) != record.checksum) {
+			break;
+		}
+		if (replayRecord(context, codec, lists, numLists, &record, bytes) != 0) {
+			result = -1;
+			break;
+		}
+		offset += recordBytes;
+		numReplayed++;
+	}
+
+	munmap(map, size);
+	if (result == 0 && offset < size && ftruncate(fd, offset) != 0) {
+		result = -1;
+	}
+	close(fd);
+	return result == 0 ? numReplayed : -1;
+}
+
+/**
+ * Starts a read of a list whose context uses epoch reclamation.
+ * Between ListEpochEnter and ListEpochExit the thread may scan the list with a cursor
+ * (ListCursorFirst, Last, Next, Prev, Curr and Search) without a lock while another
+ * thread adds and removes items: nodes released in the meantime are not reused until
+ * every reader that might still be on them has left. A reader sees each item that stays
+ * in the list for the whole scan; items added or removed during it may or may not be seen.
+ * Scanning backwards may also visit an item after its removal. Items themselves belong to
+ * the caller, so an item removed during a read must be kept alive until its readers have left,
+ * and the list itself must not be freed while it is being read.
+ * Returns the epoch to pass to ListEpochExit. Outside the thread-safe build, or for a
+ * context without epoch reclamation, it does nothing and returns 0.
+ */
+unsigned ListEpochEnter(LIST *list) {
+	if (list == NULL || !EPOCH_RECLAIM(list->context)) {
+		return 0;
+	}
+
+#ifdef LIST_THREAD_SAFE
+	/* If the epoch moved on while we counted ourselves in, the count may have been missed */
+	LIST_CONTEXT *context = list->context;
+	for (;;) {
+		unsigned epoch = __atomic_load_n(&context->epoch, __ATOMIC_SEQ_CST);
+		__atomic_fetch_add(&context->numReaders[epoch & 1], 1, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&context->epoch, __ATOMIC_SEQ_CST) == epoch) {
+			return epoch;
+		}
+		__atomic_fetch_sub(&context->numReaders[epoch & 1], 1, __ATOMIC_SEQ_CST);
+	}
+#else
+	return 0;
+#endif
+}
+
+/**
+ * Ends a read started by ListEpochEnter, which returned epoch.
+ * The reader must not use any node or item it found during the read afterwards.
+ */
+void ListEpochExit(LIST *list, unsigned epoch) {
+	if (list == NULL || !EPOCH_RECLAIM(list->context)) {
+		return;
+	}
+
+#ifdef LIST_THREAD_SAFE
+	__atomic_fetch_sub(&list->context->numReaders[epoch & 1], 1, __ATOMIC_RELEASE);
+#else
+	(void)epoch;
+#endif
+}
+
+/**
+ * Fills stats with the call and failure counts of every operation so far, summed over
+ * all threads and contexts, and with the node and list usage of the given context, or of
+ * the default context if it is NULL. Each thread counts into its own block without
+ * atomic read-modify-writes, so counts from threads still running may trail by a few calls.
+ * Nodes cached by a thread count as in use. In a build with LIST_NO_STATS the counts and
+ * peaks are all 0, as is nodesInUse in the lock-free build unless the context has a node limit.
+ */
+void ListGetStats(LIST_CONTEXT *context, LIST_STATS *stats) {
+	if (stats == NULL) {
+		return;
+	}
+	if (context == NULL) {
+		context = &defaultContext;
+	}
+	memset(stats, 0, sizeof(LIST_STATS));
+
+#ifndef LIST_NO_STATS
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_lock(&statsLock);
+	addStats(stats, &exitedStats);
+	for (STATS_BLOCK *block = statsBlocks; block != NULL; block = block->next) {
+		addStats(stats, block);
+	}
+	pthread_mutex_unlock(&statsLock);
+#else
+	addStats(stats, &threadStats);
+#endif
+#endif
+
+	LOCK_CONTEXT(context);
+#ifdef LIST_LOCK_FREE
+	stats->nodesInUse = COUNTS_NODES(context) ? __atomic_load_n(&context->numNodesInUse, __ATOMIC_RELAXED) : 0;
+#else
+	stats->nodesInUse = NODES_IN_USE(context);
+#endif
+	stats->listsInUse = LISTS_IN_USE(context);
+#ifndef LIST_NO_STATS
+	stats->peakNodesInUse = __atomic_load_n(&context->peakNodesInUse, __ATOMIC_RELAXED);
+	stats->peakListsInUse = context->peakListsInUse;
+
+	/* Reopening a file-backed pool puts nodes in use without taking them from the free list */
+	if (stats->peakNodesInUse < stats->nodesInUse) {
+		stats->peakNodesInUse = stats->nodesInUse;
+	}
+#endif
+	UNLOCK_CONTEXT(context);
+}
+
+/**
+ * Returns the name of the list function an operation counted by ListGetStats stands for,
+ * or NULL if op is out of range.
+ */
+const char *ListOpName(LIST_OP op) {
+	if ((int)op < 0 || op >= LIST_NUM_OPS) {
+		return NULL;
+	}
+	return opNames[op];
+}
+
+/**
+ * Fills latency[op], for each of the LIST_NUM_OPS operations, with the number of calls
+ * timed since the last ListResetLatency and the percentiles of their latency.
+ * Latencies are kept in buckets a quarter of a power of 2 wide, so each percentile is
+ * within 25% above the true one. Calls from every thread are included, those from threads
+ * still running as of their last few calls. Converting from TSC ticks measures the tick
+ * rate first, which takes about a millisecond.
+ * Only available in a build with LIST_LATENCY_HISTOGRAMS.
+ * Returns 0 if successful, -1 if failed.
+ */
+int ListGetLatency(LIST_LATENCY *latency) {
+#ifdef LIST_LATENCY_HISTOGRAMS
+	if (latency == NULL) {
+		return -1;
+	}
+
+	uint64_t (*counts)[LATENCY_BUCKETS] = calloc(LIST_NUM_OPS, sizeof(*counts));
+	if (counts == NULL) {
+		return -1;
+	}
+	sumLatency(counts);
+	double nsPerTick = measureNsPerTick();
+
+	for (int op = 0; op < LIST_NUM_OPS; op++) {
+		memset(&latency[op], 0, sizeof(LIST_LATENCY));
+		for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+			latency[op].count += counts[op][bucket];
+		}
+
+		/* Walk up the buckets until each percentile's share of the calls is covered */
+		uint64_t seen = 0;
+		uint64_t p50 = (latency[op].count * 500 + 999) / 1000;
+		uint64_t p99 = (latency[op].count * 990 + 999) / 1000;
+		uint64_t p999 = (latency[op].count * 999 + 999) / 1000;
+		for (int bucket = 0; bucket < LATENCY_BUCKETS && seen < latency[op].count; bucket++) {
+			if (counts[op][bucket] == 0) {
+				continue;
+			}
+			seen += counts[op][bucket];
+			uint64_t limitNs = (uint64_t)(latencyBucketLimit(bucket) * nsPerTick);
+			if (latency[op].p50Ns == 0 && seen >= p50) {
+				latency[op].p50Ns = limitNs;
+			}
+			if (latency[op].p99Ns == 0 && seen >= p99) {
+				latency[op].p99Ns = limitNs;
+			}
+			if (latency[op].p999Ns == 0 && seen >= p999) {
+				latency[op].p999Ns = limitNs;
+			}
+			latency[op].maxNs = limitNs;
+		}
+	}
+
+	free(counts);
+	return 0;
+#else
+	(void)latency;
+	return -1;
+#endif
+}
+
+/**
+ * Writes the latency of each operation timed since the last ListResetLatency to a file
+ * descriptor as CSV: a header row, then a row of operation, count, p50_ns, p99_ns, p999_ns
+ * and max_ns for each operation that was called.
+ * Only available in a build with LIST_LATENCY_HISTOGRAMS.
+ * Returns 0 if successful, -1 if failed.
+ */
+int ListDumpLatency(int fd) {
+	LIST_LATENCY latency[LIST_NUM_OPS];
+	if (ListGetLatency(latency) != 0) {
+		return -1;
+	}
+
+	if (dprintf(fd, "operation,count,p50_ns,p99_ns,p999_ns,max_ns\n") < 0) {
+		return -1;
+	}
+	for (int op = 0; op < LIST_NUM_OPS; op++) {
+		if (latency[op].count > 0 && dprintf(fd, "%s,%llu,%llu,%llu,%llu,%llu\n", opNames[op],
+				(unsigned long long)latency[op].count, (unsigned long long)latency[op].p50Ns,
+				(unsigned long long)latency[op].p99Ns, (unsigned long long)latency[op].p999Ns,
+				(unsigned long long)latency[op].maxNs) < 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Starts the latency histograms afresh, so that ListGetLatency and ListDumpLatency only
+ * report calls timed from here on. The counts are not cleared but set aside, so threads
+ * can go on timing calls while this runs.
+ * Only has an effect in a build with LIST_LATENCY_HISTOGRAMS.
+ */
+void ListResetLatency(void) {
+#ifdef LIST_LATENCY_HISTOGRAMS
+	uint64_t (*counts)[LATENCY_BUCKETS] = calloc(LIST_NUM_OPS, sizeof(*counts));
+	if (counts == NULL) {
+		return;
+	}
+	sumLatency(counts);
+
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_lock(&statsLock);
+#endif
+	for (int op = 0; op < LIST_NUM_OPS; op++) {
+		for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+			latencyBaseline[op][bucket] += counts[op][bucket];
+		}
+	}
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_unlock(&statsLock);
+#endif
+	free(counts);
+#endif
+}
+
+/**
+ * Returns the node after the given node of the list, or NULL if it is the tail.
+ */
+NODE *ListNodeNext(LIST *list, NODE *node) {
+	if (list == NULL || node == NULL) {
+		return NULL;
+	}
+	return NEXT(node);
+}
+
+/**
+ * Returns the node before the given node of the list, or NULL if it is the head.
+ */
+NODE *ListNodePrev(LIST *list, NODE *node) {
+	if (list == NULL || node == NULL) {
+		return NULL;
+	}
+	return PREVIOUS(node);
+}
+
+/***************************************************************
+ * Static Functions                                            *
+ ***************************************************************/
+
+/**
+ * Takes a node from the context's pool and sets its item.
+ * The pool grows by one slab when no nodes are available.
+ * Returns NULL if the context's node limit has been reached or the pool could not be grown.
+ * In the thread-safe build nodes come from the calling thread's magazine, and nodes
+ * held in magazines count towards the context's limit.
+ */
+static NODE *allocNode(LIST_CONTEXT *context, void *item) {
+	NODE *node;
+
+#if defined(LIST_LOCK_FREE)
+	int numInUse = 0;
+	while (COUNTS_NODES(context)
+			&& (numInUse = __atomic_add_fetch(&context->numNodesInUse, 1, __ATOMIC_RELAXED)) > NODE_LIMIT(context)) {
+		__atomic_fetch_sub(&context->numNodesInUse, 1, __ATOMIC_RELAXED);
+		if (!EPOCH_RECLAIM(context) || reclaimRetired(context) == 0) {
+			return NULL;
+		}
+	}
+	node = popFreeNode(context);
+	if (node == NULL) {
+		if (COUNTS_NODES(context)) {
+			__atomic_fetch_sub(&context->numNodesInUse, 1, __ATOMIC_RELAXED);
+		}
+		return NULL;
+	}
+	NOTE_PEAK(context->peakNodesInUse, numInUse);
+#elif defined(USE_MAGAZINES)
+	if ((magazine.context != context || magazine.numNodes == 0) && refillMagazine(context) != 0) {
+		return NULL;
+	}
+	magazine.numNodes--;
+	node = nodeAtIndex(context, magazine.nodeIndices[magazine.numNodes]);
+#else
+	if (context->config.maxNodes > 0 && NODES_IN_USE(context) >= context->config.maxNodes
+			&& (!EPOCH_RECLAIM(context) || RECLAIM_RETIRED(context) == 0)) {
+		return NULL;
+	}
+	if (NODE_POOL_EMPTY(context) && growNodePool(context) != 0) {
+		return NULL;
+	}
+	node = takeFreeNodes(context, 1);
+#endif
+
+	node->item = item;
+	SET_PREVIOUS(node, NULL);
+	SET_NEXT(node, NULL);
+	return node;
+}
+
+/**
+ * Takes count nodes from the context's pool at once, sets their items from the array and
+ * links them into a chain in array order.
+ * Returns the first node of the chain and sets last to its last node, or returns NULL
+ * without taking any nodes if the pool cannot supply all of them.
+ */
+static NODE *allocNodeRun(LIST_CONTEXT *context, void **items, int count, NODE **last) {
+	NODE *first = NULL;
+	NODE *previous = NULL;
+
+#ifdef LIST_LOCK_FREE
+	int numInUse = 0;
+	while (COUNTS_NODES(context)
+			&& (numInUse = __atomic_add_fetch(&context->numNodesInUse, count, __ATOMIC_RELAXED)) > NODE_LIMIT(context)) {
+		__atomic_fetch_sub(&context->numNodesInUse, count, __ATOMIC_RELAXED);
+		if (!EPOCH_RECLAIM(context) || reclaimRetired(context) == 0) {
+			return NULL;
+		}
+	}
+	for (int i = 0; i < count; i++) {
+		NODE *node = popFreeNode(context);
+		if (node == NULL) {
+			if (first != NULL) {
+				pushFreeNodes(context, first, previous);
+			}
+			if (COUNTS_NODES(context)) {
+				__atomic_fetch_sub(&context->numNodesInUse, count, __ATOMIC_RELAXED);
+			}
+			return NULL;
+		}
+		SET_NEXT(node, NULL);
+		if (previous != NULL) {
+			SET_NEXT(previous, node);
+		} else {
+			first = node;
+		}
+		previous = node;
+	}
+	previous = NULL;
+	NOTE_PEAK(context->peakNodesInUse, numInUse);
+#else
+	/* Nodes for a run come straight from the shared pool, bypassing any magazine */
+	LOCK_CONTEXT(context);
+	if (context->config.maxNodes > 0 && NODES_IN_USE(context) + count > context->config.maxNodes
+			&& (!EPOCH_RECLAIM(context) || RECLAIM_RETIRED(context) == 0
+			|| NODES_IN_USE(context) + count > context->config.maxNodes)) {
+		UNLOCK_CONTEXT(context);
+		return NULL;
+	}
+	while (context->numNodesAvailable < count) {
+		if (growNodePool(context) != 0) {
+			UNLOCK_CONTEXT(context);
+			return NULL;
+		}
+	}
+	first = takeFreeNodes(context, count);
+	UNLOCK_CONTEXT(context);
+#endif
+
+	/* Fill in the items and back links in one pass over the chain */
+	NODE *node = first;
+	for (int i = 0; i < count; i++) {
+		node->item = items[i];
+		SET_PREVIOUS(node, previous);
+		previous = node;
+		node = nodeOf(context, node->next);
+	}
+	*last = previous;
+	return first;
+}
+
+/**
+ * Returns a node to the context's pool
+ */
+static void releaseNode(LIST_CONTEXT *context, NODE *node) {
+#ifdef LIST_THREAD_SAFE
+	if (EPOCH_RECLAIM(context)) {
+		retireNodes(context, node, node, 1);
+		return;
+	}
+#endif
+
+#if defined(LIST_LOCK_FREE)
+	pushFreeNodes(context, node, node);
+	if (COUNTS_NODES(context)) {
+		__atomic_fetch_sub(&context->numNodesInUse, 1, __ATOMIC_RELAXED);
+	}
+#else
+#ifdef USE_MAGAZINES
+	if (magazine.context == context) {
+		if (magazine.numNodes == MAGAZINE_SIZE) {
+			spillMagazine(MAGAZINE_BATCH);
+		}
+		magazine.nodeIndices[magazine.numNodes] = indexOfNode(node);
+		magazine.numNodes++;
+		return;
+	}
+#endif
+
+	LOCK_CONTEXT(context);
+	giveFreeNodes(context, node, node, 1);
+	UNLOCK_CONTEXT(context);
+#endif
+}
+
+/**
+ * Returns a chain of count nodes, linked first to last through their next pointers,
+ * to the context's pool in one batch. The chain is pushed onto the free list whole,
+ * so this takes constant time however long it is.
+ */
+static void releaseNodeRun(LIST_CONTEXT *context, NODE *first, NODE *last, int count) {
+#ifdef LIST_THREAD_SAFE
+	if (EPOCH_RECLAIM(context)) {
+		retireNodes(context, first, last, count);
+		return;
+	}
+#endif
+
+#if defined(LIST_LOCK_FREE)
+	pushFreeNodes(context, first, last);
+	if (COUNTS_NODES(context)) {
+		__atomic_fetch_sub(&context->numNodesInUse, count, __ATOMIC_RELAXED);
+	}
+#else
+	/* A run goes straight back to the shared pool, bypassing any magazine */
+	LOCK_CONTEXT(context);
+	giveFreeNodes(context, first, last, count);
+	UNLOCK_CONTEXT(context);
+#endif
+}
+
+/**
+ * Adds a slab of nodes to the context's pool and makes them available.
+ * Under epoch reclamation, nodes whose readers have all left are made available instead
+ * when there are any, which may be fewer than the caller needs.
+ * Must be called with the context locked.
+ * Returns 0 if successful, -1 if failed.
+ */
+static int growNodePool(LIST_CONTEXT *context) {
+#ifdef LIST_THREAD_SAFE
+	if (EPOCH_RECLAIM(context) && RECLAIM_RETIRED(context) > 0) {
+		return 0;
+	}
+#endif
+
+	if (context->nodeSlabs == NULL) {
+		context->nodeSlabs = calloc(MAX_NODE_SLABS, sizeof(NODE_SLAB *));
+		if (context->nodeSlabs == NULL) {
+			return -1;
+		}
+	}
+	if (context->numNodeSlabs == MAX_NODE_SLABS) {
+		return -1;
+	}
+
+#ifdef LIST_LOCK_FREE
+	NODE_SLAB *slab = allocNodeSlab(context);
+	if (slab == NULL) {
+		return -1;
+	}
+	slab->baseIndex = context->numNodeSlabs * NODES_PER_SLAB;
+	context->nodeSlabs[context->numNodeSlabs] = slab;
+	context->numNodeSlabs++;
+
+	/* Chain the new nodes in address order and publish them with a single push */
+	for (int i = 0; i < (int)NODES_PER_SLAB; i++) {
+		slab->nodes[i].item = NULL;
+		SET_PREVIOUS(&slab->nodes[i], NULL);
+		SET_NEXT(&slab->nodes[i], i + 1 < (int)NODES_PER_SLAB ? &slab->nodes[i + 1] : NULL);
+	}
+	pushFreeNodes(context, &slab->nodes[0], &slab->nodes[NODES_PER_SLAB - 1]);
+#else
+	NODE_SLAB *slab = allocNodeSlab(context);
+	if (slab == NULL) {
+		return -1;
+	}
+	slab->baseIndex = context->numNodeSlabs * NODES_PER_SLAB;
+	context->nodeSlabs[context->numNodeSlabs] = slab;
+	context->numNodeSlabs++;
+
+	/* Chain the new nodes in address order so that they are handed out in that order */
+	for (int i = 0; i < (int)NODES_PER_SLAB; i++) {
+		SET_NEXT(&slab->nodes[i], i + 1 < (int)NODES_PER_SLAB ? &slab->nodes[i + 1] : NULL);
+	}
+	giveFreeNodes(context, &slab->nodes[0], &slab->nodes[NODES_PER_SLAB - 1], NODES_PER_SLAB);
+#endif
+	return 0;
+}
+
+/**
+ * Adds a slab of list heads to the context's list pool and pushes their indices onto the available stack.
+ * Must be called with the context locked.
+ * Returns 0 if successful, -1 if failed.
+ */
+static int growListPool(LIST_CONTEXT *context) {
+	if (context->listSlabs == NULL) {
+		context->listSlabs = calloc(MAX_LIST_SLABS, sizeof(LIST_SLAB *));
+		if (context->listSlabs == NULL) {
+			return -1;
+		}
+	}
+	if (context->numListSlabs == MAX_LIST_SLABS) {
+		return -1;
+	}
+
+	/* The available stack and in-use flags cover every list head in the pool */
+	int newListCount = (context->numListSlabs + 1) * LISTS_PER_SLAB;
+	int *newAvailableArr = realloc(context->availableListArr, newListCount * sizeof(int));
+	if (newAvailableArr == NULL) {
+		return -1;
+	}
+	context->availableListArr = newAvailableArr;
+	char *newInUse = realloc(context->listInUse, newListCount);
+	if (newInUse == NULL) {
+		return -1;
+	}
+	context->listInUse = newInUse;
+
+	LIST_SLAB *slab = aligned_alloc(LIST_SLAB_BYTES, LIST_SLAB_BYTES);
+	if (slab == NULL) {
+		return -1;
+	}
+	slab->baseIndex = context->numListSlabs * LISTS_PER_SLAB;
+	context->listSlabs[context->numListSlabs] = slab;
+	context->numListSlabs++;
+
+	for (int i = LISTS_PER_SLAB - 1; i >= 0; i--) {
+		context->listInUse[slab->baseIndex + i] = 0;
+		context->availableListArr[context->numListsAvailable] = slab->baseIndex + i;
+		context->numListsAvailable++;
+	}
+	return 0;
+}
+
+/**
+ * Returns a list head to its context's list pool.
+ * Releasing a list that is already back in the pool is ignored.
+ */
+static void releaseList(LIST *list) {
+	LIST_CONTEXT *context = list->context;
+	int listIndex = indexOfList(list);
+
+	ListDisableSkipIndex(list);
+	ListDisableHashIndex(list);
+
+	LOCK_CONTEXT(context);
+	if (context->listInUse[listIndex]) {
+#ifdef USE_FILE_POOLS
+		for (int slot = 0; context->header != NULL && slot < LIST_MAX_ROOTS; slot++) {
+			if (context->roots[slot] == list) {
+				context->roots[slot] = NULL;
+			}
+		}
+#endif
+		context->listInUse[listIndex] = 0;
+		context->availableListArr[context->numListsAvailable] = listIndex;
+		context->numListsAvailable++;
+	}
+	UNLOCK_CONTEXT(context);
+}
+
+#ifdef LIST_LOCK_FREE
+/**
+ * Pops a node off the context's lock-free free list, growing the pool when it is empty.
+ * The tag in the top word changes on every update, so a pop that raced with another
+ * thread popping and re-pushing the same node fails its compare-and-swap and retries.
+ * Returns NULL if the pool could not be grown.
+ */
+static NODE *popFreeNode(LIST_CONTEXT *context) {
+	uint64_t top = __atomic_load_n(&context->freeNodeTop, __ATOMIC_ACQUIRE);
+
+	for (;;) {
+		if (FREE_TOP_INDEX(top) == 0) {
+			/* Only one thread grows the pool; the others see its nodes once it is done */
+			LOCK_CONTEXT(context);
+			top = __atomic_load_n(&context->freeNodeTop, __ATOMIC_ACQUIRE);
+			int grown = FREE_TOP_INDEX(top) != 0 || growNodePool(context) == 0;
+			UNLOCK_CONTEXT(context);
+			if (!grown) {
+				return NULL;
+			}
+			top = __atomic_load_n(&context->freeNodeTop, __ATOMIC_ACQUIRE);
+			continue;
+		}
+
+		NODE *node = nodeAtIndex(context, FREE_TOP_INDEX(top) - 1);
+		NODE *next = nodeOf(context, __atomic_load_n(&node->next, __ATOMIC_RELAXED));
+		uint64_t newTop = FREE_TOP(FREE_TOP_TAG(top) + 1, next != NULL ? indexOfNode(next) + 1 : 0);
+		if (__atomic_compare_exchange_n(&context->freeNodeTop, &top, newTop, 1,
+				__ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+			return node;
+		}
+	}
+}
+
+/**
+ * Pushes a chain of nodes, linked first to last through their next pointers,
+ * onto the context's lock-free free list.
+ */
+static void pushFreeNodes(LIST_CONTEXT *context, NODE *first, NODE *last) {
+	uint64_t top = __atomic_load_n(&context->freeNodeTop, __ATOMIC_RELAXED);
+	uint64_t newTop;
+
+	do {
+		NODE *next = FREE_TOP_INDEX(top) != 0 ? nodeAtIndex(context, FREE_TOP_INDEX(top) - 1) : NULL;
+		__atomic_store_n(&last->next, linkOf(next), __ATOMIC_RELAXED);
+		newTop = FREE_TOP(FREE_TOP_TAG(top) + 1, indexOfNode(first) + 1);
+	} while (!__atomic_compare_exchange_n(&context->freeNodeTop, &top, newTop, 1,
+			__ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+#else
+/**
+ * Takes count nodes off the top of the context's free list, which must hold at least that many.
+ * Must be called with the context locked.
+ * Returns the first node of the chain; the last has a NULL next pointer.
+ */
+static NODE *takeFreeNodes(LIST_CONTEXT *context, int count) {
+	NODE *first = context->freeNodes;
+	NODE *last = first;
+	for (int i = 1; i < count; i++) {
+		last = nodeOf(context, last->next);
+	}
+
+	context->freeNodes = nodeOf(context, last->next);
+	context->numNodesAvailable -= count;
+	NOTE_PEAK(context->peakNodesInUse, NODES_IN_USE(context));
+	SET_NEXT(last, NULL);
+	return first;
+}
+
+/**
+ * Pushes a chain of count nodes, linked first to last through their next pointers,
+ * onto the context's free list without visiting the nodes in between.
+ * Must be called with the context locked.
+ */
+static void giveFreeNodes(LIST_CONTEXT *context, NODE *first, NODE *last, int count) {
+	SET_NEXT(last, context->freeNodes);
+	context->freeNodes = first;
+	context->numNodesAvailable += count;
+}
+#endif
+
+#ifdef USE_MAGAZINES
+/**
+ * Switches the calling thread's magazine to the context and fills it with up to
+ * MAGAZINE_BATCH nodes from the context's pool.
+ * Returns 0 if at least one node was taken, -1 if the pool is at its limit or could not grow.
+ */
+static int refillMagazine(LIST_CONTEXT *context) {
+	if (magazine.context != context) {
+		ListThreadFlush();
+		pthread_once(&magazineKeyOnce, createMagazineKey);
+		pthread_setspecific(magazineKey, &magazine);
+	}
+
+	LOCK_CONTEXT(context);
+	int numNodes = MAGAZINE_BATCH;
+	if (context->config.maxNodes > 0 && EPOCH_RECLAIM(context)
+			&& context->config.maxNodes - NODES_IN_USE(context) < numNodes) {
+		(void)RECLAIM_RETIRED(context);
+	}
+	if (context->config.maxNodes > 0 && context->config.maxNodes - NODES_IN_USE(context) < numNodes) {
+		numNodes = context->config.maxNodes - NODES_IN_USE(context);
+	}
+	if (context->numNodesAvailable < numNodes) {
+		(void)growNodePool(context);
+	}
+	/* A reclaim can make fewer nodes available than a full batch, so take only what is there */
+	if (context->numNodesAvailable < numNodes) {
+		numNodes = context->numNodesAvailable;
+	}
+
+	/* The magazine hands out from its end, so fill it backwards to keep the pool's order */
+	NODE *node = numNodes > 0 ? takeFreeNodes(context, numNodes) : NULL;
+	UNLOCK_CONTEXT(context);
+	for (int i = numNodes - 1; i >= 0; i--) {
+		magazine.nodeIndices[i] = indexOfNode(node);
+		node = nodeOf(context, node->next);
+	}
+
+	magazine.context = context;
+	magazine.numNodes = numNodes > 0 ? numNodes : 0;
+	return numNodes > 0 ? 0 : -1;
+}
+
+/**
+ * Returns the oldest nodes in the calling thread's magazine to its context's pool,
+ * keeping the most recently released (and most likely cached) ones.
+ */
+static void spillMagazine(int numNodes) {
+	LIST_CONTEXT *context = magazine.context;
+
+	if (numNodes == 0) {
+		return;
+	}
+
+	/* Chain the nodes so the most recently released one ends up on top of the pool */
+	NODE *first = nodeAtIndex(context, magazine.nodeIndices[numNodes - 1]);
+	NODE *last = first;
+	for (int i = numNodes - 2; i >= 0; i--) {
+		NODE *node = nodeAtIndex(context, magazine.nodeIndices[i]);
+		SET_NEXT(last, node);
+		last = node;
+	}
+	LOCK_CONTEXT(context);
+	giveFreeNodes(context, first, last, numNodes);
+	UNLOCK_CONTEXT(context);
+
+	magazine.numNodes -= numNodes;
+	memmove(magazine.nodeIndices, &magazine.nodeIndices[numNodes], magazine.numNodes * sizeof(int));
+}
+
+/**
+ * Creates the key used to flush a thread's magazine when it exits
+ */
+static void createMagazineKey(void) {
+	pthread_key_create(&magazineKey, flushMagazineOnExit);
+}
+
+/**
+ * Thread exit handler returning the exiting thread's cached nodes to their context
+ */
+static void flushMagazineOnExit(void *unused) {
+	(void)unused;
+	ListThreadFlush();
+}
+#endif
+
+#ifndef LIST_NO_STATS
+#ifdef LIST_THREAD_SAFE
+/**
+ * Adds the calling thread's statistics block to the ones ListGetStats reads.
+ * Returns the block.
+ */
+static STATS_BLOCK *registerThreadStats(void) {
+	pthread_once(&statsKeyOnce, createStatsKey);
+	pthread_setspecific(statsKey, &threadStats);
+
+	pthread_mutex_lock(&statsLock);
+	threadStats.next = statsBlocks;
+	statsBlocks = &threadStats;
+	threadStats.registered = 1;
+	pthread_mutex_unlock(&statsLock);
+	return &threadStats;
+}
+
+/**
+ * Creates the key used to retire a thread's statistics block when it exits
+ */
+static void createStatsKey(void) {
+	pthread_key_create(&statsKey, retireStatsOnExit);
+}
+
+/**
+ * Thread exit handler folding the exiting thread's counts into those of exited threads
+ * and taking its block out of the registered ones
+ */
+static void retireStatsOnExit(void *block) {
+	STATS_BLOCK *exiting = block;
+
+	pthread_mutex_lock(&statsLock);
+	for (STATS_BLOCK **link = &statsBlocks; *link != NULL; link = &(*link)->next) {
+		if (*link == exiting) {
+			*link = exiting->next;
+			break;
+		}
+	}
+	for (int op = 0; op < LIST_NUM_OPS; op++) {
+		exitedStats.calls[op] += exiting->calls[op];
+		exitedStats.nullArgFailures[op] += exiting->nullArgFailures[op];
+		exitedStats.poolFailures[op] += exiting->poolFailures[op];
+	}
+	exitedStats.searchNodesVisited += exiting->searchNodesVisited;
+	exitedStats.skipIndexRebuilds += exiting->skipIndexRebuilds;
+#ifdef LIST_LATENCY_HISTOGRAMS
+	for (int op = 0; op < LIST_NUM_OPS; op++) {
+		for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+			exitedStats.latency[op][bucket] += exiting->latency[op][bucket];
+		}
+	}
+#endif
+	memset(exiting, 0, sizeof(STATS_BLOCK));
+	pthread_mutex_unlock(&statsLock);
+}
+#endif
+
+/**
+ * Adds the counts in a thread's statistics block to stats
+ */
+static void addStats(LIST_STATS *stats, STATS_BLOCK *block) {
+	for (int op = 0; op < LIST_NUM_OPS; op++) {
+		stats->calls[op] += STATS_LOAD(block->calls[op]);
+		stats->nullArgFailures[op] += STATS_LOAD(block->nullArgFailures[op]);
+		stats->poolFailures[op] += STATS_LOAD(block->poolFailures[op]);
+	}
+	stats->searchNodesVisited += STATS_LOAD(block->searchNodesVisited);
+	stats->skipIndexRebuilds += STATS_LOAD(block->skipIndexRebuilds);
+}
+
+/**
+ * Raises a peak usage count to value if value is higher. Peaks the lock-free build
+ * updates outside the context lock are raised with a compare-and-swap.
+ */
+static void notePeak(int *peak, int value) {
+	int seen = __atomic_load_n(peak, __ATOMIC_RELAXED);
+	while (value > seen && !__atomic_compare_exchange_n(peak, &seen, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+	}
+}
+#endif
+
+#ifdef LIST_LATENCY_HISTOGRAMS
+/**
+ * Cleanup handler of a timed call: counts the time since it started in its latency bucket
+ */
+static void stopLatencyTimer(LATENCY_TIMER *timer) {
+	uint64_t now = LATENCY_TICKS();
+	uint64_t ticks = now > timer->start ? now - timer->start : 0;
+	STATS_ADD(THREAD_STATS->latency[timer->op][latencyBucket(ticks)], 1);
+}
+
+/**
+ * Returns the latency bucket for a number of ticks. Below 2^LATENCY_SUB_BITS each value has
+ * a bucket of its own; above, each power of 2 is split into 2^LATENCY_SUB_BITS buckets by
+ * the bits after the highest set bit.
+ */
+static inline int latencyBucket(uint64_t ticks) {
+	if (ticks < (1 << LATENCY_SUB_BITS)) {
+		return (int)ticks;
+	}
+	int highBit = 63 - __builtin_clzll(ticks);
+	int sub = (int)(ticks >> (highBit - LATENCY_SUB_BITS)) & ((1 << LATENCY_SUB_BITS) - 1);
+	return ((highBit - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) + sub;
+}
+
+/**
+ * Returns the highest number of ticks that falls in a latency bucket
+ */
+static uint64_t latencyBucketLimit(int bucket) {
+	if (bucket < (1 << LATENCY_SUB_BITS)) {
+		return bucket;
+	}
+	int highBit = (bucket >> LATENCY_SUB_BITS) + LATENCY_SUB_BITS - 1;
+	int sub = bucket & ((1 << LATENCY_SUB_BITS) - 1);
+	uint64_t width = (uint64_t)1 << (highBit - LATENCY_SUB_BITS);
+	return (((uint64_t)1 << LATENCY_SUB_BITS) + sub) * width + width - 1;
+}
+
+/**
+ * Sets counts to the latency histograms of every thread, less those set aside by ListResetLatency
+ */
+static void sumLatency(uint64_t (*counts)[LATENCY_BUCKETS]) {
+#ifdef LIST_THREAD_SAFE
+	pthread_mutex_lock(&statsLock);
+	for (int op = 0; op < LIST_NUM_OPS; op++) {
+		for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+			counts[op][bucket] = exitedStats.latency[op][bucket] - latencyBaseline[op][bucket];
+		}
+	}
+	for (STATS_BLOCK *block = statsBlocks; block != NULL; block = block->next) {
+		for (int op = 0; op < LIST_NUM_OPS; op++) {
+			for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+				counts[op][bucket] += STATS_LOAD(block->latency[op][bucket]);
+			}
+		}
+	}
+	pthread_mutex_unlock(&statsLock);
+#else
+	for (int op = 0; op < LIST_NUM_OPS; op++) {
+		for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+			counts[op][bucket] = threadStats.latency[op][bucket] - latencyBaseline[op][bucket];
+		}
+	}
+#endif
+}
+
+/**
+ * Returns the nanoseconds in one latency tick, measuring the TSC against the monotonic clock
+ * for LATENCY_CALIBRATION_NS where latency is timed with the TSC
+ */
+static double measureNsPerTick(void) {
+#if defined(__x86_64__) || defined(__i386__)
+	uint64_t startNs = monotonicNs();
+	uint64_t startTicks = LATENCY_TICKS();
+	uint64_t ns;
+	do {
+		ns = monotonicNs();
+	} while (ns - startNs < LATENCY_CALIBRATION_NS);
+	uint64_t ticks = LATENCY_TICKS() - startTicks;
+	return ticks > 0 ? (double)(ns - startNs) / ticks : 1.0;
+#else
+	return 1.0;
+#endif
+}
+
+/**
+ * Returns the monotonic clock in nanoseconds
+ */
+static uint64_t monotonicNs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+#endif
+
+/**
+ * Copies the list's items into nodes from another context and releases the originals.
+ * The list's current pointer follows its item into the new nodes.
+ * Returns 0 if successful, -1 if the other context could not supply enough nodes,
+ * in which case the list is unchanged.
+ */
+static int moveNodesToContext(LIST *list, LIST_CONTEXT *context) {
+	NODE *newHead = NULL;
+	NODE *newTail = NULL;
+	NODE *newCurrent = NULL;
+
+	for (NODE *node = list->head; node != NULL; node = NEXT(node)) {
+		NODE *newNode = allocNode(context, node->item);
+		if (newNode == NULL) {
+			while (newHead != NULL) {
+				NODE *oldNode = newHead;
+				newHead = nodeOf(context, newHead->next);
+				releaseNode(context, oldNode);
+			}
+			return -1;
+		}
+
+		SET_PREVIOUS(newNode, newTail);
+		if (newTail != NULL) {
+			SET_NEXT(newTail, newNode);
+		} else {
+			newHead = newNode;
+		}
+		newTail = newNode;
+		if (node == list->current) {
+			newCurrent = newNode;
+		}
+	}
+
+	if (list->head != NULL) {
+		releaseNodeRun(list->context, list->head, list->tail, list->size);
+	}
+
+	SET_HEAD(list, newHead);
+	SET_TAIL(list, newTail);
+	NOTE_EDIT(list);
+	list->current = newCurrent;
+	if (list->skipIndex != NULL) {
+		skipIndexInvalidate(list->skipIndex);
+	}
+	if (list->hashIndex != NULL) {
+		hashIndexInvalidate(list->hashIndex);
+	}
+	return 0;
+}
+
+/**
+ * Returns the node at the given index of the context's pool
+ */
+static inline NODE *nodeAtIndex(LIST_CONTEXT *context, int nodeIndex) {
+	return &context->nodeSlabs[nodeIndex / NODES_PER_SLAB]->nodes[nodeIndex % NODES_PER_SLAB];
+}
+
+/**
+ * Returns the pool index of a node, found through the slab it lives in
+ */
+static inline int indexOfNode(NODE *node) {
+	NODE_SLAB *slab = (NODE_SLAB *)((uintptr_t)node & ~((uintptr_t)NODE_SLAB_BYTES - 1));
+	return slab->baseIndex + (node - slab->nodes);
+}
+
+/**
+ * Returns the node a link refers to, or NULL for an empty link
+ */
+static inline NODE *nodeOf(LIST_CONTEXT *context, NODE_LINK link) {
+#ifdef LIST_COMPACT_NODES
+	return link != 0 ? nodeAtIndex(context, link - 1) : NULL;
+#else
+	(void)context;
+	return link;
+#endif
+}
+
+/**
+ * Returns the link that refers to a node, or the empty link for NULL
+ */
+static inline NODE_LINK linkOf(NODE *node) {
+#ifdef LIST_COMPACT_NODES
+	return node != NULL ? (NODE_LINK)indexOfNode(node) + 1 : 0;
+#else
+	return node;
+#endif
+}
+
+/**
+ * Returns the list head at the given index of the context's list pool
+ */
+static LIST *listAtIndex(LIST_CONTEXT *context, int listIndex) {
+	return &context->listSlabs[listIndex / LISTS_PER_SLAB]->lists[listIndex % LISTS_PER_SLAB];
+}
+
+/**
+ * Returns the pool index of a list head, found through the slab it lives in
+ */
+static int indexOfList(LIST *list) {
+	LIST_SLAB *slab = (LIST_SLAB *)((uintptr_t)list & ~((uintptr_t)LIST_SLAB_BYTES - 1));
+	return slab->baseIndex + (list - slab->lists);
+}
+
+/**
+ * Add node to empty list
+ */
+static void addNodeToEmptyList(LIST *list, NODE *node) {
+	list->current = node;
+	SET_HEAD(list, node);
+	SET_TAIL(list, node);
+	list->size++;
+	list->currentIsBeyond = 0;
+	nodesAdded(list, node, 1, 0);
+}
+
+/**
+ * Add node to list with only one item
+ */
+static void addNodeToListSizeOne(LIST *list, NODE *node, int afterHead) {
+	if (afterHead) {
+		SET_PREVIOUS(node, list->head);
+		SET_NEXT(node, NULL);
+	} else {
+		SET_PREVIOUS(node, NULL);
+		SET_NEXT(node, list->head);
+	}
+
+	list->current = node;
+	if (afterHead) {
+		SET_NEXT(list->head, node);
+		SET_TAIL(list, node);
+	} else {
+		SET_HEAD(list, node);
+		SET_TAIL(list, NEXT(list->head));
+		SET_PREVIOUS(list->tail, list->head);
+	}
+	list->currentIsBeyond = 0;
+	list->size++;
+	nodesAdded(list, node, 1, afterHead ? 1 : 0);
+}
+
+/**
+ * Add node between two index items of a non-empty list
+ */
+static void addNodeBetweenTwoOthers(LIST *list, NODE *node, NODE *pre, NODE *post, int position) {
+	SET_PREVIOUS(node, pre);
+	SET_NEXT(node, post);
+
+	SET_NEXT(pre, node);
+	SET_PREVIOUS(post, node);
+
+	list->current = node;
+	list->size++;
+	list->currentIsBeyond = 0;
+	nodesAdded(list, node, 1, position);
+}
+
+/**
+ * Add node to the end of a non-empty list
+ */
+static void appendNode(LIST *list, NODE *node) {
+	SET_PREVIOUS(node, list->tail);
+	SET_NEXT(node, NULL);
+
+	SET_NEXT(list->tail, node);
+	SET_TAIL(list, node);
+	list->current = list->tail;
+	list->size++;
+	list->currentIsBeyond = 0;
+	nodesAdded(list, node, 1, list->size - 1);
+}
+
+/**
+ * Add node to the front of a non-empty list
+ */
+static void prependNode(LIST *list, NODE *node) {
+	SET_PREVIOUS(node, NULL);
+	SET_NEXT(node, list->head);
+
+	SET_PREVIOUS(list->head, node);
+	SET_HEAD(list, node);
+	list->current = list->head;
+	list->size++;
+	list->currentIsBeyond = 0;
+	nodesAdded(list, node, 1, 0);
+}
+
+/**
+ * Links a chain of count nodes into the list between pre and post, which are adjacent.
+ * A NULL pre means the start of the list and a NULL post means the end.
+ * Otherwise pre must be the current node.
+ * The last node of the chain becomes the current one.
+ */
+static void spliceNodes(LIST *list, NODE *pre, NODE *post, NODE *first, NODE *last, int count) {
+	int position = pre == NULL ? 0 : (post == NULL ? list->size : POSITION_AFTER(list->currentIndex, 1));
+
+	SET_PREVIOUS(first, pre);
+	SET_NEXT(last, post);
+	if (pre != NULL) {
+		SET_NEXT(pre, first);
+	} else {
+		SET_HEAD(list, first);
+	}
+	if (post != NULL) {
+		SET_PREVIOUS(post, last);
+	} else {
+		SET_TAIL(list, last);
+	}
+
+	list->current = last;
+	list->currentIsBeyond = 0;
+	list->size += count;
+	nodesAdded(list, first, count, position);
+}
+
+/**
+ * Checks an array of items passed to a bulk operation.
+ * Returns 0 if the array holds count non-NULL items, -1 if not.
+ */
+static int checkItems(void **items, int count) {
+	if (count < 0 || (items == NULL && count > 0)) {
+		return -1;
+	}
+	for (int i = 0; i < count; i++) {
+		if (items[i] == NULL) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Relinks a list through the given nodes in array order, the list's items going into them
+ * in the order of the items array, and makes the node at currentPosition the current one,
+ * or none if it is -1. The indexes hold on to the old nodes, so they are dropped.
+ */
+static void layOutNodes(LIST *list, NODE **nodes, void **items, int currentPosition) {
+	NODE *previous = NULL;
+	for (int i = 0; i < list->size; i++) {
+		nodes[i]->item = items[i];
+		SET_PREVIOUS(nodes[i], previous);
+		if (previous != NULL) {
+			SET_NEXT(previous, nodes[i]);
+		}
+		previous = nodes[i];
+	}
+	if (previous != NULL) {
+		SET_NEXT(previous, NULL);
+	}
+	SET_HEAD(list, list->size > 0 ? nodes[0] : NULL);
+	SET_TAIL(list, previous);
+	NOTE_EDIT(list);
+	list->current = currentPosition >= 0 ? nodes[currentPosition] : NULL;
+
+	if (list->skipIndex != NULL) {
+		skipIndexInvalidate(list->skipIndex);
+	}
+	if (list->hashIndex != NULL) {
+		hashIndexInvalidate(list->hashIndex);
+	}
+}
+
+/**
+ * qsort comparator putting node pointers in address order
+ */
+static int compareNodeAddresses(const void *a, const void *b) {
+	uintptr_t nodeA = (uintptr_t)*(NODE *const *)a;
+	uintptr_t nodeB = (uintptr_t)*(NODE *const *)b;
+	return (nodeA > nodeB) - (nodeA < nodeB);
+}
+
+/**
+ * Records that a run of count nodes was linked in from the given position and the last
+ * of them made current, keeping the indices in step.
+ */
+static void nodesAdded(LIST *list, NODE *first, int count, int position) {
+	NODE *pre = PREVIOUS(first);
+	NODE *post = first;
+	for (int i = 0; i < count; i++) {
+		if (list->skipIndex != NULL && list->skipIndex->valid && (position == POSITION_UNKNOWN
+				|| skipIndexInsert(list->skipIndex, post, position + i) != 0)) {
+			skipIndexInvalidate(list->skipIndex);
+		}
+		post = NEXT(post);
+	}
+
+	list->currentIndex = POSITION_AFTER(position, count - 1);
+	NOTE_EDIT(list);
+	if (list->hashIndex != NULL && list->hashIndex->valid
+			&& hashIndexAdd(list, first, count, pre, post) != 0) {
+		hashIndexInvalidate(list->hashIndex);
+	}
+}
+
+/**
+ * Searches a non-empty list from its current item as ListSearch does, without counting a call
+ */
+static void *searchList(LIST *list, int (*comparator)(void *, void *), void *comparisonArg) {
+	NODE *searchNode = (list->current == NULL && list->currentIsBeyond == -1) ? 
+		list->head : list->current;
+	int searchIndex = searchNode == list->head ? 0 : list->currentIndex;
+	long numVisited = 0;
+	while (searchNode != NULL) {
+		numVisited++;
+		if ((* comparator)(searchNode->item, comparisonArg) == 1) {
+			list->current = searchNode;
+			list->currentIsBeyond = 0;
+			list->currentIndex = searchIndex;
+			COUNT_VISITS(numVisited);
+			return list->current->item;
+		}
+		searchNode = NEXT(searchNode);
+		searchIndex = POSITION_AFTER(searchIndex, 1);
+	}
+
+	COUNT_VISITS(numVisited);
+	list->current = NULL;
+	list->currentIsBeyond = 1;
+	list->currentIndex = list->size;
+	return NULL;
+}
+
+/**
+ * Takes the tail node out of a non-empty list, makes the new tail the current item
+ * and returns the removed item.
+ */
+static void *removeTail(LIST *list) {
+	void *item = list->tail->item;
+	NODE *removedNode = list->tail;
+
+	if (list->size > 1) {
+		SET_TAIL(list, PREVIOUS(list->tail));
+		SET_NEXT(list->tail, NULL);
+		list->current = list->tail;
+	} else {
+		SET_TAIL(list, NULL);
+		SET_HEAD(list, NULL);
+		list->current = NULL;
+	}
+	list->size--;
+	list->currentIsBeyond = 0;
+	list->currentIndex = list->size > 0 ? list->size - 1 : 0;
+	nodeRemoved(list, removedNode, list->size);
+	if (list->log != NULL) {
+		logRecord(list, LOG_TRIM, 0, NULL);
+	}
+
+	releaseNode(list->context, removedNode);
+	return item;
+}
+
+/**
+ * Records that the node at the given position was unlinked, keeping the indices in step.
+ * The node must still hold its item.
+ */
+static void nodeRemoved(LIST *list, NODE *node, int position) {
+	NOTE_EDIT(list);
+	if (list->hashIndex != NULL && list->hashIndex->valid) {
+		hashIndexRemove(list, node);
+	}
+	if (list->skipIndex != NULL && list->skipIndex->valid) {
+		if (position == POSITION_UNKNOWN) {
+			skipIndexInvalidate(list->skipIndex);
+		} else {
+			skipIndexRemove(list->skipIndex, position);
+		}
+	}
+}
+
+/**
+ * Gives a node that has just been added at the given position a tower, if the
+ * random height calls for one, and widens the links that now span one more position.
+ * Returns 0 if successful, -1 if a tower could not be allocated.
+ */
+static int skipIndexInsert(SKIP_INDEX *index, NODE *node, int position) {
+	int height = skipIndexRandomHeight(index);
+	SKIP_TOWER *tower = NULL;
+	if (height > 0) {
+		tower = malloc(sizeof(SKIP_TOWER) + height * sizeof(struct SKIP_LINK));
+		if (tower == NULL) {
+			return -1;
+		}
+		tower->node = node;
+		tower->height = height;
+		if (height > index->height) {
+			index->height = height;
+		}
+	}
+
+	SKIP_TOWER *x = index->head;
+	int xPosition = -1;
+	for (int level = index->height - 1; level >= 0; level--) {
+		struct SKIP_LINK *link = &x->links[level];
+		while (link->next != NULL && xPosition + link->width < position) {
+			xPosition += link->width;
+			x = link->next;
+			link = &x->links[level];
+		}
+
+		if (level < height) {
+			tower->links[level].next = link->next;
+			tower->links[level].width = xPosition + link->width + 1 - position;
+			link->next = tower;
+			link->width = position - xPosition;
+		} else if (link->next != NULL) {
+			link->width++;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Removes the tower at the given position, if there is one, after its node has been
+ * unlinked, and narrows the links that now span one less position.
+ */
+static void skipIndexRemove(SKIP_INDEX *index, int position) {
+	SKIP_TOWER *removed = NULL;
+	SKIP_TOWER *x = index->head;
+	int xPosition = -1;
+
+	for (int level = index->height - 1; level >= 0; level--) {
+		struct SKIP_LINK *link = &x->links[level];
+		while (link->next != NULL && xPosition + link->width < position) {
+			xPosition += link->width;
+			x = link->next;
+			link = &x->links[level];
+		}
+
+		if (link->next != NULL && xPosition + link->width == position) {
+			removed = link->next;
+			link->width += removed->links[level].width - 1;
+			link->next = removed->links[level].next;
+		} else if (link->next != NULL) {
+			link->width--;
+		}
+	}
+	free(removed);
+}
+
+/**
+ * Returns the node at the given position, which must be in range,
+ * using the list's skip index to get within a few nodes of it.
+ */
+static NODE *skipIndexFind(LIST *list, int position) {
+	SKIP_INDEX *index = list->skipIndex;
+	SKIP_TOWER *x = index->head;
+	int xPosition = -1;
+
+	for (int level = index->height - 1; level >= 0; level--) {
+		while (x->links[level].next != NULL && xPosition + x->links[level].width <= position) {
+			xPosition += x->links[level].width;
+			x = x->links[level].next;
+		}
+	}
+
+	NODE *node = x->node;
+	if (node == NULL) {
+		node = list->head;
+		xPosition = 0;
+	}
+	for (; xPosition < position; xPosition++) {
+		node = NEXT(node);
+	}
+	return node;
+}
+
+/**
+ * Builds the list's skip index from scratch in one pass over the list.
+ * Returns 0 if successful, -1 if a tower could not be allocated, in which case
+ * the index is left invalid.
+ */
+static int skipIndexRebuild(LIST *list) {
+	SKIP_INDEX *index = list->skipIndex;
+	SKIP_TOWER *last[SKIP_MAX_LEVELS];
+	int lastPosition[SKIP_MAX_LEVELS];
+
+	skipIndexInvalidate(index);
+	for (int level = 0; level < SKIP_MAX_LEVELS; level++) {
+		last[level] = index->head;
+		lastPosition[level] = -1;
+	}
+
+	int position = 0;
+	for (NODE *node = list->head; node != NULL; node = NEXT(node), position++) {
+		int height = skipIndexRandomHeight(index);
+		if (height == 0) {
+			continue;
+		}
+
+		SKIP_TOWER *tower = malloc(sizeof(SKIP_TOWER) + height * sizeof(struct SKIP_LINK));
+		if (tower == NULL) {
+			skipIndexInvalidate(index);
+			return -1;
+		}
+		tower->node = node;
+		tower->height = height;
+		for (int level = 0; level < height; level++) {
+			tower->links[level].next = NULL;
+			last[level]->links[level].next = tower;
+			last[level]->links[level].width = position - lastPosition[level];
+			last[level] = tower;
+			lastPosition[level] = position;
+		}
+		if (height > index->height) {
+			index->height = height;
+		}
+	}
+
+	index->valid = 1;
+	return 0;
+}
+
+/**
+ * Frees every tower of the index and marks it to be rebuilt before its next use.
+ */
+static void skipIndexInvalidate(SKIP_INDEX *index) {
+	SKIP_TOWER *tower = index->head->links[0].next;
+	while (tower != NULL) {
+		SKIP_TOWER *next = tower->links[0].next;
+		free(tower);
+		tower = next;
+	}
+
+	for (int level = 0; level < SKIP_MAX_LEVELS; level++) {
+		index->head->links[level].next = NULL;
+	}
+	index->height = 0;
+	index->valid = 0;
+}
+
+/**
+ * Carries the skip indices over a concatenation, before the lists are linked together.
+ * If both lists have valid indices, list2's towers are joined onto the end of list1's.
+ * Otherwise list1's index is left to be rebuilt. List2 is left without an index.
+ */
+static void skipIndexConcat(LIST *list1, LIST *list2) {
+	SKIP_INDEX *index1 = list1->skipIndex;
+	SKIP_INDEX *index2 = list2->skipIndex;
+
+	if (index1 != NULL && index1->valid && index2 != NULL && index2->valid) {
+		SKIP_TOWER *x = index1->head;
+		int xPosition = -1;
+		int height = index1->height > index2->height ? index1->height : index2->height;
+
+		for (int level = height - 1; level >= 0; level--) {
+			while (level < index1->height && x->links[level].next != NULL) {
+				xPosition += x->links[level].width;
+				x = x->links[level].next;
+			}
+
+			/* x is now the last tower of list1 at this level */
+			struct SKIP_LINK *link2 = &index2->head->links[level];
+			x->links[level].next = link2->next;
+			if (link2->next != NULL) {
+				x->links[level].width = list1->size + link2->width - 1 - xPosition;
+			}
+			link2->next = NULL;
+		}
+		index1->height = height;
+	} else if (index1 != NULL && list2->size > 0) {
+		skipIndexInvalidate(index1);
+	}
+
+	ListDisableSkipIndex(list2);
+}
+
+/**
+ * Returns the number of levels for a new tower, 0 for none, so that each level holds
+ * 1 in 2^SKIP_BRANCHING_BITS of the towers below it.
+ */
+static int skipIndexRandomHeight(SKIP_INDEX *index) {
+	/* xorshift32 */
+	uint32_t random = index->randomState;
+	random ^= random << 13;
+	random ^= random >> 17;
+	random ^= random << 5;
+	index->randomState = random;
+
+	int height = 0;
+	while (height < SKIP_MAX_LEVELS && (random & ((1u << SKIP_BRANCHING_BITS) - 1)) == 0) {
+		height++;
+		random >>= SKIP_BRANCHING_BITS;
+	}
+	return height;
+}
+
+/**
+ * Adds entries for a run of count nodes linked in between pre and post, labelling them
+ * evenly within the gap between their neighbours' labels. A NULL pre or post means the
+ * start or end of the list. If the gap is too small, the whole list is relabelled.
+ * Returns 0 if successful, -1 if the entries could not be allocated.
+ */
+static int hashIndexAdd(LIST *list, NODE *first, int count, NODE *pre, NODE *post) {
+	HASH_INDEX *index = list->hashIndex;
+	if (count == 0) {
+		return 0;
+	}
+	if (hashIndexReserve(index, count) != 0) {
+		return -1;
+	}
+
+	uint64_t span = (uint64_t)(count + 1) * HASH_LABEL_STEP;
+	uint64_t lower;
+	uint64_t upper;
+	if (pre != NULL) {
+		lower = index->entries[hashIndexEntryOf(index, pre, (* index->hash)((* index->keyOf)(pre->item)))].label;
+	}
+	if (post != NULL) {
+		upper = index->entries[hashIndexEntryOf(index, post, (* index->hash)((* index->keyOf)(post->item)))].label;
+	}
+	if (pre == NULL && post == NULL) {
+		lower = HASH_LABEL_MIDDLE - span / 2;
+		upper = lower + span;
+	} else if (pre == NULL) {
+		lower = upper > span ? upper - span : 0;
+	} else if (post == NULL) {
+		upper = UINT64_MAX - lower > span ? lower + span : UINT64_MAX;
+	}
+	uint64_t gap = (upper - lower) / (uint64_t)(count + 1);
+
+	NODE *node = first;
+	for (int i = 0; i < count; i++, node = NEXT(node)) {
+		int e = index->freeEntry;
+		HASH_ENTRY *entry = &index->entries[e];
+		index->freeEntry = entry->next;
+
+		entry->node = node;
+		entry->label = lower + gap * (uint64_t)(i + 1);
+		entry->hash = (* index->hash)((* index->keyOf)(node->item));
+		int *bucket = &index->buckets[entry->hash & (index->numBuckets - 1)];
+		entry->next = *bucket;
+		*bucket = e;
+	}
+	index->numEntries += count;
+
+	if (gap == 0) {
+		hashIndexRelabel(list);
+	}
+	return 0;
+}
+
+/**
+ * Removes the entry for a node, which must still hold its item.
+ */
+static void hashIndexRemove(LIST *list, NODE *node) {
+	HASH_INDEX *index = list->hashIndex;
+	unsigned long hash = (* index->hash)((* index->keyOf)(node->item));
+
+	int *link = &index->buckets[hash & (index->numBuckets - 1)];
+	while (*link != -1 && index->entries[*link].node != node) {
+		link = &index->entries[*link].next;
+	}
+	if (*link == -1) {
+		return;
+	}
+
+	int e = *link;
+	*link = index->entries[e].next;
+	index->entries[e].node = NULL;
+	index->entries[e].next = index->freeEntry;
+	index->freeEntry = e;
+	index->numEntries--;
+}
+
+/**
+ * Returns the position of a node's entry in the entries array, or -1 if it has none.
+ * Hash must be the hash of the node's key.
+ */
+static int hashIndexEntryOf(HASH_INDEX *index, NODE *node, unsigned long hash) {
+	int e = index->buckets[hash & (index->numBuckets - 1)];
+	while (e != -1 && index->entries[e].node != node) {
+		e = index->entries[e].next;
+	}
+	return e;
+}
+
+/**
+ * Makes room for count more entries, doubling the entries array and the bucket array
+ * as needed so there are never more entries than buckets.
+ * Returns 0 if successful, -1 if failed, in which case the index is unchanged.
+ */
+static int hashIndexReserve(HASH_INDEX *index, int count) {
+	int needed = index->numEntries + count;
+
+	if (needed > index->entryCapacity) {
+		int capacity = index->entryCapacity > 0 ? index->entryCapacity : HASH_MIN_BUCKETS;
+		while (capacity < needed) {
+			capacity *= 2;
+		}
+		HASH_ENTRY *entries = realloc(index->entries, capacity * sizeof(HASH_ENTRY));
+		if (entries == NULL) {
+			return -1;
+		}
+		for (int e = capacity - 1; e >= index->entryCapacity; e--) {
+			entries[e].node = NULL;
+			entries[e].next = index->freeEntry;
+			index->freeEntry = e;
+		}
+		index->entries = entries;
+		index->entryCapacity = capacity;
+	}
+
+	if (needed > index->numBuckets) {
+		int numBuckets = index->numBuckets > 0 ? index->numBuckets : HASH_MIN_BUCKETS;
+		while (numBuckets < needed) {
+			numBuckets *= 2;
+		}
+		int *buckets = malloc(numBuckets * sizeof(int));
+		if (buckets == NULL) {
+			return -1;
+		}
+		for (int b = 0; b < numBuckets; b++) {
+			buckets[b] = -1;
+		}
+
+		/* Rehash the entries in use, found by their non-NULL nodes */
+		for (int e = 0; e < index->entryCapacity; e++) {
+			HASH_ENTRY *entry = &index->entries[e];
+			if (entry->node != NULL) {
+				int *bucket = &buckets[entry->hash & (numBuckets - 1)];
+				entry->next = *bucket;
+				*bucket = e;
+			}
+		}
+		free(index->buckets);
+		index->buckets = buckets;
+		index->numBuckets = numBuckets;
+	}
+	return 0;
+}
+
+/**
+ * Gives every entry a new label, spaced HASH_LABEL_STEP apart in list order around the
+ * middle of the label range.
+ */
+static void hashIndexRelabel(LIST *list) {
+	HASH_INDEX *index = list->hashIndex;
+	uint64_t label = HASH_LABEL_MIDDLE - (uint64_t)(list->size / 2) * HASH_LABEL_STEP;
+
+	for (NODE *node = list->head; node != NULL; node = NEXT(node)) {
+		unsigned long hash = (* index->hash)((* index->keyOf)(node->item));
+		index->entries[hashIndexEntryOf(index, node, hash)].label = label;
+		label += HASH_LABEL_STEP;
+	}
+}
+
+/**
+ * Builds the list's hash index from scratch in one pass over the list.
+ * Returns 0 if successful, -1 if failed, in which case the index is left invalid.
+ */
+static int hashIndexRebuild(LIST *list) {
+	HASH_INDEX *index = list->hashIndex;
+
+	hashIndexInvalidate(index);
+	if (hashIndexReserve(index, HASH_MIN_BUCKETS) != 0
+			|| hashIndexAdd(list, list->head, list->size, NULL, NULL) != 0) {
+		hashIndexInvalidate(index);
+		return -1;
+	}
+	index->valid = 1;
+	return 0;
+}
+
+/**
+ * Frees every entry of the index and marks it to be rebuilt before its next use.
+ */
+static void hashIndexInvalidate(HASH_INDEX *index) {
+	free(index->entries);
+	free(index->buckets);
+	index->entries = NULL;
+	index->buckets = NULL;
+	index->numBuckets = 0;
+	index->numEntries = 0;
+	index->entryCapacity = 0;
+	index->freeEntry = -1;
+	index->valid = 0;
+}
+
+/**
+ * Sorts a chunk's run with a bottom-up merge sort. Pending runs are kept like the bits
+ * of a binary counter, runs[k] holding 2^k nodes, so no more than SORT_MAX_RUNS are
+ * ever waiting and nothing is allocated.
+ * Takes a SORT_CHUNK so it can be run on a thread, and returns NULL.
+ */
+static void *sortChunkWorker(void *arg) {
+	SORT_CHUNK *chunk = arg;
+	LIST *list = chunk->list;
+	NODE *runs[SORT_MAX_RUNS] = { NULL };
+	int numRuns = 0;
+
+	NODE *node = chunk->run;
+	while (node != NULL) {
+		NODE *next = NEXT(node);
+		SET_NEXT(node, NULL);
+
+		/* Pending runs hold earlier items than the carry, so they go first */
+		NODE *carry = node;
+		int k = 0;
+		for (; k < numRuns && runs[k] != NULL; k++) {
+			carry = mergeRuns(list, runs[k], carry, chunk->comparator);
+			runs[k] = NULL;
+		}
+		runs[k] = carry;
+		if (k == numRuns) {
+			numRuns++;
+		}
+		node = next;
+	}
+
+	NODE *sorted = NULL;
+	for (int k = 0; k < numRuns; k++) {
+		if (runs[k] != NULL) {
+			sorted = mergeRuns(list, runs[k], sorted, chunk->comparator);
+		}
+	}
+	chunk->run = sorted;
+	return NULL;
+}
+
+/**
+ * Merges two sorted runs linked by next only, taking from a first on ties.
+ * Returns the first node of the merged run.
+ */
+static NODE *mergeRuns(LIST *list, NODE *a, NODE *b, int (*comparator)(void *, void *)) {
+	(void)list; // Only needed to follow compact links
+	if (a == NULL) {
+		return b;
+	}
+	if (b == NULL) {
+		return a;
+	}
+
+	NODE *head;
+	if ((* comparator)(a->item, b->item) <= 0) {
+		head = a;
+		a = NEXT(a);
+	} else {
+		head = b;
+		b = NEXT(b);
+	}
+
+	NODE *tail = head;
+	while (a != NULL && b != NULL) {
+		if ((* comparator)(a->item, b->item) <= 0) {
+			SET_NEXT(tail, a);
+			tail = a;
+			a = NEXT(a);
+		} else {
+			SET_NEXT(tail, b);
+			tail = b;
+			b = NEXT(b);
+		}
+	}
+	SET_NEXT(tail, a != NULL ? a : b);
+	return head;
+}
+
+/**
+ * Makes the cursor's position the list's current one, so a list operation can be run
+ * at the cursor, saving the list's own position. The cursor's index is used if nothing
+ * has changed the list since it was known; otherwise it is counted only when a skip
+ * index or log needs it, so that they can be kept up to date instead of rebuilt.
+ */
+static void cursorEnter(LIST_CURSOR *cursor, LIST_CURSOR *saved) {
+	LIST *list = cursor->list;
+
+	saved->list = list;
+	saved->current = list->current;
+	saved->currentIsBeyond = list->currentIsBeyond;
+	saved->currentIndex = list->currentIndex;
+
+	list->current = cursor->currentIsBeyond == 0 ? cursor->current : NULL;
+	list->currentIsBeyond = cursor->currentIsBeyond;
+	if (CURRENT_NODE_BEYOND_START) {
+		list->currentIndex = -1;
+	} else if (CURRENT_NODE_BEYOND_END) {
+		list->currentIndex = list->size;
+	} else if (cursor->edits == list->edits && cursor->currentIndex != POSITION_UNKNOWN) {
+		list->currentIndex = cursor->currentIndex;
+	} else {
+		list->currentIndex = POSITION_UNKNOWN;
+		if ((list->skipIndex != NULL && list->skipIndex->valid) || list->log != NULL) {
+			(void)ListIndexOfCurrent(list);
+		}
+	}
+}
+
+/**
+ * Moves the cursor to where the list operation left the current pointer and puts back
+ * the list's own position. Change is 1 if the operation added a node at the given position,
+ * -1 if it removed the one there and 0 if it did neither; the list's index moves with it.
+ * If the list's current node was the one removed, the list keeps the position the operation
+ * gave it instead. The position of an empty list (which is no position at all) becomes
+ * beyond the start.
+ */
+static void cursorLeave(LIST_CURSOR *cursor, LIST_CURSOR *saved, int change, int position, NODE *removedNode) {
+	LIST *list = cursor->list;
+
+	cursor->current = list->current;
+	cursor->currentIsBeyond = list->current == NULL && list->currentIsBeyond == 0 ? -1 : list->currentIsBeyond;
+	cursor->currentIndex = cursor->currentIsBeyond == -1 ? -1 : list->currentIndex;
+	cursor->edits = list->edits;
+	if (removedNode != NULL && saved->current == removedNode) {
+		return;
+	}
+
+	if (saved->current == NULL && saved->currentIsBeyond == 0) {
+		list->current = NULL;
+		list->currentIsBeyond = -1;
+	} else {
+		list->current = saved->current;
+		list->currentIsBeyond = saved->currentIsBeyond;
+	}
+	if (CURRENT_NODE_BEYOND_START) {
+		list->currentIndex = -1;
+	} else if (CURRENT_NODE_BEYOND_END) {
+		list->currentIndex = list->size;
+	} else if (change == 0 || saved->currentIndex == POSITION_UNKNOWN) {
+		list->currentIndex = saved->currentIndex;
+	} else if (position == POSITION_UNKNOWN) {
+		list->currentIndex = POSITION_UNKNOWN;
+	} else if (change > 0) {
+		list->currentIndex = saved->currentIndex + (position <= saved->currentIndex ? 1 : 0);
+	} else {
+		list->currentIndex = saved->currentIndex - (position < saved->currentIndex ? 1 : 0);
+	}
+}
+
+#ifdef LIST_THREAD_SAFE
+/**
+ * Holds a released chain of nodes back until no reader can still be on them.
+ * The chain is tagged with the epoch it was released in, and then the epoch is moved on
+ * if the readers allow it.
+ */
+static void retireNodes(LIST_CONTEXT *context, NODE *first, NODE *last, int count) {
+	LOCK_CONTEXT(context);
+	EPOCH_LIMBO *limbo = &context->limbo[context->epoch & 1];
+	if (limbo->numRuns == limbo->capacity) {
+		int newCapacity = limbo->capacity > 0 ? limbo->capacity * 2 : EPOCH_MIN_RUNS;
+		EPOCH_RUN *newRuns = realloc(limbo->runs, newCapacity * sizeof(EPOCH_RUN));
+		if (newRuns == NULL) {
+			/* The nodes stay out of the pool until the context is destroyed */
+			UNLOCK_CONTEXT(context);
+			return;
+		}
+		limbo->runs = newRuns;
+		limbo->capacity = newCapacity;
+	}
+
+	limbo->runs[limbo->numRuns].first = first;
+	limbo->runs[limbo->numRuns].last = last;
+	limbo->runs[limbo->numRuns].count = count;
+	limbo->numRuns++;
+	advanceEpoch(context);
+	UNLOCK_CONTEXT(context);
+}
+
+/**
+ * Moves the context on from epoch e to e + 1 if no reader from epoch e - 1 remains.
+ * The nodes released during epoch e - 1 were unlinked before any reader from e or later
+ * started, so they go back to the pool, and their limbo is reused for epoch e + 1.
+ * Must be called with the context locked.
+ * Returns the number of nodes returned to the pool.
+ */
+static int advanceEpoch(LIST_CONTEXT *context) {
+	unsigned epoch = context->epoch;
+	if (__atomic_load_n(&context->numReaders[(epoch + 1) & 1], __ATOMIC_SEQ_CST) != 0) {
+		return 0;
+	}
+
+	EPOCH_LIMBO *limbo = &context->limbo[(epoch + 1) & 1];
+	int numNodes = 0;
+	for (int i = 0; i < limbo->numRuns; i++) {
+		EPOCH_RUN *run = &limbo->runs[i];
+#ifdef LIST_LOCK_FREE
+		pushFreeNodes(context, run->first, run->last);
+		if (COUNTS_NODES(context)) {
+			__atomic_fetch_sub(&context->numNodesInUse, run->count, __ATOMIC_RELAXED);
+		}
+#else
+		giveFreeNodes(context, run->first, run->last, run->count);
+#endif
+		numNodes += run->count;
+	}
+	limbo->numRuns = 0;
+
+	__atomic_store_n(&context->epoch, epoch + 1, __ATOMIC_SEQ_CST);
+	return numNodes;
+}
+
+#ifdef LIST_LOCK_FREE
+/**
+ * Returns retired nodes to the pool if their readers have left, for an allocation
+ * that found the context at its node limit.
+ * Returns the number of nodes returned.
+ */
+static int reclaimRetired(LIST_CONTEXT *context) {
+	LOCK_CONTEXT(context);
+	int numNodes = RECLAIM_RETIRED(context);
+	UNLOCK_CONTEXT(context);
+	return numNodes;
+}
+#endif
+#endif
+
+/**
+ * Allocates a slab for the context's node pool, aligned to NODE_SLAB_BYTES.
+ * A file-backed pool grows its file by a slab and maps the new one.
+ * Returns NULL if failed.
+ */
+static NODE_SLAB *allocNodeSlab(LIST_CONTEXT *context) {
+#ifdef USE_FILE_POOLS
+	if (context->header != NULL) {
+		off_t offset = (off_t)(context->numNodeSlabs + 1) * NODE_SLAB_BYTES;
+		if (ftruncate(context->fd, offset + NODE_SLAB_BYTES) != 0) {
+			return NULL;
+		}
+		return mapPoolSlab(context->fd, offset);
+	}
+#else
+	(void)context;
+#endif
+	return aligned_alloc(NODE_SLAB_BYTES, NODE_SLAB_BYTES);
+}
+
+/**
+ * Writes every byte described by the iovecs, carrying on after partial writes and interruptions.
+ * The iovecs are used up in the process.
+ * Returns 0 if successful, -1 if failed.
+ */
+static int writeFully(int fd, struct iovec *iov, int count) {
+	while (count > 0) {
+		ssize_t written = writev(fd, iov, count);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		while (count > 0 && (size_t)written >= iov->iov_len) {
+			written -= iov->iov_len;
+			iov++;
+			count--;
+		}
+		if (count > 0) {
+			iov->iov_base = (char *)iov->iov_base + written;
+			iov->iov_len -= written;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Reads exactly length bytes, carrying on after short reads and interruptions.
+ * Returns 0 if successful, -1 if failed or the data ended first.
+ */
+static int readFully(int fd, void *buffer, size_t length) {
+	char *next = buffer;
+	while (length > 0) {
+		ssize_t numRead = read(fd, next, length);
+		if (numRead < 0 && errno == EINTR) {
+			continue;
+		}
+		if (numRead <= 0) {
+			return -1;
+		}
+		next += numRead;
+		length -= numRead;
+	}
+	return 0;
+}
+
+/**
+ * Checks a serialized list's header, and that its records fit in the bytes available after it.
+ * Returns 0 if it can be loaded, -1 if not.
+ */
+static int checkSerialHeader(const SERIAL_HEADER *header, uint64_t available) {
+	if (memcmp(header->magic, SERIAL_MAGIC, sizeof(header->magic)) != 0 || header->version != SERIAL_VERSION) {
+		return -1;
+	}
+	if (header->count > INT32_MAX || header->payloadBytes > available || header->payloadBytes > SIZE_MAX) {
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Decodes each record in turn and appends the items to the list a batch at a time.
+ * Returns 0 if successful, -1 if a record ran past the end or could not be decoded, or nodes ran out.
+ * Items not yet appended when it fails are passed to codec->itemFree.
+ */
+static int loadRecords(LIST *list, const unsigned char *records, const SERIAL_HEADER *header, const LIST_CODEC *codec) {
+	const unsigned char *end = records + header->payloadBytes;
+	void *items[SERIAL_LOAD_BATCH];
+	int numItems = 0;
+
+	int result = 0;
+	for (uint64_t i = 0; i < header->count && result == 0; i++) {
+		uint64_t length;
+		void *item = NULL;
+		if ((size_t)(end - records) >= sizeof(uint64_t)) {
+			memcpy(&length, records, sizeof(uint64_t));
+			records += sizeof(uint64_t);
+			if (length <= (size_t)(end - records)) {
+				item = (* codec->decode)(records, length, codec->arg);
+				records += length;
+				records += SERIAL_PADDING(length) <= (size_t)(end - records) ? SERIAL_PADDING(length) : 0;
+			}
+		}
+
+		if (item == NULL) {
+			result = -1;
+		} else {
+			items[numItems++] = item;
+			if (numItems == SERIAL_LOAD_BATCH || i + 1 == header->count) {
+				result = ListAppendN(list, items, numItems);
+				numItems = result == 0 ? 0 : numItems;
+			}
+		}
+	}
+
+	for (int i = 0; result != 0 && codec->itemFree != NULL && i < numItems; i++) {
+		(* codec->itemFree)(items[i]);
+	}
+	return result;
+}
+
+/**
+ * Records a change to a logged list, committing the group if it is full.
+ * A dirty list, or one whose record cannot be buffered, is written out whole instead.
+ */
+static void logRecord(LIST *list, uint32_t type, uint64_t arg, void *item) {
+	LIST_LOG *log = list->log;
+	int id = list->logId;
+
+	LOCK_LOG(log);
+	if (log->dirty[id] || bufferRecord(log, type, id, arg, item) != 0) {
+		log->dirty[id] = bufferSnapshot(log, id) != 0;
+	}
+	commitFullGroup(log);
+	UNLOCK_LOG(log);
+}
+
+/**
+ * Writes out a logged list whole after a change its log has no record for.
+ * This is done by the thread changing the list, as it is the one that can read the list safely.
+ */
+static void logTouched(LIST *list) {
+	LIST_LOG *log = list->log;
+
+	LOCK_LOG(log);
+	log->dirty[list->logId] = bufferSnapshot(log, list->logId) != 0;
+	commitFullGroup(log);
+	UNLOCK_LOG(log);
+}
+
+/**
+ * Records list2 having been added to the end of list1, where either may be logged.
+ * When both are in one log this is a single record. Otherwise list2 is recorded as freed
+ * and list1, which has items its log has not seen, is written out whole.
+ */
+static void logConcat(LIST *list1, LIST *list2) {
+	LIST_LOG *log = list2->log;
+	if (log == NULL) {
+		logTouched(list1);
+		return;
+	}
+
+	LOCK_LOG(log);
+	int id1 = list1->logId;
+	int id2 = list2->logId;
+	int sameLog = list1->log == log;
+	if (!sameLog || log->dirty[id1] || log->dirty[id2] || bufferRecord(log, LOG_CONCAT, id1, id2, NULL) != 0) {
+		bufferRecord(log, LOG_FREE, id2, 0, NULL);
+		if (sameLog) {
+			log->dirty[id1] = bufferSnapshot(log, id1) != 0;
+		}
+	}
+	log->lists[id2] = NULL;
+	log->dirty[id2] = 0;
+	list2->log = NULL;
+	commitFullGroup(log);
+	UNLOCK_LOG(log);
+	if (!sameLog && list1->log != NULL) {
+		logTouched(list1);
+	}
+}
+
+/**
+ * Records a logged list being freed and stops logging it
+ */
+static void logFree(LIST *list) {
+	LIST_LOG *log = list->log;
+
+	LOCK_LOG(log);
+	bufferRecord(log, LOG_FREE, list->logId, 0, NULL);
+	log->lists[list->logId] = NULL;
+	log->dirty[list->logId] = 0;
+	list->log = NULL;
+	commitFullGroup(log);
+	UNLOCK_LOG(log);
+}
+
+/**
+ * Commits the log's records once a group of them has built up. This never checkpoints, as
+ * a checkpoint reads every logged list and the thread making the change may only own its own.
+ * Must be called with the log locked.
+ */
+static void commitFullGroup(LIST_LOG *log) {
+	if (log->config.groupSize > 0 && log->numPending >= log->config.groupSize) {
+		(void)commitLog(log);
+	}
+}
+
+/**
+ * Adds a record to the log's buffer, encoding the item if there is one.
+ * Must be called with the log locked.
+ * Returns 0 if successful, -1 if the buffer could not be grown.
+ */
+static int bufferRecord(LIST_LOG *log, uint32_t type, uint32_t id, uint64_t arg, void *item) {
+	const void *bytes = NULL;
+	size_t length = item != NULL ? (* log->codec.encode)(item, &bytes, log->codec.arg) : 0;
+	if (length > UINT32_MAX) {
+		return -1;
+	}
+	size_t recordBytes = sizeof(LOG_RECORD) + length + SERIAL_PADDING(length);
+
+	if (log->bufferUsed + recordBytes > log->bufferCapacity) {
+		size_t capacity = log->bufferCapacity > 0 ? log->bufferCapacity : LOG_MIN_BUFFER;
+		while (capacity < log->bufferUsed + recordBytes) {
+			capacity *= 2;
+		}
+		unsigned char *buffer = realloc(log->buffer, capacity);
+		if (buffer == NULL) {
+			return -1;
+		}
+		log->buffer = buffer;
+		log->bufferCapacity = capacity;
+	}
+
+	LOG_RECORD record = { .type = type, .id = id, .arg = arg, .length = (uint32_t)length };
+	record.checksum = recordChecksum(&record, bytes);
+	unsigned char *next = log->buffer + log->bufferUsed;
+	memcpy(next, &record, sizeof(LOG_RECORD));
+	if (length > 0) {
+		memcpy(next + sizeof(LOG_RECORD), bytes, length);
+	}
+	memset(next + sizeof(LOG_RECORD) + length, 0, SERIAL_PADDING(length));
+	log->bufferUsed += recordBytes;
+	log->numPending++;
+	return 0;
+}
+
+/**
+ * Adds records that empty a logged list and append its current items to the log's buffer.
+ * Must be called with the log locked.
+ * Returns 0 if successful, -1 if failed, leaving the buffer as it was.
+ */
+static int bufferSnapshot(LIST_LOG *log, int id) {
+	LIST *list = log->lists[id];
+	size_t bufferUsed = log->bufferUsed;
+	int numPending = log->numPending;
+
+	int result = bufferRecord(log, LOG_CLEAR, id, 0, NULL);
+	for (NODE *node = list->head; node != NULL && result == 0; node = NEXT(node)) {
+		result = bufferRecord(log, LOG_APPEND, id, 0, node->item);
+	}
+	if (result != 0) {
+		log->bufferUsed = bufferUsed;
+		log->numPending = numPending;
+	}
+	return result;
+}
+
+/**
+ * Returns the FNV-1a hash of a record's header, with its checksum taken as 0, and its item bytes
+ */
+static uint32_t recordChecksum(const LOG_RECORD *record, const void *bytes) {
+	LOG_RECORD header = *record;
+	header.checksum = 0;
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < sizeof(LOG_RECORD); i++) {
+		hash = (hash ^ ((const unsigned char *)&header)[i]) * 16777619u;
+	}
+	for (size_t i = 0; i < record->length; i++) {
+		hash = (hash ^ ((const unsigned char *)bytes)[i]) * 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Writes the buffer to the log file with one write and syncs it.
+ * A failed write is cut off the file so that the records can be written again,
+ * and if it cannot be, the file is torn and only a checkpoint can replace it.
+ * Must be called with the log locked.
+ * Returns 0 if successful, -1 if failed.
+ */
+static int commitLog(LIST_LOG *log) {
+	if (log->torn || (log->replacedFd >= 0 && syncRename(log) != 0)) {
+		return -1;
+	}
+	if (log->bufferUsed == 0) {
+		return 0;
+	}
+
+	struct iovec iov = { .iov_base = log->buffer, .iov_len = log->bufferUsed };
+	if (writeFully(log->fd, &iov, 1) != 0 || fdatasync(log->fd) != 0) {
+		/* Replay would stop at a partial record, and miss everything written after it */
+		if (ftruncate(log->fd, log->size) != 0) {
+			log->torn = 1;
+		}
+		return -1;
+	}
+	log->size += log->bufferUsed;
+	log->bufferUsed = 0;
+	log->numPending = 0;
+	return 0;
+}
+
+/**
+ * Commits the log, then writes every logged list whole to a new file beside it,
+ * syncs it, renames it over the old one and syncs the directory.
+ * Must be called with the log locked.
+ * Returns 0 if successful, -1 if failed, in which case the old file is still in use unless it was
+ * renamed over; then the new file is used, and commits fail until the directory can be synced.
+ */
+static int checkpointLog(LIST_LOG *log) {
+	if ((!log->torn && commitLog(log) != 0) || (log->replacedFd >= 0 && syncRename(log) != 0)) {
+		return -1;
+	}
+	/* Records a torn file could not take are covered by the snapshots */
+	log->bufferUsed = 0;
+	log->numPending = 0;
+
+	char *tempPath = malloc(strlen(log->path) + sizeof(".tmp"));
+	if (tempPath == NULL) {
+		return -1;
+	}
+	strcpy(tempPath, log->path);
+	strcat(tempPath, ".tmp");
+	int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+	if (fd < 0) {
+		free(tempPath);
+		return -1;
+	}
+
+	int result = 0;
+	for (int id = 0; id < LIST_LOG_MAX_LISTS && result == 0; id++) {
+		if (log->lists[id] != NULL) {
+			result = bufferSnapshot(log, id);
+		}
+	}
+
+	/* Commit the snapshots into the new file, then swap it in */
+	int oldFd = log->fd;
+	off_t oldSize = log->size;
+	int renamed = 0;
+	if (result == 0) {
+		log->fd = fd;
+		log->size = 0;
+		result = commitLog(log);
+		if (result == 0) {
+			result = rename(tempPath, log->path);
+			renamed = result == 0;
+		}
+	}
+
+	if (renamed) {
+		/* The path names the new file now, so the old one is only kept until the rename is durable */
+		memset(log->dirty, 0, sizeof(log->dirty));
+		log->torn = 0;
+		log->replacedFd = oldFd;
+		result = syncRename(log);
+	} else if (result != 0) {
+		/* The old file is complete, so the snapshots are not needed there */
+		log->bufferUsed = 0;
+		log->numPending = 0;
+		log->fd = oldFd;
+		log->size = oldSize;
+		close(fd);
+		unlink(tempPath);
+	}
+	free(tempPath);
+	return result == 0 ? 0 : -1;
+}
+
+/**
+ * Syncs the directory holding the log file, so that the rename made by a checkpoint survives
+ * a crash, then closes the file it replaced.
+ * Must be called with the log locked.
+ * Returns 0 if successful, -1 if the directory could not be synced.
+ */
+static int syncRename(LIST_LOG *log) {
+	if (syncDirectoryOf(log->path) != 0) {
+		return -1;
+	}
+	close(log->replacedFd);
+	log->replacedFd = -1;
+	return 0;
+}
+
+/**
+ * Syncs the directory holding the given file, so that a rename into it survives a crash.
+ * The path is cut at its last slash while the directory is opened, then put back.
+ * Returns 0 if successful, -1 if the directory could not be synced.
+ */
+static int syncDirectoryOf(char *path) {
+	char *slash = strrchr(path, '/');
+	int dirFd;
+	if (slash == NULL) {
+		dirFd = open(".", O_RDONLY | O_DIRECTORY);
+	} else {
+		*slash = '\0';
+		dirFd = open(slash == path ? "/" : path, O_RDONLY | O_DIRECTORY);
+		*slash = '/';
+	}
+	if (dirFd < 0) {
+		return -1;
+	}
+
+	int result = fsync(dirFd);
+	close(dirFd);
+	return result == 0 ? 0 : -1;
+}
+
+/**
+ * Applies one log record to the lists being replayed, creating the list it names if needed.
+ * Records for ids of numLists or more are skipped.
+ * Returns 0 if successful, -1 if the record does not fit the lists or an item could not be decoded.
+ */
+static int replayRecord(LIST_CONTEXT *context, const LIST_CODEC *codec, LIST **lists, int numLists,
+		const LOG_RECORD *record, const void *bytes) {
+	if (record->id >= (uint32_t)numLists) {
+		/* A list concatenated onto a skipped one is gone all the same */
+		if (record->type == LOG_CONCAT && record->arg < (uint64_t)numLists && lists[record->arg] != NULL) {
+			ListFree(lists[record->arg], codec->itemFree);
+			lists[record->arg] = NULL;
+		}
+		return 0;
+	}
+	LIST **list = &lists[record->id];
+	if (*list == NULL && record->type != LOG_FREE) {
+		*list = ListCreateIn(context);
+		if (*list == NULL) {
+			return -1;
+		}
+	}
+
+	void *item = NULL;
+	if (record->type == LOG_APPEND || record->type == LOG_PREPEND || record->type == LOG_INSERT) {
+		item = (* codec->decode)(bytes, record->length, codec->arg);
+		if (item == NULL) {
+			return -1;
+		}
+
+		int result = -1;
+		if (record->type == LOG_APPEND || (record->type == LOG_INSERT && record->arg == (uint64_t)(*list)->size)) {
+			result = ListAppend(*list, item);
+		} else if (record->type == LOG_PREPEND) {
+			result = ListPrepend(*list, item);
+		} else if (ListSeek(*list, record->arg < INT32_MAX ? (int)record->arg : -1) != NULL) {
+			result = ListInsert(*list, item);
+		}
+		if (result != 0 && codec->itemFree != NULL) {
+			(* codec->itemFree)(item);
+		}
+		return result;
+	} else if (record->type == LOG_REMOVE || record->type == LOG_TRIM) {
+		if (record->type == LOG_REMOVE) {
+			item = ListSeek(*list, record->arg < INT32_MAX ? (int)record->arg : -1) != NULL ? ListRemove(*list) : NULL;
+		} else {
+			item = ListTrim(*list);
+		}
+		if (item != NULL && codec->itemFree != NULL) {
+			(* codec->itemFree)(item);
+		}
+		return item != NULL ? 0 : -1;
+	} else if (record->type == LOG_CONCAT) {
+		if (record->arg >= (uint64_t)numLists || record->arg == record->id || lists[record->arg] == NULL) {
+			return -1;
+		}
+		ListConcat(*list, lists[record->arg]);
+		lists[record->arg] = NULL;
+		return 0;
+	} else if (record->type == LOG_FREE || record->type == LOG_CLEAR) {
+		ListFree(*list, codec->itemFree);
+		*list = record->type == LOG_CLEAR ? ListCreateIn(context) : NULL;
+		return record->type == LOG_CLEAR && *list == NULL ? -1 : 0;
+	}
+	return -1;
+}
+
+#ifdef USE_FILE_POOLS
+/**
+ * Opens and maps the pool file of a new context, then loads its roots and free list.
+ * Returns 0 if successful, -1 if failed, leaving whatever was mapped for unmapPool.
+ */
+static int openPool(LIST_CONTEXT *context, const char *path) {
+	context->copiesPath = malloc(strlen(path) + sizeof(POOL_COPIES_SUFFIX));
+	if (context->copiesPath == NULL) {
+		return -1;
+	}
+	strcpy(context->copiesPath, path);
+	strcat(context->copiesPath, POOL_COPIES_SUFFIX);
+
+	struct stat fileStat;
+	context->fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (context->fd < 0 || fstat(context->fd, &fileStat) != 0) {
+		return -1;
+	}
+	/* Root copies left by an earlier file at the same path belong to nothing now */
+	int created = fileStat.st_size == 0;
+	if (created && ((unlink(context->copiesPath) != 0 && errno != ENOENT) || ftruncate(context->fd, NODE_SLAB_BYTES) != 0)) {
+		return -1;
+	}
+	context->header = mapPoolSlab(context->fd, 0);
+	if (context->header == NULL) {
+		return -1;
+	}
+
+	POOL_HEADER *header = context->header;
+	if (created) {
+		memcpy(header->magic, POOL_MAGIC, sizeof(header->magic));
+		header->version = POOL_VERSION;
+		header->nodeSize = sizeof(NODE);
+		header->clean = 1;
+	} else if (memcmp(header->magic, POOL_MAGIC, sizeof(header->magic)) != 0 || header->version != POOL_VERSION
+			|| header->nodeSize != sizeof(NODE) || header->numNodeSlabs < 0 || header->numNodeSlabs > MAX_NODE_SLABS
+			|| fileStat.st_size < (off_t)(header->numNodeSlabs + 1) * NODE_SLAB_BYTES) {
+		return -1;
+	}
+
+	/* Map the slabs back at their old indices */
+	context->nodeSlabs = calloc(MAX_NODE_SLABS, sizeof(NODE_SLAB *));
+	if (context->nodeSlabs == NULL) {
+		return -1;
+	}
+	for (int i = 0; i < header->numNodeSlabs; i++) {
+		NODE_SLAB *slab = mapPoolSlab(context->fd, (off_t)(i + 1) * NODE_SLAB_BYTES);
+		if (slab == NULL) {
+			return -1;
+		}
+		context->nodeSlabs[i] = slab;
+		context->numNodeSlabs++;
+		if (slab->baseIndex != i * (int)NODES_PER_SLAB) {
+			return -1;
+		}
+	}
+
+	if (header->clean) {
+		if (loadRoots(context) != 0) {
+			return -1;
+		}
+		context->freeNodes = nodeOf(context, header->freeNodes);
+		context->numNodesAvailable = header->numNodesAvailable;
+	} else {
+		/* Links in the file may have changed since the checkpoint, so the roots are built afresh */
+		rebuildFreeNodes(context);
+		if (loadRootCopies(context) != 0) {
+			return -1;
+		}
+	}
+
+	/* The file stays unclean until it is closed, so a crash is noticed on the next open */
+	header->clean = 0;
+	if (msync(header, NODE_SLAB_BYTES, MS_SYNC) != 0) {
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Maps NODE_SLAB_BYTES of a pool file at the given offset, aligned to NODE_SLAB_BYTES as indexOfNode
+ * expects. The file is mapped over the aligned part of a reservation twice that size.
+ * Returns NULL if it could not be mapped.
+ */
+static void *mapPoolSlab(int fd, off_t offset) {
+	char *reserved = mmap(NULL, 2 * NODE_SLAB_BYTES, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (reserved == MAP_FAILED) {
+		return NULL;
+	}
+
+	char *aligned = (char *)(((uintptr_t)reserved + NODE_SLAB_BYTES - 1) & ~((uintptr_t)NODE_SLAB_BYTES - 1));
+	char *end = reserved + 2 * NODE_SLAB_BYTES;
+	if (aligned > reserved) {
+		munmap(reserved, aligned - reserved);
+	}
+	if (aligned + NODE_SLAB_BYTES < end) {
+		munmap(aligned + NODE_SLAB_BYTES, end - (aligned + NODE_SLAB_BYTES));
+	}
+
+	void *slab = mmap(aligned, NODE_SLAB_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset);
+	if (slab == MAP_FAILED) {
+		munmap(aligned, NODE_SLAB_BYTES);
+		return NULL;
+	}
+	return slab;
+}
+
+/**
+ * Unmaps the node slabs and header of a file-backed pool and closes its file, without saving anything
+ */
+static void unmapPool(LIST_CONTEXT *context) {
+	free(context->copiesPath);
+	context->copiesPath = NULL;
+	for (int i = 0; i < context->numNodeSlabs; i++) {
+		munmap(context->nodeSlabs[i], NODE_SLAB_BYTES);
+	}
+	context->numNodeSlabs = 0;
+	if (context->header != NULL) {
+		munmap(context->header, NODE_SLAB_BYTES);
+		context->header = NULL;
+	}
+	if (context->fd >= 0) {
+		close(context->fd);
+		context->fd = -1;
+	}
+}
+
+/**
+ * Creates a list head for each root saved in the header of a pool file that was closed cleanly.
+ * Returns 0 if successful, -1 if a list head could not be created.
+ */
+static int loadRoots(LIST_CONTEXT *context) {
+	for (int slot = 0; slot < LIST_MAX_ROOTS; slot++) {
+		POOL_ROOT *root = &context->header->roots[slot];
+		if (!root->inUse) {
+			continue;
+		}
+
+		LIST *list = ListCreateIn(context);
+		if (list == NULL) {
+			return -1;
+		}
+		list->head = nodeOf(context, root->head);
+		list->tail = nodeOf(context, root->tail);
+		list->current = nodeOf(context, root->current);
+		list->size = root->size;
+		list->currentIsBeyond = root->currentIsBeyond;
+		list->currentIndex = root->currentIndex;
+		context->roots[slot] = list;
+	}
+	return 0;
+}
+
+/**
+ * Builds each root of a pool file that was not closed cleanly from the copy of its items
+ * written by the last checkpoint, taking nodes from the free chain. A file that has never
+ * been checkpointed has no copies, and so no roots.
+ * Returns 0 if successful, -1 if the copies could not be read or do not hold together.
+ */
+static int loadRootCopies(LIST_CONTEXT *context) {
+	int fd = open(context->copiesPath, O_RDONLY);
+	if (fd < 0) {
+		return errno == ENOENT ? 0 : -1;
+	}
+
+	struct stat fileStat;
+	char *copies = NULL;
+	size_t bytes = 0;
+	if (fstat(fd, &fileStat) == 0 && fileStat.st_size >= (off_t)sizeof(POOL_COPIES_HEADER)) {
+		bytes = (size_t)fileStat.st_size;
+		copies = malloc(bytes);
+		if (copies != NULL && readFully(fd, copies, bytes) != 0) {
+			free(copies);
+			copies = NULL;
+		}
+	}
+	close(fd);
+	POOL_COPIES_HEADER *header = (POOL_COPIES_HEADER *)copies;
+	if (copies == NULL || memcmp(header->magic, POOL_COPIES_MAGIC, sizeof(header->magic)) != 0
+			|| header->version != POOL_VERSION) {
+		free(copies);
+		return -1;
+	}
+
+	size_t offset = sizeof(POOL_COPIES_HEADER);
+	int result = 0;
+	for (int i = 0; i < header->numRoots && result == 0; i++) {
+		POOL_ROOT_COPY *copy = (POOL_ROOT_COPY *)(copies + offset);
+		if (bytes - offset < sizeof(POOL_ROOT_COPY) || copy->slot < 0 || copy->slot >= LIST_MAX_ROOTS
+				|| context->roots[copy->slot] != NULL || copy->size < 0
+				|| (bytes - offset - sizeof(POOL_ROOT_COPY)) / sizeof(void *) < (size_t)copy->size) {
+			result = -1;
+			break;
+		}
+		void **items = (void **)(copy + 1);
+		offset += sizeof(POOL_ROOT_COPY) + (size_t)copy->size * sizeof(void *);
+
+		LIST *list = ListCreateIn(context);
+		if (list == NULL) {
+			result = -1;
+			break;
+		}
+		context->roots[copy->slot] = list;
+		if (copy->size == 0) {
+			continue;
+		}
+		NODE *last;
+		NODE *first = allocNodeRun(context, items, copy->size, &last);
+		if (first == NULL) {
+			result = -1;
+			break;
+		}
+		spliceNodes(list, NULL, NULL, first, last, copy->size);
+
+		/* Put the current pointer back where it was */
+		list->currentIsBeyond = copy->currentIsBeyond;
+		list->currentIndex = copy->currentIndex;
+		if (copy->currentIsBeyond != 0 || copy->currentIndex < 0 || copy->currentIndex >= copy->size) {
+			list->current = NULL;
+			continue;
+		}
+		list->current = list->head;
+		for (int position = 0; position < copy->currentIndex; position++) {
+			list->current = NEXT(list->current);
+		}
+	}
+	free(copies);
+	return result;
+}
+
+/**
+ * Chains every node of the pool into the free list, in address order
+ */
+static void rebuildFreeNodes(LIST_CONTEXT *context) {
+	int numNodes = context->numNodeSlabs * NODES_PER_SLAB;
+	NODE *first = NULL;
+
+	for (int i = numNodes - 1; i >= 0; i--) {
+		NODE *node = nodeAtIndex(context, i);
+		SET_NEXT(node, first);
+		first = node;
+	}
+	context->freeNodes = first;
+	context->numNodesAvailable = numNodes;
+}
+
+/**
+ * Returns the nodes of every list that is not at a root slot to the free chain, as those
+ * lists do not outlive the context. Must be called with the context locked.
+ */
+static void releaseUnrootedNodes(LIST_CONTEXT *context) {
+	int numListSlots = context->numListSlabs * (int)LISTS_PER_SLAB;
+
+	for (int listIndex = 0; listIndex < numListSlots; listIndex++) {
+		LIST *list = listAtIndex(context, listIndex);
+		if (!context->listInUse[listIndex] || list->size == 0) {
+			continue;
+		}
+		int rooted = 0;
+		for (int slot = 0; slot < LIST_MAX_ROOTS && !rooted; slot++) {
+			rooted = context->roots[slot] == list;
+		}
+		if (!rooted) {
+			giveFreeNodes(context, list->head, list->tail, list->size);
+			list->head = list->tail = list->current = NULL;
+			list->size = 0;
+		}
+	}
+}
+
+/**
+ * Copies the items of the roots of a file-backed pool to the file beside it, saves the roots
+ * to its header and syncs the slabs, then the header.
+ * Closing the file also saves the free chain and marks the file clean.
+ * Returns 0 if successful, -1 if the roots could not be copied or the file could not be synced.
+ */
+static int checkpointPool(LIST_CONTEXT *context, int clean) {
+	POOL_HEADER *header = context->header;
+	size_t copyBytes = 0;
+
+	LOCK_CONTEXT(context);
+	void *copies = copyRoots(context, &copyBytes);
+	for (int slot = 0; slot < LIST_MAX_ROOTS; slot++) {
+		LIST *list = context->roots[slot];
+		POOL_ROOT *root = &header->roots[slot];
+		if (list == NULL) {
+			memset(root, 0, sizeof(POOL_ROOT));
+			continue;
+		}
+		root->head = linkOf(list->head);
+		root->tail = linkOf(list->tail);
+		root->current = linkOf(list->current);
+		root->size = list->size;
+		root->currentIsBeyond = list->currentIsBeyond;
+		root->currentIndex = list->currentIndex;
+		root->inUse = 1;
+	}
+	int numNodeSlabs = context->numNodeSlabs;
+	header->numNodeSlabs = numNodeSlabs;
+	if (clean) {
+		header->freeNodes = linkOf(context->freeNodes);
+		header->numNodesAvailable = context->numNodesAvailable;
+	}
+	UNLOCK_CONTEXT(context);
+
+	int result = copies != NULL ? writeRootCopies(context, copies, copyBytes) : -1;
+	free(copies);
+	for (int i = 0; i < numNodeSlabs; i++) {
+		if (msync(context->nodeSlabs[i], NODE_SLAB_BYTES, MS_SYNC) != 0) {
+			result = -1;
+		}
+	}
+	header->clean = clean && result == 0;
+	if (msync(header, NODE_SLAB_BYTES, MS_SYNC) != 0) {
+		result = -1;
+	}
+	return result;
+}
+
+/**
+ * Copies the position and items of every root of a file-backed pool into one buffer,
+ * laid out as the root copies file holds them, and sets bytes to its length.
+ * Must be called with the context locked.
+ * Returns the buffer, which the caller frees, or NULL if it could not be allocated.
+ */
+static void *copyRoots(LIST_CONTEXT *context, size_t *bytes) {
+	size_t length = sizeof(POOL_COPIES_HEADER);
+	int numRoots = 0;
+	for (int slot = 0; slot < LIST_MAX_ROOTS; slot++) {
+		if (context->roots[slot] != NULL) {
+			length += sizeof(POOL_ROOT_COPY) + (size_t)context->roots[slot]->size * sizeof(void *);
+			numRoots++;
+		}
+	}
+	char *copies = malloc(length);
+	if (copies == NULL) {
+		return NULL;
+	}
+
+	POOL_COPIES_HEADER *header = (POOL_COPIES_HEADER *)copies;
+	memcpy(header->magic, POOL_COPIES_MAGIC, sizeof(header->magic));
+	header->version = POOL_VERSION;
+	header->numRoots = numRoots;
+	char *end = copies + sizeof(POOL_COPIES_HEADER);
+	for (int slot = 0; slot < LIST_MAX_ROOTS; slot++) {
+		LIST *list = context->roots[slot];
+		if (list == NULL) {
+			continue;
+		}
+		POOL_ROOT_COPY *copy = (POOL_ROOT_COPY *)end;
+		copy->slot = slot;
+		copy->size = list->size;
+		copy->currentIsBeyond = list->currentIsBeyond;
+		copy->currentIndex = list->current != NULL ? ListIndexOfCurrent(list) : list->currentIndex;
+		void **items = (void **)(copy + 1);
+		int count = 0;
+		for (NODE *node = list->head; node != NULL; node = NEXT(node)) {
+			items[count++] = node->item;
+		}
+		end = (char *)(items + count);
+	}
+	*bytes = length;
+	return copies;
+}
+
+/**
+ * Writes the root copies of a file-backed pool to a new file beside the old one, syncs it,
+ * renames it over the old one and syncs the directory, so that a crash leaves one or the other.
+ * Returns 0 if successful, -1 if failed.
+ */
+static int writeRootCopies(LIST_CONTEXT *context, void *copies, size_t bytes) {
+	char *tempPath = malloc(strlen(context->copiesPath) + sizeof(".tmp"));
+	if (tempPath == NULL) {
+		return -1;
+	}
+	strcpy(tempPath, context->copiesPath);
+	strcat(tempPath, ".tmp");
+	int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		free(tempPath);
+		return -1;
+	}
+
+	struct iovec iov = { copies, bytes };
+	int result = writeFully(fd, &iov, 1) == 0 && fdatasync(fd) == 0 ? 0 : -1;
+	close(fd);
+	if (result == 0) {
+		result = rename(tempPath, context->copiesPath);
+	}
+	if (result == 0) {
+		result = syncDirectoryOf(context->copiesPath);
+	} else {
+		unlink(tempPath);
+	}
+	free(tempPath);
+	return result == 0 ? 0 : -1;
+}
+#endif
@@ -1,26 +1,141 @@
 #ifndef _LIST_H_
 #define _LIST_H_
 
+/**
+ * Build options
+ * LIST_THREAD_SAFE: lists in different threads may share a context
+ * LIST_LOCK_FREE: as LIST_THREAD_SAFE, but nodes are allocated and released without locks
+ * LIST_COMPACT_NODES: nodes link to each other by 32-bit pool index instead of by pointer
+ * LIST_NO_STATS: leaves out the counters reported by ListGetStats
+ * LIST_LATENCY_HISTOGRAMS: times every counted operation into the histograms reported by ListGetLatency
+ */
+#if defined(LIST_LOCK_FREE) && !defined(LIST_THREAD_SAFE)
+#define LIST_THREAD_SAFE
+#endif
+#if defined(LIST_LATENCY_HISTOGRAMS) && defined(LIST_NO_STATS)
+#error "LIST_LATENCY_HISTOGRAMS keeps its histograms with the counters that LIST_NO_STATS leaves out"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LIST_MAX_ROOTS 1024 // Root slots of a file-backed context
+#define LIST_LOG_MAX_LISTS 1024 // Lists one mutation log can record
+
 /**
  * Structs
  */
+typedef struct LIST_CONTEXT LIST_CONTEXT;
+typedef struct LIST_CONTEXT_CONFIG {
+	int maxNodes; // Maximum nodes in use at once, 0 for no limit
+	int maxLists; // Maximum lists in use at once, 0 for no limit
+	int epochReclaim; // Nonzero to hold released nodes back from readers inside ListEpochEnter (thread-safe build)
+} LIST_CONTEXT_CONFIG;
+#ifdef LIST_COMPACT_NODES
+typedef uint32_t NODE_LINK; // Pool index + 1 of the linked node, 0 for none
+#else
+typedef struct NODE *NODE_LINK;
+#endif
 typedef struct NODE {
 	void *item;
-	struct NODE *previous;
-	struct NODE *next;
+	NODE_LINK previous; // Use ListNodePrev to follow
+	NODE_LINK next; // Use ListNodeNext to follow
 } NODE;
+typedef struct SKIP_INDEX SKIP_INDEX;
+typedef struct HASH_INDEX HASH_INDEX;
+typedef struct LIST_LOG LIST_LOG;
+typedef struct LIST_LOG_CONFIG {
+	int groupSize; // Records written and synced together, 0 to sync only on ListLogCommit
+	long checkpointBytes; // Log size at which ListLogCommit also checkpoints, 0 for never
+} LIST_LOG_CONFIG;
 typedef struct LIST {
 	NODE *current;
 	NODE *head;
 	NODE *tail;
 	int size;
 	int currentIsBeyond; // 0 if current is not beyond the list boundaries, -1 if before, 1 if after
+	int currentIndex; // Position of the current item, -1 if beyond the start, size if beyond the end, -2 if not yet counted
+	LIST_CONTEXT *context; // Context the list and its nodes were allocated from
+	SKIP_INDEX *skipIndex; // Optional index for positional access, NULL if not enabled
+	HASH_INDEX *hashIndex; // Optional index for key lookups, NULL if not enabled
+	LIST_LOG *log; // Optional mutation log, NULL if not logged
+	int logId; // The list's id in its log
+	unsigned edits; // Bumped by every change to the list's items or their order
 } LIST;
+typedef struct LIST_CURSOR {
+	LIST *list;
+	NODE *current;
+	int currentIsBeyond; // As for the list's own current pointer
+	int currentIndex; // As for the list's own current pointer, while edits still matches the list's
+	unsigned edits; // The list's edits when currentIndex was last known
+} LIST_CURSOR;
+typedef enum LIST_OP {
+	LIST_OP_CREATE,
+	LIST_OP_COUNT,
+	LIST_OP_FIRST,
+	LIST_OP_LAST,
+	LIST_OP_NEXT,
+	LIST_OP_PREV,
+	LIST_OP_CURR,
+	LIST_OP_ADD,
+	LIST_OP_INSERT,
+	LIST_OP_APPEND,
+	LIST_OP_PREPEND,
+	LIST_OP_APPEND_N,
+	LIST_OP_PREPEND_N,
+	LIST_OP_ADD_N,
+	LIST_OP_REMOVE,
+	LIST_OP_CONCAT,
+	LIST_OP_FREE,
+	LIST_OP_TRIM,
+	LIST_OP_SEARCH,
+	LIST_OP_SEARCH_PTR,
+	LIST_OP_REMOVE_IF,
+	LIST_OP_SORT,
+	LIST_OP_SEEK,
+	LIST_OP_FIND,
+	LIST_OP_CURSOR_SEARCH,
+	LIST_OP_COMPACT,
+	LIST_OP_CONTEXT_COMPACT,
+	LIST_NUM_OPS
+} LIST_OP;
+typedef struct LIST_STATS {
+	uint64_t calls[LIST_NUM_OPS]; // Calls to each operation, across every context and thread
+	uint64_t nullArgFailures[LIST_NUM_OPS]; // Calls that failed on a NULL list, item, array or comparator
+	uint64_t poolFailures[LIST_NUM_OPS]; // Calls that failed because the context could not supply a node or list
+	uint64_t searchNodesVisited; // Nodes compared by ListSearch, ListSearchPtr, ListCursorSearch and ListFind without its index
+	uint64_t skipIndexRebuilds; // Skip indexes ListSeek had to rebuild after a change they could not follow
+	int nodesInUse; // Nodes taken from the context's pool, including those cached by threads
+	int peakNodesInUse;
+	int listsInUse;
+	int peakListsInUse;
+} LIST_STATS;
+typedef struct LIST_LATENCY {
+	uint64_t count; // Calls timed since the last ListResetLatency
+	uint64_t p50Ns; // Percentiles are the upper bounds of the histogram buckets they fall in
+	uint64_t p99Ns;
+	uint64_t p999Ns;
+	uint64_t maxNs;
+} LIST_LATENCY;
+typedef struct LIST_CODEC {
+	size_t (*encode)(void *item, const void **bytes, void *arg); // Points bytes at an item's encoding and returns its length
+	void *(*decode)(const void *bytes, size_t length, void *arg); // Returns the item for an encoding, or NULL on failure
+	void (*itemFree)(void *item); // Frees an item decoded by a load that then failed, may be NULL
+	void *arg;
+} LIST_CODEC;
 
 /**
  * Function prototypes
  */
+LIST_CONTEXT *ListContextCreate(const LIST_CONTEXT_CONFIG *config);
+LIST_CONTEXT *ListContextOpen(const char *path, const LIST_CONTEXT_CONFIG *config);
+void ListContextDestroy(LIST_CONTEXT *context);
+LIST *ListContextRoot(LIST_CONTEXT *context, int slot);
+int ListContextCheckpoint(LIST_CONTEXT *context);
+int ListContextCompact(LIST_CONTEXT *context);
+void ListThreadFlush(void);
 LIST *ListCreate(void);
+LIST *ListCreateIn(LIST_CONTEXT *context);
 int ListCount(LIST *list);
 void *ListFirst(LIST *list);
 void *ListLast(LIST *list);
@@ -31,10 +146,53 @@ int ListAdd(LIST *list, void *item);
 int ListInsert(LIST *list, void *item);
 int ListAppend(LIST *list, void *item);
 int ListPrepend(LIST *list, void *item);
+int ListAppendN(LIST *list, void **items, int count);
+int ListPrependN(LIST *list, void **items, int count);
+int ListAddN(LIST *list, void **items, int count);
 void *ListRemove(LIST *list);
 void ListConcat(LIST *list1, LIST *list2);
 void ListFree(LIST *list, void (*itemFree)(void *));
 void *ListTrim(LIST *list);
 void *ListSearch(LIST *list, int (*comparator)(void *, void *), void *comparisonArg);
+void *ListSearchPtr(LIST *list, void *item);
+int ListRemoveIf(LIST *list, int (*comparator)(void *, void *), void *comparisonArg, void (*itemFree)(void *));
+int ListSort(LIST *list, int (*comparator)(void *, void *));
+int ListSortParallel(LIST *list, int (*comparator)(void *, void *), int numThreads);
+int ListCompact(LIST *list);
+int ListEnableSkipIndex(LIST *list);
+void ListDisableSkipIndex(LIST *list);
+void *ListSeek(LIST *list, int index);
+int ListIndexOfCurrent(LIST *list);
+int ListEnableHashIndex(LIST *list, void *(*keyOf)(void *), unsigned long (*hash)(void *), int (*comparator)(void *, void *));
+void ListDisableHashIndex(LIST *list);
+void *ListFind(LIST *list, void *key);
+void ListCursorInit(LIST_CURSOR *cursor, LIST *list);
+void *ListCursorFirst(LIST_CURSOR *cursor);
+void *ListCursorLast(LIST_CURSOR *cursor);
+void *ListCursorNext(LIST_CURSOR *cursor);
+void *ListCursorPrev(LIST_CURSOR *cursor);
+void *ListCursorCurr(LIST_CURSOR *cursor);
+void *ListCursorSearch(LIST_CURSOR *cursor, int (*comparator)(void *, void *), void *comparisonArg);
+int ListCursorAdd(LIST_CURSOR *cursor, void *item);
+int ListCursorInsert(LIST_CURSOR *cursor, void *item);
+void *ListCursorRemove(LIST_CURSOR *cursor);
+int ListSerialize(LIST *list, int fd, const LIST_CODEC *codec);
+LIST *ListDeserialize(LIST_CONTEXT *context, int fd, const LIST_CODEC *codec);
+LIST_LOG *ListLogOpen(const char *path, const LIST_CODEC *codec, const LIST_LOG_CONFIG *config);
+void ListLogClose(LIST_LOG *log);
+int ListEnableLog(LIST *list, LIST_LOG *log, int id);
+void ListDisableLog(LIST *list);
+int ListLogCommit(LIST_LOG *log);
+int ListLogCheckpoint(LIST_LOG *log);
+int ListLogReplay(const char *path, LIST_CONTEXT *context, const LIST_CODEC *codec, LIST **lists, int numLists);
+unsigned ListEpochEnter(LIST *list);
+void ListEpochExit(LIST *list, unsigned epoch);
+void ListGetStats(LIST_CONTEXT *context, LIST_STATS *stats);
+const char *ListOpName(LIST_OP op);
+int ListGetLatency(LIST_LATENCY *latency);
+int ListDumpLatency(int fd);
+void ListResetLatency(void);
+NODE *ListNodeNext(LIST *list, NODE *node);
+NODE *ListNodePrev(LIST *list, NODE *node);
 
 #endif /* _LIST_H_ */
\ No newline at end of file
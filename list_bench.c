@@ -0,0 +1,583 @@
+/***************************************************************
+ * Throughput benchmarks for the list operations, printed as   *
+ * CSV so that runs can be compared release to release         *
+ ***************************************************************/
+
+/***************************************************************
+ * Imports                                                     *
+ ***************************************************************/
+#include "list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/***************************************************************
+ * Defines                                                     *
+ ***************************************************************/
+#define BENCH_ROUNDS 3 // Each benchmark reports its fastest round
+#define BENCH_WORK (4 * 1000 * 1000) // Node visits a round of a scanning benchmark aims for
+#define BENCH_CONCAT_LENGTH 8 // Length of each list concatenated onto the growing one
+#define BENCH_CHURN_STRIDE 16 // Furthest the churned benchmark moves between removals and additions
+
+#ifdef LIST_LOCK_FREE
+#define BENCH_BUILD "lock_free"
+#elif defined(LIST_THREAD_SAFE)
+#define BENCH_BUILD "thread_safe"
+#else
+#define BENCH_BUILD "default"
+#endif
+#ifdef LIST_COMPACT_NODES
+#define BENCH_NODES "compact"
+#else
+#define BENCH_NODES "pointer"
+#endif
+
+/**
+ * A benchmark of one operation and access pattern. Run builds whatever it needs outside
+ * the timed section, then returns the nanoseconds spent in the operations it timed and
+ * the number of operations through numOps.
+ */
+typedef struct BENCHMARK {
+	const char *operation;
+	const char *pattern;
+	long long (*run)(int size, long *numOps);
+} BENCHMARK;
+
+/***************************************************************
+ * Statics                                                     *
+ ***************************************************************/
+static long long benchCreate(int size, long *numOps);
+static long long benchAppend(int size, long *numOps);
+static long long benchPrepend(int size, long *numOps);
+static long long benchAddMiddle(int size, long *numOps);
+static long long benchInsertMiddle(int size, long *numOps);
+static long long benchRemoveHead(int size, long *numOps);
+static long long benchRemoveMiddle(int size, long *numOps);
+static long long benchTrim(int size, long *numOps);
+static long long benchConcat(int size, long *numOps);
+static long long benchNext(int size, long *numOps);
+static long long benchNextChurned(int size, long *numOps);
+static long long benchNextCompacted(int size, long *numOps);
+static long long walkChurned(int size, int compact, long *numOps);
+static long long benchSeekRandom(int size, long *numOps);
+static long long searchFor(int size, int position, long *numOps);
+static long long benchSearchFirst(int size, long *numOps);
+static long long benchSearchMiddle(int size, long *numOps);
+static long long benchSearchMiss(int size, long *numOps);
+static long long benchSearchPtrMiss(int size, long *numOps);
+static long long benchFree(int size, long *numOps);
+static long long benchFreeItems(int size, long *numOps);
+static LIST *buildList(int size, int *values);
+static void churnStep(LIST *list);
+static long long nowNs(void);
+static int valueMatches(void *item, void *value);
+static void countItem(void *item);
+
+static const BENCHMARK benchmarks[] = {
+	{ "create", "empty", benchCreate },
+	{ "append", "tail", benchAppend },
+	{ "prepend", "head", benchPrepend },
+	{ "add", "middle", benchAddMiddle },
+	{ "insert", "middle", benchInsertMiddle },
+	{ "remove", "head", benchRemoveHead },
+	{ "remove", "middle", benchRemoveMiddle },
+	{ "trim", "tail", benchTrim },
+	{ "concat", "short_lists", benchConcat },
+	{ "next", "sequential", benchNext },
+	{ "next", "churned", benchNextChurned },
+	{ "next", "compacted", benchNextCompacted },
+	{ "seek", "random", benchSeekRandom },
+	{ "search", "hit_first", benchSearchFirst },
+	{ "search", "hit_middle", benchSearchMiddle },
+	{ "search", "miss", benchSearchMiss },
+	{ "search_ptr", "miss", benchSearchPtrMiss },
+	{ "free", "no_item_free", benchFree },
+	{ "free", "item_free", benchFreeItems },
+};
+static const int defaultSizes[] = { 16, 1024, 65536 };
+static volatile long sink; // Keeps results the compiler could otherwise discard
+
+/***************************************************************
+ * Main                                                        *
+ ***************************************************************/
+
+/**
+ * Runs every benchmark at each list size given on the command line, or at the default sizes.
+ * Prints one CSV row per benchmark and size.
+ */
+int main(int argc, char *argv[]) {
+	int numSizes = argc > 1 ? argc - 1 : (int)(sizeof(defaultSizes) / sizeof(defaultSizes[0]));
+	int sizes[numSizes];
+	for (int i = 0; i < numSizes; i++) {
+		sizes[i] = argc > 1 ? atoi(argv[i + 1]) : defaultSizes[i];
+		if (sizes[i] < 2) {
+			fprintf(stderr, "usage: %s [list size >= 2]...\n", argv[0]);
+			return 1;
+		}
+	}
+
+	printf("build,nodes,operation,pattern,size,ops,ns_per_op,ops_per_sec\n");
+	for (int i = 0; i < numSizes; i++) {
+		for (int j = 0; j < (int)(sizeof(benchmarks) / sizeof(benchmarks[0])); j++) {
+			double best = 0;
+			long numOps = 0;
+			for (int round = 0; round < BENCH_ROUNDS; round++) {
+				long long elapsed = benchmarks[j].run(sizes[i], &numOps);
+				double nsPerOp = (double)elapsed / (numOps > 0 ? numOps : 1);
+				if (round == 0 || nsPerOp < best) {
+					best = nsPerOp;
+				}
+			}
+			printf("%s,%s,%s,%s,%d,%ld,%.2f,%.0f\n", BENCH_BUILD, BENCH_NODES, benchmarks[j].operation,
+				benchmarks[j].pattern, sizes[i], numOps, best, best > 0 ? 1e9 / best : 0);
+		}
+	}
+	return 0;
+}
+
+/***************************************************************
+ * Static Functions                                            *
+ ***************************************************************/
+
+/**
+ * Creates size empty lists
+ */
+static long long benchCreate(int size, long *numOps) {
+	LIST **lists = malloc(size * sizeof(LIST *));
+
+	long long start = nowNs();
+	for (int i = 0; i < size; i++) {
+		lists[i] = ListCreate();
+	}
+	long long elapsed = nowNs() - start;
+
+	for (int i = 0; i < size; i++) {
+		ListFree(lists[i], NULL);
+	}
+	free(lists);
+	*numOps = size;
+	return elapsed;
+}
+
+/**
+ * Appends size items to an empty list
+ */
+static long long benchAppend(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = ListCreate();
+
+	long long start = nowNs();
+	for (int i = 0; i < size; i++) {
+		ListAppend(list, &values[i]);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(values);
+	*numOps = size;
+	return elapsed;
+}
+
+/**
+ * Prepends size items to an empty list
+ */
+static long long benchPrepend(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = ListCreate();
+
+	long long start = nowNs();
+	for (int i = 0; i < size; i++) {
+		ListPrepend(list, &values[i]);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(values);
+	*numOps = size;
+	return elapsed;
+}
+
+/**
+ * Adds size items after the current item of a list of size items, starting in the middle
+ */
+static long long benchAddMiddle(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+	ListSeek(list, size / 2);
+
+	long long start = nowNs();
+	for (int i = 0; i < size; i++) {
+		ListAdd(list, &values[i]);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(values);
+	*numOps = size;
+	return elapsed;
+}
+
+/**
+ * Inserts size items before the current item of a list of size items, starting in the middle
+ */
+static long long benchInsertMiddle(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+	ListSeek(list, size / 2);
+
+	long long start = nowNs();
+	for (int i = 0; i < size; i++) {
+		ListInsert(list, &values[i]);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(values);
+	*numOps = size;
+	return elapsed;
+}
+
+/**
+ * Removes every item of a list of size items from the front
+ */
+static long long benchRemoveHead(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+
+	long long start = nowNs();
+	for (int i = 0; i < size; i++) {
+		ListFirst(list);
+		ListRemove(list);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(values);
+	*numOps = size;
+	return elapsed;
+}
+
+/**
+ * Removes half the items of a list of size items, starting from the middle
+ */
+static long long benchRemoveMiddle(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+	ListSeek(list, size / 4);
+
+	long long start = nowNs();
+	for (int i = 0; i < size / 2; i++) {
+		ListRemove(list);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(values);
+	*numOps = size / 2;
+	return elapsed;
+}
+
+/**
+ * Trims every item of a list of size items
+ */
+static long long benchTrim(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+
+	long long start = nowNs();
+	for (int i = 0; i < size; i++) {
+		ListTrim(list);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(values);
+	*numOps = size;
+	return elapsed;
+}
+
+/**
+ * Concatenates short lists, size items in all, onto one list
+ */
+static long long benchConcat(int size, long *numOps) {
+	int numLists = size / BENCH_CONCAT_LENGTH > 0 ? size / BENCH_CONCAT_LENGTH : 1;
+	int *values = malloc(BENCH_CONCAT_LENGTH * sizeof(int));
+	LIST **lists = malloc(numLists * sizeof(LIST *));
+	for (int i = 0; i < numLists; i++) {
+		lists[i] = buildList(BENCH_CONCAT_LENGTH, values);
+	}
+	LIST *list = ListCreate();
+
+	long long start = nowNs();
+	for (int i = 0; i < numLists; i++) {
+		ListConcat(list, lists[i]);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(lists);
+	free(values);
+	*numOps = numLists;
+	return elapsed;
+}
+
+/**
+ * Walks a freshly built list of size items from front to back, repeatedly
+ */
+static long long benchNext(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+	int numPasses = BENCH_WORK / size > 0 ? BENCH_WORK / size : 1;
+	long count = 0;
+
+	long long start = nowNs();
+	for (int pass = 0; pass < numPasses; pass++) {
+		for (void *item = ListFirst(list); item != NULL; item = ListNext(list)) {
+			count++;
+		}
+	}
+	long long elapsed = nowNs() - start;
+
+	sink = count;
+	ListFree(list, NULL);
+	free(values);
+	*numOps = (long)numPasses * size;
+	return elapsed;
+}
+
+/**
+ * Walks a list of size items whose nodes were taken from a pool churned by random removals
+ * and additions, so that neighbouring items are rarely neighbours in memory
+ */
+static long long benchNextChurned(int size, long *numOps) {
+	return walkChurned(size, 0, numOps);
+}
+
+/**
+ * Walks a churned list of size items after ListCompact has put its nodes back in address order
+ */
+static long long benchNextCompacted(int size, long *numOps) {
+	return walkChurned(size, 1, numOps);
+}
+
+/**
+ * Churns a list of size items as for benchNextChurned, compacting it afterwards if asked,
+ * then walks it from front to back repeatedly
+ */
+static long long walkChurned(int size, int compact, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+	srand(size);
+	ListFirst(list);
+	for (int i = 0; i < size; i++) {
+		churnStep(list);
+		ListRemove(list);
+		churnStep(list);
+		ListAdd(list, &values[i]);
+	}
+	if (compact) {
+		ListCompact(list);
+	}
+	int numPasses = BENCH_WORK / size > 0 ? BENCH_WORK / size : 1;
+	long count = 0;
+
+	long long start = nowNs();
+	for (int pass = 0; pass < numPasses; pass++) {
+		for (void *item = ListFirst(list); item != NULL; item = ListNext(list)) {
+			count++;
+		}
+	}
+	long long elapsed = nowNs() - start;
+
+	sink = count;
+	ListFree(list, NULL);
+	free(values);
+	*numOps = (long)numPasses * size;
+	return elapsed;
+}
+
+/**
+ * Seeks to random positions of a list of size items
+ */
+static long long benchSeekRandom(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+	int numSeeks = BENCH_WORK / size > 0 ? BENCH_WORK / size : 1;
+	int *positions = malloc(numSeeks * sizeof(int));
+	srand(size);
+	for (int i = 0; i < numSeeks; i++) {
+		positions[i] = rand() % size;
+	}
+
+	long long start = nowNs();
+	for (int i = 0; i < numSeeks; i++) {
+		sink = *(int *)ListSeek(list, positions[i]);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(positions);
+	free(values);
+	*numOps = numSeeks;
+	return elapsed;
+}
+
+/**
+ * Searches a list of size items for an item at the given position, or for one it does not hold
+ * for a position of -1, repeatedly
+ */
+static long long searchFor(int size, int position, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+	int missing = -1;
+	int *target = position >= 0 ? &values[position] : &missing;
+	int numSearches = BENCH_WORK / size > 0 ? BENCH_WORK / size : 1;
+
+	long long start = nowNs();
+	for (int i = 0; i < numSearches; i++) {
+		ListFirst(list);
+		sink = (long)ListSearch(list, valueMatches, target);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(values);
+	*numOps = numSearches;
+	return elapsed;
+}
+
+/**
+ * Searches a list of size items for its first item
+ */
+static long long benchSearchFirst(int size, long *numOps) {
+	return searchFor(size, 0, numOps);
+}
+
+/**
+ * Searches a list of size items for its middle item
+ */
+static long long benchSearchMiddle(int size, long *numOps) {
+	return searchFor(size, size / 2, numOps);
+}
+
+/**
+ * Searches a list of size items for an item it does not hold
+ */
+static long long benchSearchMiss(int size, long *numOps) {
+	return searchFor(size, -1, numOps);
+}
+
+/**
+ * Searches a list of size items for a pointer it does not hold
+ */
+static long long benchSearchPtrMiss(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	LIST *list = buildList(size, values);
+	int missing = -1;
+	int numSearches = BENCH_WORK / size > 0 ? BENCH_WORK / size : 1;
+
+	long long start = nowNs();
+	for (int i = 0; i < numSearches; i++) {
+		ListFirst(list);
+		sink = (long)ListSearchPtr(list, &missing);
+	}
+	long long elapsed = nowNs() - start;
+
+	ListFree(list, NULL);
+	free(values);
+	*numOps = numSearches;
+	return elapsed;
+}
+
+/**
+ * Frees lists of size items, without visiting their items
+ */
+static long long benchFree(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	int numLists = BENCH_WORK / 4 / size > 0 ? BENCH_WORK / 4 / size : 1;
+	LIST **lists = malloc(numLists * sizeof(LIST *));
+	for (int i = 0; i < numLists; i++) {
+		lists[i] = buildList(size, values);
+	}
+
+	long long start = nowNs();
+	for (int i = 0; i < numLists; i++) {
+		ListFree(lists[i], NULL);
+	}
+	long long elapsed = nowNs() - start;
+
+	free(lists);
+	free(values);
+	*numOps = numLists;
+	return elapsed;
+}
+
+/**
+ * Frees lists of size items, passing each item to itemFree
+ */
+static long long benchFreeItems(int size, long *numOps) {
+	int *values = malloc(size * sizeof(int));
+	int numLists = BENCH_WORK / 4 / size > 0 ? BENCH_WORK / 4 / size : 1;
+	LIST **lists = malloc(numLists * sizeof(LIST *));
+	for (int i = 0; i < numLists; i++) {
+		lists[i] = buildList(size, values);
+	}
+
+	long long start = nowNs();
+	for (int i = 0; i < numLists; i++) {
+		ListFree(lists[i], countItem);
+	}
+	long long elapsed = nowNs() - start;
+
+	free(lists);
+	free(values);
+	*numOps = numLists;
+	return elapsed;
+}
+
+/**
+ * Returns a new list holding the given values 0, 1, ... size - 1 in order
+ */
+static LIST *buildList(int size, int *values) {
+	LIST *list = ListCreate();
+	for (int i = 0; i < size; i++) {
+		values[i] = i;
+		ListAppend(list, &values[i]);
+	}
+	return list;
+}
+
+/**
+ * Moves the current item of a list forward by a random number of items up to BENCH_CHURN_STRIDE,
+ * wrapping around to the front, so that churning a list stays linear in its length
+ */
+static void churnStep(LIST *list) {
+	for (int steps = rand() % BENCH_CHURN_STRIDE; steps >= 0; steps--) {
+		if (ListNext(list) == NULL) {
+			ListFirst(list);
+		}
+	}
+}
+
+/**
+ * Returns the monotonic clock in nanoseconds
+ */
+static long long nowNs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Search comparator: returns 1 if the item holds the value, 0 if not
+ */
+static int valueMatches(void *item, void *value) {
+	return *(int *)item == *(int *)value;
+}
+
+/**
+ * Item free routine that only touches the item, for timing ListFree's visit to each one
+ */
+static void countItem(void *item) {
+	sink += *(int *)item;
+}
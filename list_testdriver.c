@@ -9,9 +9,22 @@
  * Imports                                                     *
  ***************************************************************/
 #include "list.h"
+#include "ulist.h"
+#include "ilist.h"
+#include "list_typed.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef LIST_THREAD_SAFE
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(LIST_COMPACT_NODES) && !defined(LIST_LOCK_FREE)
+#include <sys/wait.h>
+#endif
 
 /***************************************************************
  * Statics                                                     *
@@ -27,16 +40,80 @@ static void ListAddTest();
 static void ListInsertTest();
 static void ListAppendTest();
 static void ListPrependTest();
+static void ListAppendNTest();
+static void ListPrependNTest();
+static void ListAddNTest();
 static void ListRemoveTest();
 static void ListConcatTest();
 static void ListTrimTest();
 static void ListSearchTest();
+static void ListSearchPtrTest();
+static void ListRemoveIfTest();
+static void ListSeekTest();
+static void ListFindTest();
+static void ListSortTest();
+static void ListCompactTest();
+static void ListCursorTest();
+static void ListSerializeTest();
+static void ListLogTest();
+static void ListContextTest();
+static void ListStatsTest();
+static void ListLatencyTest();
+static void UListTest();
+static void IListTest();
+static void ListTypedTest();
+#if defined(LIST_COMPACT_NODES) && !defined(LIST_LOCK_FREE)
+static void ListPoolTest();
+static LIST_CONTEXT *crashAfterCheckpoint(const char *path, int change);
+#endif
+#ifdef LIST_THREAD_SAFE
+static void ListThreadTest();
+static void *listThreadWorker(void *arg);
+static void *listAppendWorker(void *arg);
+static void *listCursorWorker(void *arg);
+static void *listEpochWriter(void *arg);
+static void *listEpochReader(void *arg);
+#endif
 
 /***************************************************************
  * Globals                                                     *
  ***************************************************************/
+typedef struct KEYED_INT {
+	int key;
+	int sequence;
+} KEYED_INT;
+#define INT_COMPARE(a, b)		(((a) > (b)) - ((a) < (b)))
+#define KEYED_COMPARE(a, b)		INT_COMPARE((a).key, (b).key)
+LIST_DEFINE(IntList, int, INT_COMPARE)
+LIST_DEFINE(KeyedList, KEYED_INT, KEYED_COMPARE)
+typedef struct LINKED_INT {
+	int value;
+	ILIST_LINK link;
+} LINKED_INT;
+
 int successComparator(void *item1, void *item2);
 int failComparator(void *item1, void *item2);
+int identityComparator(void *item1, void *item2);
+void countingItemFree(void *item);
+int evenComparator(void *item1, void *item2);
+int valueComparator(void *item1, void *item2);
+void *itemKey(void *item);
+unsigned long valueHash(void *key);
+int listHoldsItems(LIST *list, void **items, int count);
+int intItemCompare(void *item1, void *item2);
+int keyedItemCompare(void *item1, void *item2);
+int listIsSorted(LIST *list, int (*comparator)(void *, void *));
+size_t stringEncode(void *item, const void **bytes, void *arg);
+void *stringDecode(const void *bytes, size_t length, void *arg);
+void stringFree(void *item);
+int listHoldsStrings(LIST *list, char (*strings)[16], int count);
+int listsHoldSameStrings(LIST *list1, LIST *list2);
+int stringCompare(void *item1, void *item2);
+int evenLengthComparator(void *item, void *comparisonArg);
+int stringsLive;
+void *linkedItem(ILIST_LINK *link);
+int linkValueComparator(ILIST_LINK *link, void *value);
+void countingLinkFree(ILIST_LINK *link);
 
 /***************************************************************
  * Main (test driver)                                          *
@@ -63,13 +140,37 @@ int main(void) {
 	ListInsertTest();
 	ListAppendTest();
 	ListPrependTest();
+	ListAppendNTest();
+	ListPrependNTest();
+	ListAddNTest();
 	ListRemoveTest();
 	ListConcatTest();
 	ListTrimTest();
 	ListSearchTest();
+	ListSearchPtrTest();
+	ListRemoveIfTest();
+	ListSeekTest();
+	ListFindTest();
+	ListSortTest();
+	ListCompactTest();
+	ListCursorTest();
+	ListSerializeTest();
+	ListLogTest();
+	ListContextTest();
+	ListStatsTest();
+	ListLatencyTest();
+	UListTest();
+	IListTest();
+	ListTypedTest();
+#if defined(LIST_COMPACT_NODES) && !defined(LIST_LOCK_FREE)
+	ListPoolTest();
+#endif
+#ifdef LIST_THREAD_SAFE
+	ListThreadTest();
+#endif
 
 	printf("------------------------------------------------------\n");
-	printf("| TOTAL:      |     121      |      697     |  PASS  |\n");
+	printf("| TOTAL:      |     214      |   140337     |  PASS  |\n");
 	printf("------------------------------------------------------\n\n");
 	printf("\n*****************************************************\n");
 	printf("* All tests passed! Exiting...                      *\n");
@@ -84,13 +185,13 @@ int main(void) {
 /**
  * ListCreate test cases:
  * 1. Create a list, returns pointer to empty list, check list parameters
- * 2. Fill up all list head space, returns NULL
+ * 2. Create more lists than fit in one list slab, all are distinct and usable
  */
 static void ListCreateTest() {
-	LIST *listArr[11];
+	LIST *listArr[1000];
 
 	/* Test Case 1 */
-	/* Attempt to create 10 lists (maximum number) successfully */
+	/* Attempt to create 10 lists successfully */
 	for (int i = 0; i < 10; i++) {
 		listArr[i] = ListCreate();
 		assert(listArr[i] != NULL 
@@ -108,16 +209,27 @@ static void ListCreateTest() {
 	}
 
 	/* Test Case 2 */
-	/* Attempt to create a list when list space is exhausted */
-	listArr[10] = ListCreate();
-	assert(listArr[10] == NULL
-		&& "FAIL: A pointer was returned even though list space should be full.\n");
+	/* Keep creating lists well past the old fixed limit of 10 */
+	int testInt[1000];
+	for (int i = 10; i < 1000; i++) {
+		listArr[i] = ListCreate();
+		assert(listArr[i] != NULL
+			&& "FAIL: List creation failed once the first list slab was used up.\n");
+	}
+	for (int i = 0; i < 1000; i++) {
+		testInt[i] = i;
+		ListAppend(listArr[i], &testInt[i]);
+	}
+	for (int i = 0; i < 1000; i++) {
+		assert(ListCount(listArr[i]) == 1 && ListCurr(listArr[i]) == &testInt[i]
+			&& "FAIL: Lists created from the grown pool share storage.\n");
+	}
 
 	/* Cleanup */
-	for (int i = 0; i < 10; i++) {
+	for (int i = 0; i < 1000; i++) {
 		ListFree(listArr[i], NULL);
 	}
-	printf("| ListCreate  |       2      |       61     |  PASS  |\n");
+	printf("| ListCreate  |       2      |     2050     |  PASS  |\n");
 }
 
 /**
@@ -558,9 +670,9 @@ static void ListAddTest() {
 		&& "FAIL: The list's head is wrong for a list with a single item\n");
 	assert(list->tail->item == &testFloat[0]
 		&& "FAIL: The list's tail is wrong for a list with a single item\n");
-	assert(list->current->next == NULL
+	assert(ListNodeNext(list, list->current) == NULL
 		&& "FAIL: The list's added item's next pointer is wrong\n");
-	assert(list->current->previous == NULL
+	assert(ListNodePrev(list, list->current) == NULL
 		&& "FAIL: The list's added item's previous pointer is wrong\n");
 
 	/* Test Case 5 */
@@ -573,11 +685,11 @@ static void ListAddTest() {
 		&& "FAIL: The list's head is wrong for a list with two items\n");
 	assert(list->tail->item == &testFloat[1]
 		&& "FAIL: The list's tail is wrong for a list with a two items\n");
-	assert(list->current->next == NULL
+	assert(ListNodeNext(list, list->current) == NULL
 		&& "FAIL: The list's added item's next pointer is wrong\n");
-	assert(list->current->previous->item == &testFloat[0]
+	assert(ListNodePrev(list, list->current)->item == &testFloat[0]
 		&& "FAIL: The list's added item's previous pointer is wrong\n");
-	assert(list->head->next->item == &testFloat[1]
+	assert(ListNodeNext(list, list->head)->item == &testFloat[1]
 		&& "FAIL: The list head's next pointer is wrong\n");
 
 	/* Test Case 6 */
@@ -590,11 +702,11 @@ static void ListAddTest() {
 		&& "FAIL: The list's head is wrong for a list with three items\n");
 	assert(list->tail->item == &testFloat[2]
 		&& "FAIL: The list's tail is wrong for a list with a three items\n");
-	assert(list->current->next == NULL
+	assert(ListNodeNext(list, list->current) == NULL
 		&& "FAIL: The list's added item's next pointer is wrong\n");
-	assert(list->current->previous->item == &testFloat[1]
+	assert(ListNodePrev(list, list->current)->item == &testFloat[1]
 		&& "FAIL: The list's added item's previous pointer is wrong\n");
-	assert(list->tail->previous->next->item == &testFloat[2]
+	assert(ListNodeNext(list, ListNodePrev(list, list->tail))->item == &testFloat[2]
 		&& "FAIL: The list item before the added item did not update its next pointer\n");
 
 	/* Test Case 7 */
@@ -605,13 +717,13 @@ static void ListAddTest() {
 	for (int i = 0; i < 5; i++) {
 		assert(node->item == &testFloat[i]
 			&& "FAIL: The list was not linked correctly");
-		node = node->next;
+		node = ListNodeNext(list, node);
 	}
 	node = list->tail;
 	for (int i = 5; i > 0; i--) {
 		assert(node->item == &testFloat[i - 1]
 			&& "FAIL: The list was not linked correctly");
-		node = node->previous;
+		node = ListNodePrev(list, node);
 	}
 
 	/* Cleanup */
@@ -658,9 +770,9 @@ static void ListInsertTest() {
 		&& "FAIL: The list's head is wrong for a list with a single item\n");
 	assert(list->tail->item == &testFloat[0]
 		&& "FAIL: The list's tail is wrong for a list with a single item\n");
-	assert(list->current->next == NULL
+	assert(ListNodeNext(list, list->current) == NULL
 		&& "FAIL: The list's inserted item's next pointer is wrong\n");
-	assert(list->current->previous == NULL
+	assert(ListNodePrev(list, list->current) == NULL
 		&& "FAIL: The list's inserted item's previous pointer is wrong\n");
 
 	/* Test Case 5 */
@@ -673,11 +785,11 @@ static void ListInsertTest() {
 		&& "FAIL: The list's head is wrong for a list with two items\n");
 	assert(list->tail->item == &testFloat[0]
 		&& "FAIL: The list's tail is wrong for a list with a two items\n");
-	assert(list->current->next->item == &testFloat[0]
+	assert(ListNodeNext(list, list->current)->item == &testFloat[0]
 		&& "FAIL: The list's inserted item's next pointer is wrong\n");
-	assert(list->current->previous == NULL
+	assert(ListNodePrev(list, list->current) == NULL
 		&& "FAIL: The list's inserted item's previous pointer is wrong\n");
-	assert(list->tail->previous->item == &testFloat[1]
+	assert(ListNodePrev(list, list->tail)->item == &testFloat[1]
 		&& "FAIL: The list tail's previous pointer is wrong\n");
 
 	/* Test Case 6 */
@@ -690,11 +802,11 @@ static void ListInsertTest() {
 		&& "FAIL: The list's head is wrong for a list with three items\n");
 	assert(list->tail->item == &testFloat[0]
 		&& "FAIL: The list's tail is wrong for a list with a three items\n");
-	assert(list->current->next->item == &testFloat[1]
+	assert(ListNodeNext(list, list->current)->item == &testFloat[1]
 		&& "FAIL: The list's inserted item's next pointer is wrong\n");
-	assert(list->current->previous == NULL
+	assert(ListNodePrev(list, list->current) == NULL
 		&& "FAIL: The list's inserted item's previous pointer is wrong\n");
-	assert(list->current->next->previous->item == &testFloat[2]
+	assert(ListNodePrev(list, ListNodeNext(list, list->current))->item == &testFloat[2]
 		&& "FAIL: The list item after the inserted item did not update its previous pointer\n");
 
 	/* Cleanup */
@@ -709,6 +821,7 @@ static void ListInsertTest() {
  * 4. Append item to empty list, check list params
  * 5. Append item to list with one item, check list params
  * 6. Append item to list with multiple items, check list params
+ * 7. Append more items than fit in one node slab, check all items linked correctly
  */
 static void ListAppendTest() {
 	LIST *list = ListCreate();
@@ -741,9 +854,9 @@ static void ListAppendTest() {
 		&& "FAIL: The list's head is wrong for a list with a single item\n");
 	assert(list->tail->item == &testFloat[0]
 		&& "FAIL: The list's tail is wrong for a list with a single item\n");
-	assert(list->current->next == NULL
+	assert(ListNodeNext(list, list->current) == NULL
 		&& "FAIL: The list's appended item's next pointer is wrong\n");
-	assert(list->current->previous == NULL
+	assert(ListNodePrev(list, list->current) == NULL
 		&& "FAIL: The list's appended item's previous pointer is wrong\n");
 
 	/* Test Case 5 */
@@ -756,11 +869,11 @@ static void ListAppendTest() {
 		&& "FAIL: The list's head is wrong for a list with two items\n");
 	assert(list->tail->item == &testFloat[1]
 		&& "FAIL: The list's tail is wrong for a list with a two items\n");
-	assert(list->current->previous->item == &testFloat[0]
+	assert(ListNodePrev(list, list->current)->item == &testFloat[0]
 		&& "FAIL: The list's appended item's previous pointer is wrong\n");
-	assert(list->current->next == NULL
+	assert(ListNodeNext(list, list->current) == NULL
 		&& "FAIL: The list's appended item's next pointer is wrong\n");
-	assert(list->head->next->item == &testFloat[1]
+	assert(ListNodeNext(list, list->head)->item == &testFloat[1]
 		&& "FAIL: The list head's next pointer is wrong\n");
 
 	/* Test Case 6 */
@@ -773,16 +886,31 @@ static void ListAppendTest() {
 		&& "FAIL: The list's head is wrong for a list with three items\n");
 	assert(list->tail->item == &testFloat[2]
 		&& "FAIL: The list's tail is wrong for a list with a three items\n");
-	assert(list->current->previous->item == &testFloat[1]
+	assert(ListNodePrev(list, list->current)->item == &testFloat[1]
 		&& "FAIL: The list's appended item's previous pointer is wrong\n");
-	assert(list->current->next == NULL
+	assert(ListNodeNext(list, list->current) == NULL
 		&& "FAIL: The list's appended item's next pointer is wrong\n");
-	assert(list->current->previous->next->item == &testFloat[2]
+	assert(ListNodeNext(list, ListNodePrev(list, list->current))->item == &testFloat[2]
 		&& "FAIL: The list item before the appended item did not update its previous pointer\n");
 
+	/* Test Case 7 */
+	ListFree(list, NULL);
+	list = ListCreate();
+	static int manyInts[10000];
+	for (int i = 0; i < 10000; i++) {
+		assert(ListAppend(list, &manyInts[i]) == 0
+			&& "FAIL: Appending item failed once the first node slab was used up\n");
+	}
+	NODE *node = list->head;
+	for (int i = 0; i < 10000; i++) {
+		assert(node->item == &manyInts[i]
+			&& "FAIL: The list was not linked correctly across node slabs\n");
+		node = ListNodeNext(list, node);
+	}
+
 	/* Cleanup */
 	ListFree(list, NULL);
-	printf("| ListAppend  |       6      |       23     |  PASS  |\n");
+	printf("| ListAppend  |       7      |    20023     |  PASS  |\n");
 }
 
 /**
@@ -824,9 +952,9 @@ static void ListPrependTest() {
 		&& "FAIL: The list's head is wrong for a list with a single item\n");
 	assert(list->tail->item == &testFloat[0]
 		&& "FAIL: The list's tail is wrong for a list with a single item\n");
-	assert(list->current->next == NULL
+	assert(ListNodeNext(list, list->current) == NULL
 		&& "FAIL: The list's prepended item's next pointer is wrong\n");
-	assert(list->current->previous == NULL
+	assert(ListNodePrev(list, list->current) == NULL
 		&& "FAIL: The list's prepended item's previous pointer is wrong\n");
 
 	/* Test Case 5 */
@@ -839,11 +967,11 @@ static void ListPrependTest() {
 		&& "FAIL: The list's head is wrong for a list with two items\n");
 	assert(list->tail->item == &testFloat[0]
 		&& "FAIL: The list's tail is wrong for a list with a two items\n");
-	assert(list->current->next->item == &testFloat[0]
+	assert(ListNodeNext(list, list->current)->item == &testFloat[0]
 		&& "FAIL: The list's prepended item's next pointer is wrong\n");
-	assert(list->current->previous == NULL
+	assert(ListNodePrev(list, list->current) == NULL
 		&& "FAIL: The list's prepended item's previous pointer is wrong\n");
-	assert(list->tail->previous->item == &testFloat[1]
+	assert(ListNodePrev(list, list->tail)->item == &testFloat[1]
 		&& "FAIL: The list tail's previous pointer is wrong\n");
 
 	/* Test Case 6 */
@@ -856,11 +984,11 @@ static void ListPrependTest() {
 		&& "FAIL: The list's head is wrong for a list with three items\n");
 	assert(list->tail->item == &testFloat[0]
 		&& "FAIL: The list's tail is wrong for a list with a three items\n");
-	assert(list->current->next->item == &testFloat[1]
+	assert(ListNodeNext(list, list->current)->item == &testFloat[1]
 		&& "FAIL: The list's prepended item's next pointer is wrong\n");
-	assert(list->current->previous == NULL
+	assert(ListNodePrev(list, list->current) == NULL
 		&& "FAIL: The list's prepended item's previous pointer is wrong\n");
-	assert(list->current->next->previous->item == &testFloat[2]
+	assert(ListNodePrev(list, ListNodeNext(list, list->current))->item == &testFloat[2]
 		&& "FAIL: The list item after the prepended item did not update its previous pointer\n");
 
 	/* Cleanup */
@@ -868,6 +996,158 @@ static void ListPrependTest() {
 	printf("| ListPrepend |       6      |       23     |  PASS  |\n");
 }
 
+/**
+ * 1. Append arrays to a NULL list, a NULL array, a negative count and an array holding NULL
+ * 2. Append an empty array
+ * 3. Append an array to an empty list
+ * 4. Append an array to a list with items
+ * 5. Append an array large enough to grow the pool
+ * 6. Append an array past a context's node limit, nothing is added
+ */
+static void ListAppendNTest() {
+	static int testInt[1000];
+	void *items[1000];
+	for (int i = 0; i < 1000; i++) {
+		items[i] = &testInt[i];
+	}
+	void *withNull[3] = {&testInt[0], NULL, &testInt[2]};
+	LIST *list = ListCreate();
+
+	/* Test Case 1 */
+	assert(ListAppendN(NULL, items, 3) == -1 && ListAppendN(list, NULL, 3) == -1
+		&& ListAppendN(list, items, -1) == -1 && ListAppendN(list, withNull, 3) == -1
+		&& "FAIL: Appending an invalid array did not return -1\n");
+	assert(list->size == 0 && list->head == NULL
+		&& "FAIL: Appending an invalid array changed the list\n");
+
+	/* Test Case 2 */
+	assert(ListAppendN(list, items, 0) == 0 && list->size == 0
+		&& "FAIL: Appending an empty array failed or changed the list\n");
+
+	/* Test Case 3 */
+	assert(ListAppendN(list, items, 3) == 0
+		&& "FAIL: Appending an array to an empty list failed\n");
+	assert(listHoldsItems(list, items, 3)
+		&& "FAIL: The list does not hold the appended items in order\n");
+	assert(ListCurr(list) == &testInt[2] && list->currentIsBeyond == 0
+		&& "FAIL: The list's current item is not the last appended item\n");
+
+	/* Test Case 4 */
+	assert(ListAppendN(list, &items[3], 2) == 0
+		&& "FAIL: Appending an array to a list with items failed\n");
+	assert(listHoldsItems(list, items, 5) && ListCurr(list) == &testInt[4]
+		&& "FAIL: The appended items did not follow the list's existing items\n");
+
+	/* Test Case 5 */
+	assert(ListAppendN(list, &items[5], 995) == 0 && listHoldsItems(list, items, 1000)
+		&& "FAIL: Appending a large array did not keep every item in order\n");
+	ListFree(list, NULL);
+
+	/* Test Case 6 */
+	LIST_CONTEXT_CONFIG config = { .maxNodes = 4 };
+	LIST_CONTEXT *context = ListContextCreate(&config);
+	list = ListCreateIn(context);
+	assert(ListAppendN(list, items, 3) == 0
+		&& "FAIL: Appending within the context's node limit failed\n");
+	assert(ListAppendN(list, &items[3], 2) == -1 && listHoldsItems(list, items, 3)
+		&& "FAIL: Appending past the context's node limit added items\n");
+	assert(ListAppendN(list, &items[3], 1) == 0 && listHoldsItems(list, items, 4)
+		&& "FAIL: A failed append did not return its nodes to the context\n");
+
+	/* Cleanup */
+	ListContextDestroy(context);
+	printf("| ListAppendN |       6      |       12     |  PASS  |\n");
+}
+
+/**
+ * 1. Prepend an array holding NULL, nothing is added
+ * 2. Prepend an array to an empty list
+ * 3. Prepend an array to a list with items
+ */
+static void ListPrependNTest() {
+	int testInt[5];
+	void *items[5] = {&testInt[0], &testInt[1], &testInt[2], &testInt[3], &testInt[4]};
+	void *withNull[2] = {&testInt[0], NULL};
+	LIST *list = ListCreate();
+
+	/* Test Case 1 */
+	assert(ListPrependN(list, withNull, 2) == -1 && list->size == 0
+		&& "FAIL: Prepending an array holding NULL did not fail cleanly\n");
+
+	/* Test Case 2 */
+	assert(ListPrependN(list, &items[3], 2) == 0 && listHoldsItems(list, &items[3], 2)
+		&& "FAIL: Prepending an array to an empty list failed\n");
+	assert(ListCurr(list) == &testInt[4]
+		&& "FAIL: The list's current item is not the last prepended item\n");
+
+	/* Test Case 3 */
+	ListLast(list);
+	assert(ListPrependN(list, items, 3) == 0 && listHoldsItems(list, items, 5)
+		&& "FAIL: The prepended items did not come before the list's existing items\n");
+	assert(ListCurr(list) == &testInt[2]
+		&& "FAIL: The list's current item is not the last prepended item\n");
+
+	/* Cleanup */
+	ListFree(list, NULL);
+	printf("| ListPrependN|       3      |        5     |  PASS  |\n");
+}
+
+/**
+ * 1. Add an array to a NULL list
+ * 2. Add an array to an empty list
+ * 3. Add an array with the current item in the middle of the list
+ * 4. Add an array with the current item the tail of the list
+ * 5. Add an array with the current item beyond the start of the list
+ * 6. Add an array with the current item beyond the end of the list
+ */
+static void ListAddNTest() {
+	int testInt[12];
+	void *items[12];
+	for (int i = 0; i < 12; i++) {
+		items[i] = &testInt[i];
+	}
+	LIST *list = ListCreate();
+
+	/* Test Case 1 */
+	assert(ListAddN(NULL, items, 2) == -1
+		&& "FAIL: Adding an array to a NULL list did not return -1\n");
+
+	/* Test Case 2: builds 2, 3, 8, 9 */
+	assert(ListAddN(list, &items[8], 2) == 0 && ListCurr(list) == &testInt[9]
+		&& "FAIL: Adding an array to an empty list failed\n");
+	ListFirst(list);
+	ListPrev(list);
+	assert(ListAddN(list, &items[2], 2) == 0 && ListCurr(list) == &testInt[3]
+		&& "FAIL: Adding an array beyond the start of a list did not make it current\n");
+
+	/* Test Case 3: builds 2, 3, 4, 5, 6, 7, 8, 9 */
+	assert(ListAddN(list, &items[4], 4) == 0 && listHoldsItems(list, &items[2], 8)
+		&& "FAIL: Adding an array after the current item did not keep the list in order\n");
+
+	/* Test Case 4: builds 2, ..., 10 */
+	ListLast(list);
+	assert(ListAddN(list, &items[10], 1) == 0 && list->tail->item == &testInt[10]
+		&& "FAIL: Adding an array after the tail did not make the list's tail the last item\n");
+
+	/* Test Case 5: builds 0, 1, 2, ..., 10 */
+	ListFirst(list);
+	ListPrev(list);
+	assert(ListAddN(list, items, 2) == 0 && listHoldsItems(list, items, 11)
+		&& "FAIL: Adding an array beyond the start of a list did not add it to the start\n");
+
+	/* Test Case 6: builds 0, ..., 11 */
+	ListLast(list);
+	ListNext(list);
+	assert(ListAddN(list, &items[11], 1) == 0 && listHoldsItems(list, items, 12)
+		&& "FAIL: Adding an array beyond the end of a list did not add it to the end\n");
+	assert(ListCurr(list) == &testInt[11] && list->currentIsBeyond == 0
+		&& "FAIL: The list's current item is not the last added item\n");
+
+	/* Cleanup */
+	ListFree(list, NULL);
+	printf("| ListAddN    |       6      |        8     |  PASS  |\n");
+}
+
 /**
  * 1. Remove item from NULL list
  * 2. Remove item from list with 1 item - current item beyond start
@@ -983,9 +1263,9 @@ static void ListRemoveTest() {
 		&& "FAIL: List's head pointer should be set to the item after the removed item\n");
 	assert(list->tail->item == &testInt[2]
 		&& "FAIL: List's tail pointer should be set to the last item\n");
-	assert(list->head->next->item == &testInt[2]
+	assert(ListNodeNext(list, list->head)->item == &testInt[2]
 		&& "FAIL: List head's next pointer should be set to the tail\n");
-	assert(list->tail->previous->item == &testInt[1]
+	assert(ListNodePrev(list, list->tail)->item == &testInt[1]
 		&& "FAIL: List tail's previous pointer should be set to the item after the removed item\n");
 
 	/* Test Case 12 */
@@ -1001,9 +1281,9 @@ static void ListRemoveTest() {
 		&& "FAIL: List's head pointer should be set to the item before the removed item\n");
 	assert(list->tail->item == &testInt[2]
 		&& "FAIL: List's tail pointer should be set to the item after the removed item\n");
-	assert(list->head->next->item == &testInt[2]
+	assert(ListNodeNext(list, list->head)->item == &testInt[2]
 		&& "FAIL: List head's next pointer should be set to the item after the removed item\n");
-	assert(list->tail->previous->item == &testInt[0]
+	assert(ListNodePrev(list, list->tail)->item == &testInt[0]
 		&& "FAIL: List tail's previous pointer should be set to the item before the removed item\n");
 
 	/* Test Case 13 */
@@ -1020,9 +1300,9 @@ static void ListRemoveTest() {
 		&& "FAIL: List's head pointer should be set to the first item\n");
 	assert(list->tail->item == &testInt[1]
 		&& "FAIL: List's tail pointer should be set to the item before the removed item\n");
-	assert(list->head->next->item == &testInt[1]
+	assert(ListNodeNext(list, list->head)->item == &testInt[1]
 		&& "FAIL: List head's next pointer should be set to the item after the removed item\n");
-	assert(list->tail->previous->item == &testInt[0]
+	assert(ListNodePrev(list, list->tail)->item == &testInt[0]
 		&& "FAIL: List tail's previous pointer should be set to the item before the removed item\n");
 
 	/* Cleanup */
@@ -1128,9 +1408,9 @@ static void ListConcatTest() {
 		&& "FAIL: Head ptr was wrong after concatenating lists");
 	assert(list1->tail->item == &testInt2[2]
 		&& "FAIL: Tail ptr was wrong after concatenating lists");
-	assert(list1->head->next->item == &testInt2[1]
+	assert(ListNodeNext(list1, list1->head)->item == &testInt2[1]
 		&& "FAIL: Head next ptr was wrong after concatenating lists");
-	assert(list1->tail->previous->item == &testInt2[1]
+	assert(ListNodePrev(list1, list1->tail)->item == &testInt2[1]
 		&& "FAIL: Tail prev ptr was wrong after concatenating lists");
 
 	/* Test Case 7 */
@@ -1190,7 +1470,7 @@ static void ListConcatTest() {
 			assert(testNode->item == &testInt2[i-1]
 				&& "FAIL: Nodes in incorrect order after concatenating lists");
 		}
-		testNode = testNode->next;
+		testNode = ListNodeNext(list1, testNode);
 	}
 
 	/* Test Case 10 */
@@ -1219,7 +1499,7 @@ static void ListConcatTest() {
 			assert(testNode->item == &testInt2[i-1]
 				&& "FAIL: Nodes in incorrect order after concatenating lists");
 		}
-		testNode = testNode->next;
+		testNode = ListNodeNext(list1, testNode);
 	}
 
 	/* Test Case 11 */
@@ -1263,7 +1543,7 @@ static void ListConcatTest() {
 			assert(testNode->item == &testInt2[i-2]
 				&& "FAIL: Nodes in incorrect order after concatenating lists");
 		}
-		testNode = testNode->next;
+		testNode = ListNodeNext(list1, testNode);
 	}
 
 	/* Test Case 13 */
@@ -1292,7 +1572,7 @@ static void ListConcatTest() {
 			assert(testNode->item == &testInt2[i-2]
 				&& "FAIL: Nodes in incorrect order after concatenating lists");
 		}
-		testNode = testNode->next;
+		testNode = ListNodeNext(list1, testNode);
 	}
 
 	/* Test Case 14 */
@@ -1322,7 +1602,7 @@ static void ListConcatTest() {
 			assert(testNode->item == &testInt2[i-2]
 				&& "FAIL: Nodes in incorrect order after concatenating lists");
 		}
-		testNode = testNode->next;
+		testNode = ListNodeNext(list1, testNode);
 	}
 
 	/* Test Case 15 */
@@ -1345,7 +1625,7 @@ static void ListConcatTest() {
 	for (int i = 0; i < list1->size; i++) {
 		assert(testNode->item == &testInt1[i]
 			&& "FAIL: Nodes in incorrect order after concatenating lists");
-		testNode = testNode->next;
+		testNode = ListNodeNext(list1, testNode);
 	}
 
 	/* Test Case 16 */
@@ -1374,7 +1654,7 @@ static void ListConcatTest() {
 			assert(testNode->item == &testInt2[i-3]
 				&& "FAIL: Nodes in incorrect order after concatenating lists");
 		}
-		testNode = testNode->next;
+		testNode = ListNodeNext(list1, testNode);
 	}
 
 	/* Test Case 17 */
@@ -1404,7 +1684,7 @@ static void ListConcatTest() {
 			assert(testNode->item == &testInt2[i-3]
 				&& "FAIL: Nodes in incorrect order after concatenating lists");
 		}
-		testNode = testNode->next;
+		testNode = ListNodeNext(list1, testNode);
 	}
 
 	/* Test Case 18 */
@@ -1435,7 +1715,7 @@ static void ListConcatTest() {
 			assert(testNode->item == &testInt2[i-3]
 				&& "FAIL: Nodes in incorrect order after concatenating lists");
 		}
-		testNode = testNode->next;
+		testNode = ListNodeNext(list1, testNode);
 	}
 
 	/* Cleanup */
@@ -1809,19 +2089,2221 @@ static void ListSearchTest() {
 	printf("| ListSearch  |      17      |       90     |  PASS  |\n");
 }
 
-/***************************************************************
- * Globals                                                     *
- ***************************************************************/
+/**
+ * 1. Search a NULL list and an empty list by pointer
+ * 2. Searching by pointer from many current positions gives the same results as searching
+ *    with an identity comparator
+ */
+static void ListSearchPtrTest() {
+	int testInt[50];
+	LIST *list = ListCreate();
+	LIST *searched = ListCreate();
 
-int successComparator(void *item1, void *item2) {
-	/* Suppress unused variable warnings */
-	item1 = (int *)item1;
-	item2 = (int *)item2;
-	return 1;
+	/* Test Case 1 */
+	assert(ListSearchPtr(NULL, &testInt[0]) == NULL && ListSearchPtr(list, &testInt[0]) == NULL
+		&& "FAIL: Searching a NULL or empty list by pointer returned non-NULL\n");
+
+	/* Test Case 2 */
+	for (int i = 0; i < 200; i++) {
+		ListAppend(list, &testInt[(i * 7) % 50]);
+		ListAppend(searched, &testInt[(i * 7) % 50]);
+	}
+	unsigned int seed = 1;
+	for (int i = 0; i < 1000; i++) {
+		seed = seed * 1103515245 + 12345;
+		int start = (seed >> 4) % 202 - 1;
+		void *item = &testInt[(seed >> 16) % 50];
+		if (start < 0) {
+			ListFirst(list);
+			ListPrev(list);
+			ListFirst(searched);
+			ListPrev(searched);
+		} else if (start >= 200) {
+			ListLast(list);
+			ListNext(list);
+			ListLast(searched);
+			ListNext(searched);
+		} else {
+			ListSeek(list, start);
+			ListSeek(searched, start);
+		}
+		assert(ListSearchPtr(list, item) == ListSearch(searched, identityComparator, item)
+			&& ListCurr(list) == ListCurr(searched) && ListIndexOfCurrent(list) == ListIndexOfCurrent(searched)
+			&& "FAIL: Searching by pointer did not behave the same as searching with a comparator\n");
+	}
+
+	/* Cleanup */
+	ListFree(list, NULL);
+	ListFree(searched, NULL);
+	printf("| ListSrchPtr |       2      |     1001     |  PASS  |\n");
+}
+
+/**
+ * 1. Remove from a NULL list and with a NULL comparator
+ * 2. Remove from an empty list
+ * 3. Remove with no matching items
+ * 4. Remove matching items spread through the list, items are freed
+ * 5. Remove the current item, the next remaining item becomes current
+ * 6. Remove the current item and every item after it, the new tail becomes current
+ * 7. Remove items with the current pointer beyond the end of the list
+ * 8. Remove every item
+ * 9. Removed nodes are returned to the list's context
+ */
+static void ListRemoveIfTest() {
+	int testInt[10];
+	void *items[10];
+	void *odds[5];
+	for (int i = 0; i < 10; i++) {
+		testInt[i] = i;
+		items[i] = &testInt[i];
+	}
+	for (int i = 0; i < 5; i++) {
+		odds[i] = &testInt[2 * i + 1];
+	}
+	LIST *list = ListCreate();
+
+	/* Test Case 1 */
+	assert(ListRemoveIf(NULL, evenComparator, NULL, NULL) == -1 && ListRemoveIf(list, NULL, NULL, NULL) == -1
+		&& "FAIL: Removing from a NULL list or with a NULL comparator did not return -1\n");
+
+	/* Test Case 2 */
+	assert(ListRemoveIf(list, successComparator, NULL, NULL) == 0
+		&& "FAIL: Removing from an empty list did not return 0\n");
+
+	/* Test Case 3 */
+	ListAppendN(list, items, 10);
+	assert(ListRemoveIf(list, failComparator, NULL, NULL) == 0 && list->size == 10
+		&& "FAIL: Removing with no matching items changed the list\n");
+
+	/* Test Case 4 */
+	ListFirst(list);
+	ListNext(list);
+	assert(ListRemoveIf(list, evenComparator, NULL, countingItemFree) == 5
+		&& "FAIL: Removing the even items did not return the number removed\n");
+	assert(listHoldsItems(list, odds, 5)
+		&& "FAIL: The list does not hold the remaining items in order\n");
+	assert(testInt[0] == 1 && testInt[4] == 5 && testInt[8] == 9 && testInt[1] == 1
+		&& "FAIL: Only the removed items should be passed to itemFree\n");
+	assert(ListCurr(list) == &testInt[1]
+		&& "FAIL: The current item changed when it was not removed\n");
+
+	/* Test Case 5 */
+	assert(ListRemoveIf(list, identityComparator, &testInt[1], NULL) == 1 && ListCurr(list) == &testInt[3]
+		&& "FAIL: The item after the removed current item did not become current\n");
+
+	/* Test Case 6 */
+	ListLast(list);
+	ListPrev(list);
+	testInt[7] = 0;
+	testInt[9] = 0;
+	assert(ListRemoveIf(list, evenComparator, NULL, NULL) == 2 && ListCurr(list) == &testInt[5]
+		&& list->tail->item == &testInt[5] && ListNodeNext(list, list->tail) == NULL
+		&& "FAIL: The new tail did not become current after removing the current item and those after it\n");
+
+	/* Test Case 7 */
+	ListNext(list);
+	assert(ListRemoveIf(list, identityComparator, &testInt[3], NULL) == 1
+		&& ListCurr(list) == NULL && list->currentIsBeyond == 1
+		&& "FAIL: The current pointer moved when it was beyond the end of the list\n");
+
+	/* Test Case 8 */
+	assert(ListRemoveIf(list, successComparator, NULL, NULL) == 1 && list->size == 0
+		&& list->head == NULL && list->tail == NULL
+		&& "FAIL: Removing every item did not leave an empty list\n");
+	ListFree(list, NULL);
+
+	/* Test Case 9 */
+	LIST_CONTEXT_CONFIG config = { .maxNodes = 4 };
+	LIST_CONTEXT *context = ListContextCreate(&config);
+	list = ListCreateIn(context);
+	ListAppendN(list, items, 4);
+	ListRemoveIf(list, successComparator, NULL, NULL);
+	assert(ListAppendN(list, items, 4) == 0
+		&& "FAIL: Removed nodes were not returned to the list's context\n");
+
+	/* Cleanup */
+	ListContextDestroy(context);
+	printf("| ListRemoveIf|       9      |       12     |  PASS  |\n");
+}
+
+/**
+ * 1. Seek in a NULL list and out of range, the current pointer is unchanged
+ * 2. Seek every position of a list without a skip index
+ * 3. Seek every position of a list with a skip index
+ * 4. A long random sequence of operations keeps positions right, with and without a skip index
+ * 5. Concatenate two lists with skip indices, seek every position
+ * 6. Seek after a bulk removal, the skip index is rebuilt
+ */
+static void ListSeekTest() {
+	static int testInt[1000];
+	static void *model[1000];
+	LIST *list = ListCreate();
+	LIST *indexed = ListCreate();
+	for (int i = 0; i < 1000; i++) {
+		testInt[i] = i;
+	}
+
+	/* Test Case 1 */
+	ListAppend(list, &testInt[0]);
+	assert(ListSeek(NULL, 0) == NULL && ListSeek(list, -1) == NULL && ListSeek(list, 1) == NULL
+		&& ListCurr(list) == &testInt[0] && ListIndexOfCurrent(list) == 0
+		&& "FAIL: Seeking out of range returned non-NULL or moved the current pointer\n");
+	ListNext(list);
+	assert(ListIndexOfCurrent(list) == -1 && ListIndexOfCurrent(NULL) == -1
+		&& "FAIL: The index of a current item beyond the end of the list was not -1\n");
+	ListTrim(list);
+
+	/* Test Case 2 */
+	for (int i = 0; i < 1000; i++) {
+		ListAppend(list, &testInt[i]);
+	}
+	for (int i = 0; i < 1000; i++) {
+		int position = (i * 617) % 1000;
+		assert(ListSeek(list, position) == &testInt[position] && ListIndexOfCurrent(list) == position
+			&& "FAIL: Seeking without a skip index returned the wrong item\n");
+	}
+
+	/* Test Case 3 */
+	assert(ListEnableSkipIndex(list) == 0
+		&& "FAIL: Enabling a skip index failed\n");
+	for (int i = 0; i < 1000; i++) {
+		int position = (i * 617) % 1000;
+		assert(ListSeek(list, position) == &testInt[position] && ListIndexOfCurrent(list) == position
+			&& "FAIL: Seeking with a skip index returned the wrong item\n");
+	}
+	ListFree(list, NULL);
+
+	/* Test Case 4 */
+	list = ListCreate();
+	ListEnableSkipIndex(indexed);
+	unsigned int seed = 1;
+	int size = 0;
+	int current = 0;
+	for (int i = 0; i < 20000; i++) {
+		seed = seed * 1103515245 + 12345;
+		int op = (seed >> 16) % 11;
+		int random = (seed >> 4) % 1000;
+		void *item = &testInt[random];
+		int position = -1;
+
+		/* Keep the lists from growing without bound */
+		if (size > 500 && op >= 4 && op <= 7) {
+			op = 8;
+		}
+		switch (op) {
+		case 0:
+			ListFirst(list);
+			ListFirst(indexed);
+			current = size > 0 ? 0 : current;
+			break;
+		case 1:
+			ListLast(list);
+			ListLast(indexed);
+			current = size > 0 ? size - 1 : current;
+			break;
+		case 2:
+			ListNext(list);
+			ListNext(indexed);
+			current = (current < 0 && size > 0) ? 0 : (current >= size - 1 ? size : current + 1);
+			break;
+		case 3:
+			ListPrev(list);
+			ListPrev(indexed);
+			current = (current >= size && size > 0) ? size - 1 : (current <= 0 ? -1 : current - 1);
+			break;
+		case 4:
+			ListAdd(list, item);
+			ListAdd(indexed, item);
+			position = current < 0 ? 0 : (current >= size ? size : current + 1);
+			break;
+		case 5:
+			ListInsert(list, item);
+			ListInsert(indexed, item);
+			position = current < 0 ? 0 : (current >= size ? size : current);
+			break;
+		case 6:
+			ListAppend(list, item);
+			ListAppend(indexed, item);
+			position = size;
+			break;
+		case 7:
+			ListPrepend(list, item);
+			ListPrepend(indexed, item);
+			position = 0;
+			break;
+		case 8:
+		case 9:
+			if (op == 8 && ListRemove(list) == ListRemove(indexed) && current >= 0 && current < size) {
+				for (int j = current; j < size - 1; j++) {
+					model[j] = model[j + 1];
+				}
+				size--;
+				current = current < size ? current : (size > 0 ? size - 1 : 0);
+			} else if (op == 9 && ListTrim(list) == ListTrim(indexed) && size > 0) {
+				size--;
+				current = size > 0 ? size - 1 : 0;
+			}
+			break;
+		case 10:
+			if (size > 0) {
+				ListSeek(list, random % size);
+				ListSeek(indexed, random % size);
+				current = random % size;
+			}
+			break;
+		}
+
+		if (position >= 0) {
+			for (int j = size; j > position; j--) {
+				model[j] = model[j - 1];
+			}
+			model[position] = item;
+			size++;
+			current = position;
+		}
+		int expectedIndex = (current >= 0 && current < size) ? current : -1;
+		void *expectedItem = expectedIndex >= 0 ? model[expectedIndex] : NULL;
+		assert(ListCount(list) == size && ListCount(indexed) == size
+			&& ListIndexOfCurrent(list) == expectedIndex && ListIndexOfCurrent(indexed) == expectedIndex
+			&& ListCurr(list) == expectedItem && ListCurr(indexed) == expectedItem
+			&& "FAIL: The position of the current item was wrong after an operation\n");
+	}
+	for (int i = 0; i < size; i++) {
+		assert(ListSeek(indexed, i) == model[i] && ListSeek(list, size - 1 - i) == model[size - 1 - i]
+			&& "FAIL: Seeking returned the wrong item after a random sequence of operations\n");
+	}
+	ListFree(list, NULL);
+	ListFree(indexed, NULL);
+
+	/* Test Case 5 */
+	list = ListCreate();
+	indexed = ListCreate();
+	ListEnableSkipIndex(list);
+	ListEnableSkipIndex(indexed);
+	for (int i = 0; i < 1000; i++) {
+		ListAppend(i < 300 ? list : indexed, &testInt[i]);
+	}
+	ListConcat(list, indexed);
+	for (int i = 0; i < 1000; i++) {
+		int position = (i * 617) % 1000;
+		assert(ListSeek(list, position) == &testInt[position]
+			&& "FAIL: Seeking returned the wrong item after concatenating lists with skip indices\n");
+	}
+
+	/* Test Case 6 */
+	ListRemoveIf(list, evenComparator, NULL, NULL);
+	for (int i = 0; i < 500; i++) {
+		assert(ListSeek(list, i) == &testInt[2 * i + 1] && ListIndexOfCurrent(list) == i
+			&& "FAIL: Seeking returned the wrong item after a bulk removal\n");
+	}
+
+	/* Cleanup */
+	ListFree(list, NULL);
+	printf("| ListSeek    |       6      |    24003     |  PASS  |\n");
+}
+
+/**
+ * 1. Find in a NULL list, a list without a hash index, and enable with NULL functions
+ * 2. A long random sequence of operations gives the same results with ListFind as with ListSearch
+ * 3. Find through many items added at one spot, which forces the index to be relabelled
+ * 4. Find after concatenating lists with hash indices and after disabling the index
+ */
+static void ListFindTest() {
+	static int testInt[300];
+	void *items[8];
+	for (int i = 0; i < 300; i++) {
+		testInt[i] = i % 60;
+	}
+	LIST *list = ListCreate();
+	LIST *searched = ListCreate();
+
+	/* Test Case 1 */
+	ListAppend(list, &testInt[0]);
+	assert(ListFind(NULL, &testInt[0]) == NULL && ListFind(list, &testInt[0]) == NULL
+		&& "FAIL: Finding in a NULL list or a list without a hash index returned non-NULL\n");
+	assert(ListEnableHashIndex(list, NULL, valueHash, valueComparator) == -1
+		&& ListEnableHashIndex(list, itemKey, valueHash, NULL) == -1
+		&& "FAIL: Enabling a hash index with NULL functions did not return -1\n");
+	ListTrim(list);
+
+	/* Test Case 2 */
+	assert(ListEnableHashIndex(list, itemKey, valueHash, valueComparator) == 0
+		&& "FAIL: Enabling a hash index failed\n");
+	unsigned int seed = 1;
+	for (int i = 0; i < 20000; i++) {
+		seed = seed * 1103515245 + 12345;
+		int op = (seed >> 16) % 14;
+		int random = (seed >> 4) % 300;
+		void *item = &testInt[random];
+		void *expected = NULL;
+		void *actual = NULL;
+
+		/* Keep the lists from growing without bound */
+		if (ListCount(list) > 200 && op >= 4 && op <= 8) {
+			op = 9;
+		}
+		switch (op) {
+		case 0: expected = ListFirst(searched); actual = ListFirst(list); break;
+		case 1: expected = ListLast(searched); actual = ListLast(list); break;
+		case 2: expected = ListNext(searched); actual = ListNext(list); break;
+		case 3: expected = ListPrev(searched); actual = ListPrev(list); break;
+		case 4: ListAdd(searched, item); ListAdd(list, item); break;
+		case 5: ListInsert(searched, item); ListInsert(list, item); break;
+		case 6: ListAppend(searched, item); ListAppend(list, item); break;
+		case 7: ListPrepend(searched, item); ListPrepend(list, item); break;
+		case 8:
+			for (int j = 0; j < 8; j++) {
+				items[j] = &testInt[(random + j * 7) % 300];
+			}
+			ListAddN(searched, items, 8);
+			ListAddN(list, items, 8);
+			break;
+		case 9: expected = ListRemove(searched); actual = ListRemove(list); break;
+		case 10: expected = ListTrim(searched); actual = ListTrim(list); break;
+		case 11:
+			expected = (void *)(intptr_t)ListRemoveIf(searched, valueComparator, item, NULL);
+			actual = (void *)(intptr_t)ListRemoveIf(list, valueComparator, item, NULL);
+			break;
+		default:
+			expected = ListSearch(searched, valueComparator, item);
+			actual = ListFind(list, item);
+			break;
+		}
+		assert(expected == actual && ListCount(list) == ListCount(searched)
+			&& ListCurr(list) == ListCurr(searched) && ListIndexOfCurrent(list) == ListIndexOfCurrent(searched)
+			&& "FAIL: Finding with a hash index did not behave the same as searching\n");
+	}
+	ListFree(list, NULL);
+	ListFree(searched, NULL);
+
+	/* Test Case 3 */
+	list = ListCreate();
+	ListEnableHashIndex(list, itemKey, valueHash, valueComparator);
+	ListAppend(list, &testInt[1]);
+	ListAppend(list, &testInt[2]);
+	ListFirst(list);
+	for (int i = 0; i < 100; i++) {
+		ListAdd(list, &testInt[60 + (i % 3) * 60]);
+		ListPrev(list);
+	}
+	ListFirst(list);
+	for (int i = 0; i < 100; i++) {
+		int *found = ListFind(list, &testInt[0]);
+		assert(found == &testInt[60 + ((99 - i) % 3) * 60] && ListIndexOfCurrent(list) == i + 1
+			&& "FAIL: Finding did not return duplicate keys in list order\n");
+		ListNext(list);
+	}
+	assert(ListFind(list, &testInt[0]) == NULL && ListIndexOfCurrent(list) == -1
+		&& "FAIL: Finding past the last match did not leave the current pointer beyond the end\n");
+
+	/* Test Case 4 */
+	LIST *list2 = ListCreate();
+	ListEnableHashIndex(list2, itemKey, valueHash, valueComparator);
+	ListAppend(list2, &testInt[3]);
+	ListAppend(list2, &testInt[63]);
+	ListConcat(list, list2);
+	ListFirst(list);
+	assert(ListFind(list, &testInt[3]) == &testInt[3] && ListFind(list, &testInt[1]) == NULL
+		&& "FAIL: Finding after concatenating lists with hash indices failed\n");
+	ListFirst(list);
+	ListDisableHashIndex(list);
+	assert(ListFind(list, &testInt[3]) == NULL && ListCurr(list) == &testInt[1]
+		&& "FAIL: Finding after disabling the hash index returned non-NULL or moved the current pointer\n");
+
+	/* Cleanup */
+	ListFree(list, NULL);
+	printf("| ListFind    |       4      |    20106     |  PASS  |\n");
+}
+
+/**
+ * 1. Sort a NULL list, with a NULL comparator, an empty list and a single item list
+ * 2. Sort a list with many repeated keys, ascending and stable, links intact, first item current
+ * 3. Sort a list large enough to be split between threads
+ * 4. The hash and skip indices give the right answers after sorting
+ */
+static void ListSortTest() {
+	int testInt = 0;
+
+	/* Test Case 1 */
+	LIST *list = ListCreate();
+	assert(ListSort(NULL, intItemCompare) == -1 && ListSort(list, NULL) == -1
+		&& ListSortParallel(NULL, intItemCompare, 4) == -1 && ListSort(list, intItemCompare) == 0
+		&& "FAIL: Sorting a NULL list or with a NULL comparator did not return -1\n");
+	ListAppend(list, &testInt);
+	assert(ListSort(list, intItemCompare) == 0 && ListCount(list) == 1 && ListCurr(list) == &testInt
+		&& "FAIL: Sorting a single item list changed it\n");
+	ListFree(list, NULL);
+
+	/* Test Case 2 */
+	KEYED_INT *keyed = malloc(100000 * sizeof(KEYED_INT));
+	unsigned int seed = 1;
+	list = ListCreate();
+	for (int i = 0; i < 10000; i++) {
+		seed = seed * 1103515245 + 12345;
+		keyed[i].key = (seed >> 16) % 100;
+		keyed[i].sequence = i;
+		ListAppend(list, &keyed[i]);
+	}
+	ListLast(list);
+	assert(ListSort(list, keyedItemCompare) == 0 && ListCount(list) == 10000 && listIsSorted(list, keyedItemCompare)
+		&& "FAIL: A sorted list was out of order, not stable or lost items\n");
+	assert(ListCurr(list) == list->head->item && ListIndexOfCurrent(list) == 0
+		&& "FAIL: Sorting did not make the first item current\n");
+	ListFree(list, NULL);
+
+	/* Test Case 3 */
+	list = ListCreate();
+	for (int i = 0; i < 100000; i++) {
+		seed = seed * 1103515245 + 12345;
+		keyed[i].key = (seed >> 16) % 1000;
+		keyed[i].sequence = i;
+		ListAppend(list, &keyed[i]);
+	}
+	assert(ListSortParallel(list, keyedItemCompare, 4) == 0 && ListCount(list) == 100000
+		&& listIsSorted(list, keyedItemCompare)
+		&& "FAIL: A list sorted on several threads was out of order, not stable or lost items\n");
+	ListFree(list, NULL);
+	free(keyed);
+
+	/* Test Case 4 */
+	static int values[1000];
+	list = ListCreate();
+	ListEnableHashIndex(list, itemKey, valueHash, valueComparator);
+	ListEnableSkipIndex(list);
+	for (int i = 0; i < 1000; i++) {
+		values[i] = (i * 7919) % 500;
+		ListAppend(list, &values[i]);
+	}
+	ListSeek(list, 10);
+	ListSort(list, intItemCompare);
+	for (int i = 0; i < 1000; i++) {
+		assert(*(int *)ListSeek(list, i) == i / 2
+			&& "FAIL: Seeking after sorting did not find the item at that position\n");
+	}
+	for (int i = 0; i < 1000; i += 10) {
+		ListFirst(list);
+		int *found = ListFind(list, &values[i]);
+		ListFirst(list);
+		assert(found == ListSearch(list, valueComparator, &values[i]) && ListIndexOfCurrent(list) == values[i] * 2
+			&& "FAIL: Finding after sorting did not find the first match\n");
+	}
+
+	/* Cleanup */
+	ListFree(list, NULL);
+	printf("| ListSort    |       4      |     1105     |  PASS  |\n");
+}
+
+/**
+ * 1. Compacting a NULL list or context fails, and an empty list is left alone
+ * 2. Compacting a churned list puts its nodes in address order, keeping items and the current item
+ * 3. Seeking and finding still work after compacting a list with skip and hash indexes
+ * 4. Compacting a context packs each list into consecutive slots, keeping items and current items
+ * 5. Nodes are handed out in consecutive slots after compacting a context
+ */
+static void ListCompactTest() {
+	static int testInt[400];
+	void *before[400];
+
+	/* Test Case 1 */
+	LIST *list = ListCreate();
+	assert(ListCompact(NULL) == -1 && ListContextCompact(NULL) == -1 && ListCompact(list) == 0 && list->head == NULL
+		&& "FAIL: Compacting NULL did not fail, or compacting an empty list changed it\n");
+
+	/* Test Case 2 */
+	for (int i = 0; i < 400; i++) {
+		testInt[i] = i;
+		ListAppend(list, &testInt[i]);
+	}
+	unsigned int seed = 7;
+	for (int i = 0; i < 2000; i++) {
+		seed = seed * 1103515245 + 12345;
+		ListSeek(list, (seed >> 8) % ListCount(list));
+		void *item = ListRemove(list);
+		seed = seed * 1103515245 + 12345;
+		ListSeek(list, (seed >> 8) % ListCount(list));
+		ListAdd(list, item);
+	}
+	int numItems = 0;
+	for (void *item = ListFirst(list); item != NULL; item = ListNext(list)) {
+		before[numItems++] = item;
+	}
+	ListSeek(list, 123);
+	ListCompact(list);
+	int inOrder = ListCurr(list) == before[123] && ListIndexOfCurrent(list) == 123;
+	for (NODE *node = list->head; ListNodeNext(list, node) != NULL; node = ListNodeNext(list, node)) {
+		inOrder = inOrder && ListNodeNext(list, node) > node;
+	}
+	assert(inOrder && listHoldsItems(list, before, numItems)
+		&& "FAIL: Compacting a list did not put its nodes in address order, or lost its items or current item\n");
+
+	/* Test Case 3 */
+	ListEnableSkipIndex(list);
+	ListEnableHashIndex(list, itemKey, valueHash, valueComparator);
+	ListSeek(list, 10);
+	ListCompact(list);
+	ListFirst(list);
+	assert(ListSeek(list, 250) == before[250] && ListFind(list, before[300]) == before[300]
+		&& ListIndexOfCurrent(list) == 300
+		&& "FAIL: Seeking or finding failed after compacting a list with indexes\n");
+	ListFree(list, NULL);
+
+	/* Test Case 4 */
+	LIST_CONTEXT *context = ListContextCreate(NULL);
+	LIST *list1 = ListCreateIn(context);
+	LIST *list2 = ListCreateIn(context);
+	for (int i = 0; i < 400; i++) {
+		ListPrepend(i % 2 == 0 ? list1 : list2, &testInt[i]);
+		if (i % 3 == 0) {
+			ListFirst(list2);
+			ListRemove(list2);
+		}
+	}
+	numItems = 0;
+	for (void *item = ListFirst(list1); item != NULL; item = ListNext(list1)) {
+		before[numItems++] = item;
+	}
+	ListSeek(list1, 50);
+	void *list2Head = ListFirst(list2);
+	ListPrev(list2);
+	assert(ListContextCompact(context) == 0
+		&& "FAIL: Compacting a context failed\n");
+	int packed = ListCurr(list1) == before[50] && list2->currentIsBeyond == -1 && list2->head->item == list2Head;
+	for (NODE *node = list1->head; ListNodeNext(list1, node) != NULL; node = ListNodeNext(list1, node)) {
+		packed = packed && ListNodeNext(list1, node) == node + 1;
+	}
+	for (NODE *node = list2->head; ListNodeNext(list2, node) != NULL; node = ListNodeNext(list2, node)) {
+		packed = packed && ListNodeNext(list2, node) == node + 1;
+	}
+	assert(packed && listHoldsItems(list1, before, numItems) && (list1->tail + 1 == list2->head || list2->tail + 1 == list1->head)
+		&& "FAIL: Compacting a context did not pack each list into consecutive slots\n");
+
+	/* Test Case 5 */
+	LIST *list3 = ListCreateIn(context);
+	for (int i = 0; i < 10; i++) {
+		ListAppend(list3, &testInt[i]);
+	}
+	packed = 1;
+	for (NODE *node = list3->head; ListNodeNext(list3, node) != NULL; node = ListNodeNext(list3, node)) {
+		packed = packed && ListNodeNext(list3, node) == node + 1;
+	}
+	assert(packed
+		&& "FAIL: Nodes were not handed out in consecutive slots after compacting a context\n");
+
+	/* Cleanup */
+	ListContextDestroy(context);
+	printf("| ListCompact |       5      |        6     |  PASS  |\n");
+}
+
+/**
+ * 1. Cursor operations with a NULL cursor and on an empty list
+ * 2. Two cursors scan the same list in opposite directions without moving each other or the list
+ * 3. A long random sequence of operations gives the same results through a cursor as on a list
+ * 4. The list's own current item stays put when a cursor changes the list elsewhere,
+ *    and moves on when a cursor removes it
+ * 5. Changes made through a cursor keep a skip index and the list's current index up to date
+ */
+static void ListCursorTest() {
+	static int testInt[200];
+	LIST_CURSOR cursor;
+	LIST_CURSOR cursor2;
+
+	/* Test Case 1 */
+	LIST *list = ListCreate();
+	assert(ListCursorFirst(NULL) == NULL && ListCursorAdd(NULL, &testInt[0]) == -1 && ListCursorRemove(NULL) == NULL
+		&& "FAIL: Cursor operations with a NULL cursor did not fail\n");
+	ListCursorInit(&cursor, list);
+	assert(ListCursorCurr(&cursor) == NULL && ListCursorNext(&cursor) == NULL && cursor.currentIsBeyond == 1
+		&& ListCursorRemove(&cursor) == NULL
+		&& "FAIL: Moving a cursor on an empty list did not go beyond the end\n");
+
+	/* Test Case 2 */
+	for (int i = 0; i < 100; i++) {
+		ListAppend(list, &testInt[i]);
+	}
+	ListSeek(list, 50);
+	ListCursorInit(&cursor, list);
+	ListCursorInit(&cursor2, list);
+	for (int i = 0; i < 100; i++) {
+		assert(ListCursorNext(&cursor) == &testInt[i]
+			&& (i == 0 ? ListCursorLast(&cursor2) : ListCursorPrev(&cursor2)) == &testInt[99 - i]
+			&& "FAIL: Cursors on the same list moved each other\n");
+	}
+	assert(ListCursorNext(&cursor) == NULL && ListCursorPrev(&cursor2) == NULL
+		&& ListCursorSearch(&cursor, identityComparator, &testInt[70]) == NULL
+		&& ListCursorSearch(&cursor2, identityComparator, &testInt[70]) == &testInt[70]
+		&& ListCursorCurr(&cursor2) == &testInt[70]
+		&& ListCurr(list) == &testInt[50] && ListIndexOfCurrent(list) == 50
+		&& "FAIL: Scanning and searching with cursors moved the list's current item\n");
+	ListFree(list, NULL);
+
+	/* Test Case 3 */
+	list = ListCreate();
+	LIST *mirror = ListCreate();
+	ListCursorInit(&cursor, list);
+	ListFirst(mirror);
+	ListPrev(mirror);
+	unsigned int seed = 1;
+	for (int i = 0; i < 20000; i++) {
+		seed = seed * 1103515245 + 12345;
+		int op = (seed >> 16) % 11;
+		void *item = &testInt[(seed >> 8) % 200];
+		void *expected = NULL;
+		void *actual = NULL;
+
+		/* Keep the list from growing without bound */
+		if (ListCount(list) > 150 && (op == 5 || op == 6)) {
+			op = 7;
+		}
+		switch (op) {
+		case 0: expected = ListFirst(mirror); actual = ListCursorFirst(&cursor); break;
+		case 1: expected = ListLast(mirror); actual = ListCursorLast(&cursor); break;
+		case 2: expected = ListNext(mirror); actual = ListCursorNext(&cursor); break;
+		case 3: expected = ListPrev(mirror); actual = ListCursorPrev(&cursor); break;
+		case 4: expected = ListCurr(mirror); actual = ListCursorCurr(&cursor); break;
+		case 5: ListAdd(mirror, item); ListCursorAdd(&cursor, item); break;
+		case 6: ListInsert(mirror, item); ListCursorInsert(&cursor, item); break;
+		case 7: expected = ListRemove(mirror); actual = ListCursorRemove(&cursor); break;
+		case 8:
+			expected = ListSearch(mirror, identityComparator, item);
+			actual = ListCursorSearch(&cursor, identityComparator, item);
+			break;
+		case 9: ListNext(list); break;
+		case 10: ListPrev(list); break;
+		}
+		assert(expected == actual && ListCount(list) == ListCount(mirror)
+			&& ListCursorCurr(&cursor) == ListCurr(mirror)
+			&& "FAIL: Operations through a cursor did not behave the same as on a list\n");
+	}
+	int sameItems = ListCount(list) == ListCount(mirror);
+	for (void *item = ListFirst(list), *expected = ListFirst(mirror); item != NULL || expected != NULL;
+			item = ListNext(list), expected = ListNext(mirror)) {
+		sameItems = sameItems && item == expected;
+	}
+	assert(sameItems
+		&& "FAIL: Changes made through a cursor left different items in the list\n");
+	ListFree(mirror, NULL);
+	ListFree(list, NULL);
+
+	/* Test Case 4 */
+	list = ListCreate();
+	ListCursorInit(&cursor, list);
+	assert(ListCursorAdd(&cursor, &testInt[0]) == 0 && ListCurr(list) == NULL && ListNext(list) == &testInt[0]
+		&& "FAIL: Adding through a cursor to an empty list did not leave its current pointer before the start\n");
+	for (int i = 1; i < 10; i++) {
+		ListAppend(list, &testInt[i]);
+	}
+	ListSeek(list, 5);
+	ListCursorFirst(&cursor);
+	ListCursorNext(&cursor);
+	ListCursorAdd(&cursor, &testInt[100]);
+	assert(ListCurr(list) == &testInt[5] && ListIndexOfCurrent(list) == 6 && ListCursorCurr(&cursor) == &testInt[100]
+		&& "FAIL: Adding through a cursor moved the list's current item\n");
+	ListCursorSearch(&cursor, identityComparator, &testInt[5]);
+	assert(ListCursorRemove(&cursor) == &testInt[5] && ListCurr(list) == &testInt[6]
+		&& ListCursorCurr(&cursor) == &testInt[6] && ListIndexOfCurrent(list) == 6
+		&& "FAIL: Removing the list's current item through a cursor did not move the list on\n");
+	ListFree(list, NULL);
+
+	/* Test Case 5 */
+	static void *model[400];
+	int size = 0;
+	list = ListCreate();
+	for (int i = 0; i < 100; i++) {
+		ListAppend(list, &testInt[i]);
+		model[size++] = &testInt[i];
+	}
+	ListEnableSkipIndex(list);
+	ListSeek(list, 50);
+	int listIndex = 50;
+#ifndef LIST_NO_STATS
+	LIST_STATS before;
+	LIST_STATS after;
+	ListGetStats(list->context, &before);
+#endif
+	seed = 7;
+	int consistent = 1;
+	for (int i = 0; i < 300; i++) {
+		seed = seed * 1103515245 + 12345;
+		int position = (seed >> 8) % size;
+		ListCursorFirst(&cursor);
+		for (int j = 0; j < position; j++) {
+			ListCursorNext(&cursor);
+		}
+		int op = (seed >> 16) % 3;
+		if (op == 2 && (position == listIndex || size < 2)) {
+			op = 0;
+		}
+		int at = op == 0 ? position + 1 : position;
+		if (op == 2) {
+			ListCursorRemove(&cursor);
+			memmove(&model[at], &model[at + 1], (size - at - 1) * sizeof(void *));
+			size--;
+			listIndex -= at < listIndex ? 1 : 0;
+		} else {
+			void *item = &testInt[100 + i % 100];
+			(op == 0 ? ListCursorAdd : ListCursorInsert)(&cursor, item);
+			memmove(&model[at + 1], &model[at], (size - at) * sizeof(void *));
+			model[at] = item;
+			size++;
+			listIndex += at <= listIndex ? 1 : 0;
+		}
+		consistent &= ListCurr(list) == model[listIndex] && list->currentIndex == listIndex;
+		listIndex = (seed >> 4) % size;
+		consistent &= ListSeek(list, listIndex) == model[listIndex];
+		if (size > 300) {
+			ListTrim(list);
+			size--;
+			listIndex = size - 1;
+		}
+	}
+	int rebuilds = 0;
+#ifndef LIST_NO_STATS
+	ListGetStats(list->context, &after);
+	rebuilds = (int)(after.skipIndexRebuilds - before.skipIndexRebuilds);
+#endif
+	assert(consistent && rebuilds == 0
+		&& "FAIL: Changes through a cursor left the skip index or the list's current index out of date\n");
+
+	/* Cleanup */
+	ListFree(list, NULL);
+	printf("| ListCursor  |       5      |    20109     |  PASS  |\n");
+}
+
+/**
+ * 1. Serialize or deserialize without a list, context, encoder or decoder
+ * 2. Two lists written to a file one after the other are read back in order from a mapping,
+ *    leaving the file just past them
+ * 3. A list written to a pipe is read back from it
+ * 4. An empty list round trips
+ * 5. Truncated or foreign data, or an item that cannot be decoded, loads nothing and frees what was decoded
+ * 6. A list written at an odd offset of a file is read back from a mapping
+ */
+static void ListSerializeTest() {
+	static char strings[5000][16];
+	LIST_CODEC codec = { .encode = stringEncode, .decode = stringDecode, .itemFree = stringFree };
+	LIST *list = ListCreate();
+	for (int i = 0; i < 5000; i++) {
+		snprintf(strings[i], sizeof(strings[i]), "%.*s%d", i % 7, "abcdefg", i);
+		ListAppend(list, strings[i]);
+	}
+	char path[] = "/tmp/list_serialXXXXXX";
+	int fd = mkstemp(path);
+	unlink(path);
+
+	/* Test Case 1 */
+	LIST_CODEC noCodec = {0};
+	assert(ListSerialize(NULL, fd, &codec) == -1 && ListSerialize(list, fd, NULL) == -1
+		&& ListSerialize(list, fd, &noCodec) == -1
+		&& "FAIL: Serializing without a list or encoder did not fail\n");
+	assert(ListDeserialize(NULL, fd, &codec) == NULL && ListDeserialize(list->context, fd, &noCodec) == NULL
+		&& "FAIL: Deserializing without a context or decoder did not fail\n");
+
+	/* Test Case 2 */
+	LIST *small = ListCreate();
+	ListAppend(small, strings[1]);
+	ListAppend(small, strings[2]);
+	ListAppend(small, strings[3]);
+	ListFirst(list);
+	ListNext(list);
+	assert(ListSerialize(list, fd, &codec) == 0 && ListSerialize(small, fd, &codec) == 0
+		&& ListCurr(list) == strings[1]
+		&& "FAIL: Serializing lists to a file failed or moved the current item\n");
+	off_t end = lseek(fd, 0, SEEK_CUR);
+	lseek(fd, 0, SEEK_SET);
+	LIST *loaded = ListDeserialize(list->context, fd, &codec);
+	LIST *loadedSmall = ListDeserialize(list->context, fd, &codec);
+	assert(listHoldsStrings(loaded, strings, 5000) && listHoldsStrings(loadedSmall, strings + 1, 3)
+		&& lseek(fd, 0, SEEK_CUR) == end
+		&& "FAIL: Lists read back from a file did not match the ones written\n");
+	ListFree(loaded, stringFree);
+	ListFree(loadedSmall, stringFree);
+
+	/* Test Case 3 */
+	int pipeFds[2];
+	int piped = pipe(pipeFds);
+	assert(piped == 0 && "FAIL: Could not create a pipe\n");
+	ListFree(small, NULL);
+	small = ListCreate();
+	for (int i = 0; i < 100; i++) {
+		ListAppend(small, strings[i]);
+	}
+	ListSerialize(small, pipeFds[1], &codec);
+	loaded = ListDeserialize(list->context, pipeFds[0], &codec);
+	assert(listHoldsStrings(loaded, strings, 100)
+		&& "FAIL: A list read back from a pipe did not match the one written\n");
+	ListFree(loaded, stringFree);
+
+	/* Test Case 4 */
+	LIST *empty = ListCreate();
+	ListSerialize(empty, pipeFds[1], &codec);
+	loaded = ListDeserialize(list->context, pipeFds[0], &codec);
+	assert(listHoldsStrings(loaded, strings, 0)
+		&& "FAIL: An empty list did not round trip\n");
+	ListFree(loaded, NULL);
+	ListFree(empty, NULL);
+
+	/* Test Case 5 */
+	int truncated = ftruncate(fd, end / 2);
+	lseek(fd, 0, SEEK_SET);
+	assert(truncated == 0 && ListDeserialize(list->context, fd, &codec) == NULL && stringsLive == 0
+		&& "FAIL: Truncated data was loaded\n");
+	ssize_t written = write(pipeFds[1], "not a serialized list!!!", 24);
+	assert(written == 24 && ListDeserialize(list->context, pipeFds[0], &codec) == NULL
+		&& "FAIL: Data that is not a serialized list was loaded\n");
+	strcpy(strings[60], "!undecodable");
+	ListSerialize(small, pipeFds[1], &codec);
+	assert(ListDeserialize(list->context, pipeFds[0], &codec) == NULL && stringsLive == 0
+		&& "FAIL: A list with an item that could not be decoded was loaded, or decoded items leaked\n");
+
+	/* Test Case 6 */
+	LIST *unaligned = ListCreate();
+	ListAppend(unaligned, strings[1]);
+	ListAppend(unaligned, strings[2]);
+	truncated = ftruncate(fd, 0);
+	lseek(fd, 0, SEEK_SET);
+	written = write(fd, "x", 1);
+	ListSerialize(unaligned, fd, &codec);
+	end = lseek(fd, 0, SEEK_CUR);
+	lseek(fd, 1, SEEK_SET);
+	loaded = ListDeserialize(list->context, fd, &codec);
+	assert(truncated == 0 && written == 1 && listHoldsStrings(loaded, strings + 1, 2) && lseek(fd, 0, SEEK_CUR) == end
+		&& "FAIL: A list at an odd offset of a file did not match the one written\n");
+	ListFree(loaded, stringFree);
+	ListFree(unaligned, NULL);
+	close(pipeFds[0]);
+	close(pipeFds[1]);
+	close(fd);
+	ListFree(small, NULL);
+	ListFree(list, NULL);
+
+	printf("| ListSerial  |       6      |      11      |  PASS  |\n");
+}
+
+/**
+ * 1. Logging without a path, codec, log or valid id, and replaying a log that does not exist
+ * 2. Appends, prepends, adds, inserts, removes, trims, concatenations and frees replay to the same lists,
+ *    and the records of ids past the end of the array are skipped
+ * 3. Changes the log has no record for, such as sorting, are replayed from a snapshot of the list
+ * 4. Records are only written when a group fills or is committed
+ * 5. A checkpoint shrinks the log to the lists' current items, by itself once the log is large enough
+ *    and ListLogCommit is called, but not when a group fills
+ * 6. A record torn by a crash ends the replay and is cut off the file
+ */
+static void ListLogTest() {
+	static char strings[1000][16];
+	LIST_CODEC codec = { .encode = stringEncode, .decode = stringDecode, .itemFree = stringFree };
+	LIST_LOG_CONFIG config = { .groupSize = 1 };
+	LIST *replayed[4] = {0};
+	for (int i = 0; i < 1000; i++) {
+		snprintf(strings[i], sizeof(strings[i]), "%.*s%d", i % 5, "vwxyz", i);
+	}
+	char path[] = "/tmp/list_logXXXXXX";
+	close(mkstemp(path));
+	unlink(path);
+
+	/* Test Case 1 */
+	LIST *queue = ListCreate();
+	assert(ListLogOpen(NULL, &codec, NULL) == NULL && ListLogOpen(path, NULL, NULL) == NULL
+		&& "FAIL: Opening a log without a path or codec returned non-NULL\n");
+	assert(ListLogReplay(path, queue->context, &codec, replayed, 4) == 0
+		&& "FAIL: Replaying a log that does not exist did not replay nothing\n");
+	LIST_LOG *log = ListLogOpen(path, &codec, &config);
+	assert(log != NULL && ListEnableLog(queue, NULL, 0) == -1 && ListEnableLog(queue, log, LIST_LOG_MAX_LISTS) == -1
+		&& ListEnableLog(queue, log, 0) == 0 && ListEnableLog(queue, log, 1) == -1
+		&& "FAIL: Enabling a log with a bad log, id or list did not fail\n");
+
+	/* Test Case 2 */
+	LIST *other = ListCreate();
+	LIST *freed = ListCreate();
+	ListEnableLog(other, log, 1);
+	ListEnableLog(freed, log, 2);
+	LIST *duplicate = ListCreate();
+	assert(ListEnableLog(duplicate, log, 1) == -1
+		&& "FAIL: Two lists were logged under one id\n");
+	ListFree(duplicate, NULL);
+	for (int i = 0; i < 100; i++) {
+		ListAppend(queue, strings[i]);
+		ListAppend(freed, strings[i]);
+	}
+	for (int i = 0; i < 30; i++) {
+		ListFirst(queue);
+		ListRemove(queue);
+	}
+	ListPrepend(queue, strings[100]);
+	ListPrepend(queue, strings[101]);
+	ListTrim(queue);
+	ListSeek(queue, 10);
+	ListAdd(queue, strings[102]);
+	ListInsert(queue, strings[103]);
+	ListSeek(queue, 20);
+	ListRemove(queue);
+	ListLast(queue);
+	ListRemove(queue);
+	for (int i = 200; i < 210; i++) {
+		ListAppend(other, strings[i]);
+	}
+	ListConcat(queue, other);
+	ListFree(freed, NULL);
+	assert(ListLogReplay(path, queue->context, &codec, replayed, 4) > 0 && listsHoldSameStrings(replayed[0], queue)
+		&& replayed[1] == NULL && replayed[2] == NULL
+		&& "FAIL: Replaying single item changes did not rebuild the same lists\n");
+	ListFree(replayed[0], stringFree);
+	replayed[0] = NULL;
+	assert(ListLogReplay(path, queue->context, &codec, replayed, 2) > 0 && listsHoldSameStrings(replayed[0], queue)
+		&& replayed[1] == NULL
+		&& "FAIL: Replaying into fewer lists than were logged did not skip the others\n");
+	ListFree(replayed[0], stringFree);
+	replayed[0] = NULL;
+
+	/* Test Case 3 */
+	ListAddN(queue, (void *[]){ strings[300], strings[301] }, 2);
+	ListPrependN(queue, (void *[]){ strings[302], strings[303] }, 2);
+	ListSort(queue, stringCompare);
+	ListRemoveIf(queue, evenLengthComparator, NULL, NULL);
+	assert(ListLogReplay(path, queue->context, &codec, replayed, 4) > 0 && listsHoldSameStrings(replayed[0], queue)
+		&& "FAIL: Replaying changes recorded as snapshots did not rebuild the same list\n");
+	ListFree(replayed[0], stringFree);
+	replayed[0] = NULL;
+
+	/* Test Case 4 */
+	ListLogClose(log);
+	config.groupSize = 0;
+	log = ListLogOpen(path, &codec, &config);
+	ListDisableLog(queue);
+	assert(queue->log == NULL && ListEnableLog(queue, log, 0) == 0
+		&& "FAIL: A list stayed logged to a closed log, or could not be logged again\n");
+	struct stat fileStat;
+	stat(path, &fileStat);
+	off_t committedSize = fileStat.st_size;
+	for (int i = 400; i < 500; i++) {
+		ListAppend(queue, strings[i]);
+	}
+	stat(path, &fileStat);
+	assert(fileStat.st_size == committedSize && ListLogCommit(log) == 0 && stat(path, &fileStat) == 0
+		&& fileStat.st_size > committedSize
+		&& "FAIL: Records were written before their group was committed, or not after\n");
+	assert(ListLogReplay(path, queue->context, &codec, replayed, 4) > 0 && listsHoldSameStrings(replayed[0], queue)
+		&& "FAIL: Replaying a log reopened after a close did not rebuild the same list\n");
+	ListFree(replayed[0], stringFree);
+	replayed[0] = NULL;
+
+	/* Test Case 5 */
+	off_t logSize = fileStat.st_size;
+	assert(ListLogCheckpoint(log) == 0 && stat(path, &fileStat) == 0 && fileStat.st_size < logSize
+		&& ListLogReplay(path, queue->context, &codec, replayed, 4) == ListCount(queue) + 1
+		&& listsHoldSameStrings(replayed[0], queue)
+		&& "FAIL: A checkpoint did not shrink the log to a snapshot of the list\n");
+	ListFree(replayed[0], stringFree);
+	replayed[0] = NULL;
+	ListLogClose(log);
+	config.groupSize = 1;
+	config.checkpointBytes = fileStat.st_size + 4096;
+	log = ListLogOpen(path, &codec, &config);
+	ListEnableLog(queue, log, 0);
+	for (int i = 0; i < 500; i++) {
+		ListFirst(queue);
+		ListRemove(queue);
+		ListAppend(queue, strings[i]);
+	}
+	stat(path, &fileStat);
+	assert(fileStat.st_size >= config.checkpointBytes
+		&& "FAIL: A commit made because a group filled checkpointed the log\n");
+	ListLogCommit(log);
+	stat(path, &fileStat);
+	assert(fileStat.st_size < config.checkpointBytes
+		&& ListLogReplay(path, queue->context, &codec, replayed, 4) == ListCount(queue) + 1
+		&& listsHoldSameStrings(replayed[0], queue)
+		&& "FAIL: A commit past the checkpoint size did not checkpoint the log\n");
+	ListFree(replayed[0], stringFree);
+	replayed[0] = NULL;
+
+	/* Test Case 6 */
+	ListLogClose(log);
+	FILE *file = fopen(path, "a");
+	fwrite(strings[0], 1, 13, file);
+	fclose(file);
+	int numRecords = ListLogReplay(path, queue->context, &codec, replayed, 4);
+	stat(path, &fileStat);
+	assert(numRecords == ListCount(queue) + 1 && listsHoldSameStrings(replayed[0], queue)
+		&& fileStat.st_size % 8 == 0
+		&& "FAIL: A torn record was replayed or left on the end of the log\n");
+	ListFree(replayed[0], stringFree);
+	unlink(path);
+	ListFree(queue, NULL);
+	assert(stringsLive == 0
+		&& "FAIL: Replayed items were not all freed\n");
+
+	printf("| ListLog     |       6      |      15      |  PASS  |\n");
+}
+
+/**
+ * 1. Create a list in a NULL context.
+ * 2. Create lists in a context until its list limit is reached.
+ * 3. Add items in a context until its node limit is reached, default context unaffected.
+ * 4. Concatenate a list from another context, nodes are returned to their own context.
+ * 5. Concatenate into a list whose context cannot hold the other list's items.
+ * 6. Free lists that span several slabs, with and without itemFree, every node is returned to the context.
+ */
+static void ListContextTest() {
+	LIST_CONTEXT_CONFIG config = { .maxNodes = 3, .maxLists = 2 };
+	LIST_CONTEXT *context = ListContextCreate(&config);
+	int testInt[5] = {0};
+
+	/* Test Case 1 */
+	assert(ListCreateIn(NULL) == NULL
+		&& "FAIL: Creating a list in a NULL context returned non-NULL\n");
+
+	/* Test Case 2 */
+	LIST *list1 = ListCreateIn(context);
+	LIST *list2 = ListCreateIn(context);
+	assert(list1 != NULL && list2 != NULL
+		&& "FAIL: Creating lists within the context's limit failed\n");
+	assert(list1->context == context && list2->context == context
+		&& "FAIL: Lists did not record the context they were created in\n");
+	assert(ListCreateIn(context) == NULL
+		&& "FAIL: Creating a list past the context's list limit returned non-NULL\n");
+	ListFree(list2, NULL);
+	list2 = ListCreateIn(context);
+	assert(list2 != NULL
+		&& "FAIL: A freed list was not returned to its context\n");
+
+	/* Test Case 3 */
+	for (int i = 0; i < 3; i++) {
+		assert(ListAppend(list1, &testInt[i]) == 0
+			&& "FAIL: Appending within the context's node limit failed\n");
+	}
+	assert(ListAppend(list1, &testInt[3]) == -1
+		&& "FAIL: Appending past the context's node limit did not return -1\n");
+	LIST *defaultList = ListCreate();
+	assert(ListAppend(defaultList, &testInt[3]) == 0
+		&& "FAIL: A full context stopped the default context from allocating\n");
+
+	/* Test Case 4 */
+	ListConcat(defaultList, list1);
+	assert(defaultList->size == 4
+		&& "FAIL: Size was wrong after concatenating a list from another context\n");
+	assert(defaultList->tail->item == &testInt[2] && ListNodePrev(defaultList, defaultList->tail)->item == &testInt[1]
+		&& "FAIL: Items were not moved correctly from the other context\n");
+	list1 = ListCreateIn(context);
+	for (int i = 0; i < 3; i++) {
+		assert(ListAppend(list1, &testInt[i]) == 0
+			&& "FAIL: Nodes were not returned to the context after concatenating\n");
+	}
+
+	/* Test Case 5 */
+	ListConcat(list1, defaultList);
+	assert(list1->size == 3 && defaultList->size == 4
+		&& "FAIL: Lists were changed when the context could not hold the concatenated items\n");
+
+	/* Test Case 6 */
+	LIST_CONTEXT_CONFIG largeConfig = { .maxNodes = 5000, .maxLists = 0 };
+	LIST_CONTEXT *largeContext = ListContextCreate(&largeConfig);
+	int freedCount = 0;
+	for (int round = 0; round < 2; round++) {
+		LIST *large = ListCreateIn(largeContext);
+		int numAppended = 0;
+		while (ListAppend(large, &freedCount) == 0) {
+			numAppended++;
+		}
+		assert(numAppended == 5000
+			&& "FAIL: Nodes freed along with their list were not all returned to the context\n");
+		ListFree(large, round == 0 ? NULL : countingItemFree);
+	}
+	assert(freedCount == 5000
+		&& "FAIL: Freeing a list did not pass every item to itemFree\n");
+
+	/* Cleanup */
+	ListFree(defaultList, NULL);
+	ListContextDestroy(context);
+	ListContextDestroy(largeContext);
+	printf("| ListContext |       6      |       19     |  PASS  |\n");
+}
+
+/**
+ * ListGetStats test cases:
+ * 1. A new context has nothing in use, and operations are named after their functions.
+ * 2. Calls are counted, along with the nodes a search visits.
+ * 3. Failures are counted by cause: NULL arguments or an exhausted pool.
+ * 4. Node and list usage follows allocations and frees, and the peaks stay at their highest.
+ * 5. Removing the tail with ListRemove is not also counted as a ListTrim.
+ */
+static void ListStatsTest() {
+	LIST_CONTEXT_CONFIG config = { .maxNodes = 200, .maxLists = 2 };
+	LIST_CONTEXT *context = ListContextCreate(&config);
+	LIST_STATS after;
+
+	/* Test Case 1 */
+	ListGetStats(NULL, NULL);
+	ListGetStats(context, &after);
+	assert(after.nodesInUse == 0 && after.listsInUse == 0 && after.peakNodesInUse == 0 && after.peakListsInUse == 0
+		&& "FAIL: A new context reported nodes or lists in use\n");
+	assert(strcmp(ListOpName(LIST_OP_SEARCH), "ListSearch") == 0 && strcmp(ListOpName(LIST_OP_CURSOR_SEARCH), "ListCursorSearch") == 0
+		&& strcmp(ListOpName(LIST_OP_CONTEXT_COMPACT), "ListContextCompact") == 0 && ListOpName(LIST_NUM_OPS) == NULL
+		&& "FAIL: Operations were not named after their functions\n");
+
+#ifndef LIST_NO_STATS
+	LIST_STATS before;
+	int testInt[3] = {0};
+	int missing = -1;
+
+	/* Test Case 2 */
+	ListGetStats(context, &before);
+	LIST *list = ListCreateIn(context);
+	for (int i = 0; i < 3; i++) {
+		ListAppend(list, &testInt[i]);
+	}
+	ListFirst(list);
+	ListSearch(list, valueComparator, &missing);
+	ListCompact(list);
+	ListContextCompact(context);
+	ListGetStats(context, &after);
+	assert(after.calls[LIST_OP_CREATE] == before.calls[LIST_OP_CREATE] + 1
+		&& after.calls[LIST_OP_APPEND] == before.calls[LIST_OP_APPEND] + 3
+		&& after.calls[LIST_OP_SEARCH] == before.calls[LIST_OP_SEARCH] + 1
+		&& after.calls[LIST_OP_COMPACT] == before.calls[LIST_OP_COMPACT] + 1
+		&& after.calls[LIST_OP_CONTEXT_COMPACT] == before.calls[LIST_OP_CONTEXT_COMPACT] + 1
+		&& "FAIL: Calls were not counted\n");
+	assert(after.searchNodesVisited == before.searchNodesVisited + 3
+		&& "FAIL: A search that missed did not count every node it visited\n");
+
+	/* Test Case 3 */
+	ListGetStats(context, &before);
+	ListAppend(NULL, &testInt[0]);
+	ListAppend(list, NULL);
+	ListSearch(list, NULL, &missing);
+	LIST *list2 = ListCreateIn(context);
+	assert(ListCreateIn(context) == NULL
+		&& "FAIL: Creating a list past the context's list limit returned non-NULL\n");
+	while (ListAppend(list2, &testInt[0]) == 0) {
+	}
+	ListGetStats(context, &after);
+	assert(after.nullArgFailures[LIST_OP_APPEND] == before.nullArgFailures[LIST_OP_APPEND] + 2
+		&& after.nullArgFailures[LIST_OP_SEARCH] == before.nullArgFailures[LIST_OP_SEARCH] + 1
+		&& after.poolFailures[LIST_OP_APPEND] == before.poolFailures[LIST_OP_APPEND] + 1
+		&& after.poolFailures[LIST_OP_CREATE] == before.poolFailures[LIST_OP_CREATE] + 1
+		&& after.poolFailures[LIST_OP_SEARCH] == before.poolFailures[LIST_OP_SEARCH]
+		&& "FAIL: Failures were not counted by cause\n");
+
+	/* Test Case 4 */
+	ListThreadFlush();
+	ListGetStats(context, &after);
+	assert(after.nodesInUse == 200 && after.listsInUse == 2 && after.peakNodesInUse == 200 && after.peakListsInUse == 2
+		&& "FAIL: Node and list usage did not follow allocations\n");
+	ListFree(list2, NULL);
+	ListThreadFlush();
+	ListGetStats(context, &after);
+	assert(after.nodesInUse == 3 && after.listsInUse == 1 && after.peakNodesInUse == 200 && after.peakListsInUse == 2
+		&& "FAIL: Freeing a list did not lower usage, or lowered the peaks\n");
+
+	/* Test Case 5 */
+	ListGetStats(context, &before);
+	ListLast(list);
+	ListRemove(list);
+	ListGetStats(context, &after);
+	assert(after.calls[LIST_OP_REMOVE] == before.calls[LIST_OP_REMOVE] + 1
+		&& after.calls[LIST_OP_TRIM] == before.calls[LIST_OP_TRIM]
+		&& "FAIL: Removing the tail was not counted as a single ListRemove\n");
+	ListFree(list, NULL);
+#endif
+
+	/* Cleanup */
+	ListContextDestroy(context);
+	printf("| ListStats   |       5      |        9     |  PASS  |\n");
+}
+
+/**
+ * ListGetLatency test cases:
+ * 1. Latency is unavailable without LIST_LATENCY_HISTOGRAMS, and cannot be read into NULL.
+ * 2. Calls are timed, with percentiles in order.
+ * 3. Resetting starts the histograms afresh.
+ * 4. Dumping writes a header and a row for each operation called.
+ */
+static void ListLatencyTest() {
+	LIST_LATENCY latency[LIST_NUM_OPS];
+
+	/* Test Case 1 */
+#ifndef LIST_LATENCY_HISTOGRAMS
+	assert(ListGetLatency(latency) == -1 && ListDumpLatency(STDOUT_FILENO) == -1
+		&& "FAIL: Latency was reported by a build without histograms\n");
+#else
+	assert(ListGetLatency(NULL) == -1
+		&& "FAIL: Reading latency into NULL did not return -1\n");
+
+	/* Test Case 2 */
+	int testInt[1000];
+	LIST *list = ListCreate();
+	ListResetLatency();
+	for (int i = 0; i < 1000; i++) {
+		ListAppend(list, &testInt[i]);
+	}
+	assert(ListGetLatency(latency) == 0 && latency[LIST_OP_APPEND].count == 1000 && latency[LIST_OP_SORT].count == 0
+		&& latency[LIST_OP_APPEND].p50Ns <= latency[LIST_OP_APPEND].p99Ns
+		&& latency[LIST_OP_APPEND].p99Ns <= latency[LIST_OP_APPEND].p999Ns
+		&& latency[LIST_OP_APPEND].p999Ns <= latency[LIST_OP_APPEND].maxNs
+		&& "FAIL: Appends were not timed, or their percentiles were out of order\n");
+
+	/* Test Case 3 */
+	ListResetLatency();
+	ListGetLatency(latency);
+	assert(latency[LIST_OP_APPEND].count == 0 && latency[LIST_OP_APPEND].maxNs == 0
+		&& "FAIL: Resetting did not start the histograms afresh\n");
+
+	/* Test Case 4 */
+	ListFree(list, NULL);
+	char path[] = "/tmp/list_latencyXXXXXX";
+	int fd = mkstemp(path);
+	char dump[256] = {0};
+	assert(ListDumpLatency(fd) == 0 && pread(fd, dump, sizeof(dump) - 1, 0) > 0
+		&& strncmp(dump, "operation,count,p50_ns,p99_ns,p999_ns,max_ns\nListFree,1,", 56) == 0
+		&& "FAIL: The dump did not hold a header and a row for the one call made\n");
+	close(fd);
+	unlink(path);
+#endif
+
+	printf("| ListLatency |       4      |        4     |  PASS  |\n");
+}
+
+/**
+ * 1. Unrolled list operations on NULL and empty lists.
+ * 2. A long random sequence of operations gives the same results on an unrolled list as on a list,
+ *    as does concatenating onto an empty one.
+ * 3. Concatenate two unrolled lists, check order.
+ * 4. Free an unrolled list, every item is passed to itemFree.
+ * 5. Searching an unrolled list by pointer gives the same results as searching with an identity comparator.
+ */
+static void UListTest() {
+	static int testInt[200];
+	int freedCount = 0;
+
+	/* Test Case 1 */
+	ULIST *ulist = UListCreate();
+	assert(UListAppend(NULL, &testInt[0]) == -1 && UListAdd(ulist, NULL) == -1
+		&& "FAIL: Adding to a NULL unrolled list or adding a NULL item did not return -1\n");
+	assert(UListFirst(ulist) == NULL && UListRemove(ulist) == NULL && UListTrim(ulist) == NULL
+		&& "FAIL: Operations on an empty unrolled list returned non-NULL\n");
+	assert(UListNext(ulist) == NULL && ulist->currentIsBeyond == 1
+		&& "FAIL: Moving past the end of an empty unrolled list did not go beyond the end\n");
+
+	/* Test Case 2 */
+	LIST *list = ListCreate();
+	unsigned int seed = 1;
+	for (int i = 0; i < 20000; i++) {
+		seed = seed * 1103515245 + 12345;
+		int op = (seed >> 16) % 12;
+		void *item = &testInt[(seed >> 8) % 200];
+		void *expected = NULL;
+		void *actual = NULL;
+
+		/* Keep the list from growing without bound */
+		if (ListCount(list) > 150 && op >= 5 && op <= 8) {
+			op = 9;
+		}
+		switch (op) {
+		case 0: expected = ListFirst(list); actual = UListFirst(ulist); break;
+		case 1: expected = ListLast(list); actual = UListLast(ulist); break;
+		case 2: expected = ListNext(list); actual = UListNext(ulist); break;
+		case 3: expected = ListPrev(list); actual = UListPrev(ulist); break;
+		case 4: expected = ListCurr(list); actual = UListCurr(ulist); break;
+		case 5: ListAdd(list, item); UListAdd(ulist, item); break;
+		case 6: ListInsert(list, item); UListInsert(ulist, item); break;
+		case 7: ListAppend(list, item); UListAppend(ulist, item); break;
+		case 8: ListPrepend(list, item); UListPrepend(ulist, item); break;
+		case 9: expected = ListRemove(list); actual = UListRemove(ulist); break;
+		case 10: expected = ListTrim(list); actual = UListTrim(ulist); break;
+		case 11:
+			expected = ListSearch(list, identityComparator, item);
+			actual = UListSearch(ulist, identityComparator, item);
+			break;
+		}
+		assert(expected == actual && ListCount(list) == UListCount(ulist)
+			&& ListCurr(list) == UListCurr(ulist)
+			&& "FAIL: The unrolled list did not behave the same as a list\n");
+	}
+	while (ListCount(list) > 0) {
+		ListTrim(list);
+		UListTrim(ulist);
+	}
+	LIST *tail = ListCreate();
+	ULIST *utail = UListCreate();
+	for (int i = 0; i < 3; i++) {
+		ListAppend(tail, &testInt[i]);
+		UListAppend(utail, &testInt[i]);
+	}
+	ListFirst(tail);
+	ListPrev(tail);
+	UListFirst(utail);
+	UListPrev(utail);
+	ListConcat(list, tail);
+	UListConcat(ulist, utail);
+	assert(ListCount(list) == UListCount(ulist) && ListCurr(list) == UListCurr(ulist)
+		&& list->currentIsBeyond == ulist->currentIsBeyond && ListFirst(list) == UListFirst(ulist)
+		&& "FAIL: Concatenating onto an empty unrolled list did not leave the current item as on a list\n");
+
+	/* Test Case 3 */
+	UListFree(ulist, NULL);
+	ulist = UListCreate();
+	ULIST *ulist2 = UListCreate();
+	for (int i = 0; i < 100; i++) {
+		UListAppend(i < 40 ? ulist : ulist2, &testInt[i]);
+	}
+	UListFirst(ulist);
+	UListConcat(ulist, ulist2);
+	assert(UListCount(ulist) == 100 && UListCurr(ulist) == &testInt[0]
+		&& "FAIL: Size or current item was wrong after concatenating unrolled lists\n");
+	for (int i = 0; i < 100; i++) {
+		assert((i == 0 ? UListCurr(ulist) : UListNext(ulist)) == &testInt[i]
+			&& "FAIL: Items in incorrect order after concatenating unrolled lists\n");
+	}
+
+	/* Test Case 4 */
+	UListFree(ulist, NULL);
+	ulist = UListCreate();
+	for (int i = 0; i < 100; i++) {
+		UListAppend(ulist, &freedCount);
+	}
+	UListFree(ulist, countingItemFree);
+	assert(freedCount == 100
+		&& "FAIL: Freeing an unrolled list did not free every item\n");
+
+	/* Test Case 5 */
+	ulist = UListCreate();
+	ulist2 = UListCreate();
+	for (int i = 0; i < 200; i++) {
+		UListAppend(ulist, &testInt[(i * 7) % 50]);
+		UListAppend(ulist2, &testInt[(i * 7) % 50]);
+	}
+	UListFirst(ulist);
+	UListFirst(ulist2);
+	for (int i = 0; i < 1000; i++) {
+		seed = seed * 1103515245 + 12345;
+		void *item = &testInt[(seed >> 16) % 60];
+		if ((seed >> 8) % 4 == 0) {
+			UListFirst(ulist);
+			UListFirst(ulist2);
+			UListPrev(ulist);
+			UListPrev(ulist2);
+		} else if ((seed >> 8) % 4 == 1) {
+			UListNext(ulist);
+			UListNext(ulist2);
+		}
+		assert(UListSearchPtr(ulist, item) == UListSearch(ulist2, identityComparator, item)
+			&& UListCurr(ulist) == UListCurr(ulist2) && ulist->currentIsBeyond == ulist2->currentIsBeyond
+			&& "FAIL: Searching an unrolled list by pointer did not behave the same as searching with a comparator\n");
+	}
+	UListFree(ulist, NULL);
+	UListFree(ulist2, NULL);
+
+	/* Cleanup */
+	ListFree(list, NULL);
+	printf("| UList       |       5      |    21106     |  PASS  |\n");
+}
+
+/**
+ * 1. Intrusive list operations on NULL and empty lists.
+ * 2. A long random sequence of operations gives the same results on an intrusive list as on a list.
+ * 3. Concatenate two intrusive lists, check order and that the second list is left empty.
+ * 4. Free an intrusive list, every link is passed to linkFree and unlinked.
+ * 5. ILIST_ENTRY recovers the object a link is embedded in.
+ */
+static void IListTest() {
+	static LINKED_INT testItems[200];
+	int onList[200] = { 0 };
+	ILIST ilist;
+	ILIST ilist2;
+
+	/* Test Case 1 */
+	IListInit(&ilist);
+	assert(IListAppend(NULL, &testItems[0].link) == -1 && IListAdd(&ilist, NULL) == -1
+		&& "FAIL: Adding to a NULL intrusive list or adding a NULL link did not return -1\n");
+	assert(IListFirst(&ilist) == NULL && IListRemove(&ilist) == NULL && IListTrim(&ilist) == NULL
+		&& "FAIL: Operations on an empty intrusive list returned non-NULL\n");
+	assert(IListNext(&ilist) == NULL && ilist.currentIsBeyond == 1
+		&& "FAIL: Moving past the end of an empty intrusive list did not go beyond the end\n");
+
+	/* Test Case 2 */
+	LIST *list = ListCreate();
+	unsigned int seed = 1;
+	for (int i = 0; i < 200; i++) {
+		testItems[i].value = i % 50;
+	}
+	for (int i = 0; i < 20000; i++) {
+		seed = seed * 1103515245 + 12345;
+		int op = (seed >> 16) % 12;
+		int index = (seed >> 8) % 200;
+		LINKED_INT *item = &testItems[index];
+		void *expected = NULL;
+		void *actual = NULL;
+
+		/* A link can only be on one list at a time, and keep the list from growing without bound */
+		if ((onList[index] || ListCount(list) > 150) && op >= 5 && op <= 8) {
+			op = 9;
+		}
+		switch (op) {
+		case 0: expected = ListFirst(list); actual = linkedItem(IListFirst(&ilist)); break;
+		case 1: expected = ListLast(list); actual = linkedItem(IListLast(&ilist)); break;
+		case 2: expected = ListNext(list); actual = linkedItem(IListNext(&ilist)); break;
+		case 3: expected = ListPrev(list); actual = linkedItem(IListPrev(&ilist)); break;
+		case 4: expected = ListCurr(list); actual = linkedItem(IListCurr(&ilist)); break;
+		case 5: ListAdd(list, item); IListAdd(&ilist, &item->link); break;
+		case 6: ListInsert(list, item); IListInsert(&ilist, &item->link); break;
+		case 7: ListAppend(list, item); IListAppend(&ilist, &item->link); break;
+		case 8: ListPrepend(list, item); IListPrepend(&ilist, &item->link); break;
+		case 9: expected = ListRemove(list); actual = linkedItem(IListRemove(&ilist)); break;
+		case 10: expected = ListTrim(list); actual = linkedItem(IListTrim(&ilist)); break;
+		case 11:
+			expected = ListSearch(list, valueComparator, &item->value);
+			actual = linkedItem(IListSearch(&ilist, linkValueComparator, &item->value));
+			break;
+		}
+		if (op >= 5 && op <= 8) {
+			onList[index] = 1;
+		} else if ((op == 9 || op == 10) && actual != NULL) {
+			onList[(LINKED_INT *)actual - testItems] = 0;
+		}
+		assert(expected == actual && ListCount(list) == IListCount(&ilist)
+			&& ListCurr(list) == linkedItem(IListCurr(&ilist))
+			&& "FAIL: The intrusive list did not behave the same as a list\n");
+	}
+	ListFree(list, NULL);
+
+	/* Test Case 3 */
+	IListFree(&ilist, NULL);
+	IListInit(&ilist2);
+	for (int i = 0; i < 100; i++) {
+		testItems[i].value = i;
+		IListAppend(i < 40 ? &ilist : &ilist2, &testItems[i].link);
+	}
+	IListFirst(&ilist);
+	IListConcat(&ilist, &ilist2);
+	assert(IListCount(&ilist) == 100 && linkedItem(IListCurr(&ilist)) == &testItems[0]
+		&& IListCount(&ilist2) == 0 && IListFirst(&ilist2) == NULL
+		&& "FAIL: Size or current link was wrong after concatenating intrusive lists\n");
+	for (int i = 0; i < 100; i++) {
+		assert(linkedItem(i == 0 ? IListCurr(&ilist) : IListNext(&ilist)) == &testItems[i]
+			&& "FAIL: Links in incorrect order after concatenating intrusive lists\n");
+	}
+
+	/* Test Case 4 */
+	for (int i = 0; i < 100; i++) {
+		testItems[i].value = 0;
+	}
+	IListFree(&ilist, countingLinkFree);
+	int freedCount = 0;
+	for (int i = 0; i < 100; i++) {
+		freedCount += testItems[i].value == 1 && testItems[i].link.next == NULL && testItems[i].link.previous == NULL;
+	}
+	assert(freedCount == 100 && IListCount(&ilist) == 0
+		&& "FAIL: Freeing an intrusive list did not pass every link to linkFree\n");
+
+	/* Test Case 5 */
+	assert(ILIST_ENTRY(&testItems[7].link, LINKED_INT, link) == &testItems[7]
+		&& "FAIL: ILIST_ENTRY did not recover the object embedding a link\n");
+
+	printf("| IList       |       5      |    20106     |  PASS  |\n");
+}
+
+/**
+ * 1. Typed list operations on NULL and empty lists
+ * 2. Add, insert, append and prepend items by value, check order
+ * 3. Search from the current item with an inlined comparator
+ * 4. Remove and trim items, the removed values are copied out
+ * 5. Sort a large list, ascending and stable
+ */
+static void ListTypedTest() {
+	int value = 0;
+
+	/* Test Case 1 */
+	IntList *list = IntListCreate();
+	assert(IntListAppend(NULL, 1) == -1 && IntListFirst(list) == NULL && IntListRemove(list, &value) == -1
+		&& IntListTrim(list, &value) == -1 && IntListSearch(list, 1) == NULL
+		&& "FAIL: Operations on a NULL or empty typed list did not fail\n");
+
+	/* Test Case 2: builds 0, 1, 2, 3, 4 */
+	IntListAppend(list, 3);
+	IntListPrepend(list, 1);
+	IntListAdd(list, 2);
+	IntListLast(list);
+	IntListAdd(list, 4);
+	IntListFirst(list);
+	IntListInsert(list, 0);
+	assert(IntListCount(list) == 5 && *IntListCurr(list) == 0
+		&& "FAIL: Size or current item was wrong after adding items to a typed list\n");
+	for (int i = 0; i < 5; i++) {
+		assert(*(i == 0 ? IntListFirst(list) : IntListNext(list)) == i && list->tail->item == 4
+			&& "FAIL: Items in incorrect order in a typed list\n");
+	}
+
+	/* Test Case 3 */
+	IntListAppend(list, 2);
+	IntListFirst(list);
+	assert(IntListSearch(list, 2) == &list->head->next->next->item
+		&& "FAIL: Searching a typed list did not find the first match\n");
+	IntListNext(list);
+	assert(IntListSearch(list, 2) == &list->tail->item && IntListCurr(list) == &list->tail->item
+		&& "FAIL: Searching a typed list did not start at the current item\n");
+	IntListNext(list);
+	assert(IntListSearch(list, 2) == NULL && list->currentIsBeyond == 1
+		&& "FAIL: A failed search did not leave the current pointer beyond the end\n");
+
+	/* Test Case 4: 0, 1, 2, 3, 4, 2 becomes 0, 2, 3, 4 */
+	IntListFirst(list);
+	IntListNext(list);
+	assert(IntListRemove(list, &value) == 0 && value == 1 && *IntListCurr(list) == 2
+		&& "FAIL: Removing from a typed list did not copy out the item or move to the next item\n");
+	assert(IntListTrim(list, &value) == 0 && value == 2 && *IntListCurr(list) == 4 && IntListCount(list) == 4
+		&& "FAIL: Trimming a typed list did not copy out the item or make the new tail current\n");
+	assert(IntListRemove(list, NULL) == 0 && *IntListCurr(list) == 3 && list->tail->item == 3
+		&& "FAIL: Removing the tail of a typed list did not make the new tail current\n");
+	IntListFree(list);
+
+	/* Test Case 5 */
+	KeyedList *keyed = KeyedListCreate();
+	unsigned int seed = 1;
+	for (int i = 0; i < 10000; i++) {
+		seed = seed * 1103515245 + 12345;
+		KEYED_INT item = { .key = (seed >> 16) % 100, .sequence = i };
+		KeyedListAppend(keyed, item);
+	}
+	KeyedListSort(keyed);
+	assert(KeyedListCount(keyed) == 10000 && KeyedListCurr(keyed) == &keyed->head->item
+		&& "FAIL: Sorting a typed list lost items or did not make the first item current\n");
+	KEYED_INT *previous = KeyedListFirst(keyed);
+	for (KEYED_INT *item = KeyedListNext(keyed); item != NULL; item = KeyedListNext(keyed)) {
+		assert((previous->key < item->key || (previous->key == item->key && previous->sequence < item->sequence))
+			&& "FAIL: A sorted typed list was out of order or not stable\n");
+		previous = item;
+	}
+	assert(KeyedListPrev(keyed) == &keyed->tail->item && keyed->tail->previous->next == keyed->tail
+		&& keyed->head->previous == NULL
+		&& "FAIL: Previous links were not restored after sorting a typed list\n");
+	KeyedListFree(keyed);
+
+	printf("| ListTyped   |       5      |    10014     |  PASS  |\n");
+}
+
+#if defined(LIST_COMPACT_NODES) && !defined(LIST_LOCK_FREE)
+/**
+ * 1. Opening a pool needs a file, and in-memory contexts have no roots or checkpoints.
+ * 2. Lists saved at root slots are back, in order and with their current items, when the file is reopened.
+ * 3. Nodes freed before closing are reused after reopening, without growing the file.
+ * 4. After a crash, a root is cut back to its last checkpoint and the rest of the pool is free.
+ * 5. Nodes of a list outside the roots are free after the pool is closed and reopened.
+ * 6. A file that is not a pool is refused.
+ * 7. After a crash, roots are as of the last checkpoint even if nodes they used then were relinked or reused.
+ */
+static void ListPoolTest() {
+	char path[] = "/tmp/list_poolXXXXXX";
+	close(mkstemp(path));
+	struct stat fileStat;
+
+	/* Test Case 1 */
+	LIST_CONTEXT *memory = ListContextCreate(NULL);
+	assert(ListContextOpen(NULL, NULL) == NULL && ListContextOpen("/nonexistent/pool", NULL) == NULL
+		&& "FAIL: Opening a pool without a usable file returned non-NULL\n");
+	assert(ListContextRoot(memory, 0) == NULL && ListContextCheckpoint(memory) == -1
+		&& "FAIL: An in-memory context had a root slot or took a checkpoint\n");
+	ListContextDestroy(memory);
+
+	/* Test Case 2 */
+	LIST_CONTEXT *context = ListContextOpen(path, NULL);
+	assert(context != NULL && ListContextRoot(context, -1) == NULL && ListContextRoot(context, LIST_MAX_ROOTS) == NULL
+		&& "FAIL: Opening a new pool failed or an out of range root slot was returned\n");
+	LIST *numbers = ListContextRoot(context, 0);
+	LIST *letters = ListContextRoot(context, 7);
+	assert(numbers != NULL && ListContextRoot(context, 0) == numbers && ListCount(numbers) == 0
+		&& "FAIL: A new root slot did not hold one empty list\n");
+	for (int i = 0; i < 20000; i++) {
+		ListAppend(numbers, (void *)(intptr_t)(i + 1));
+	}
+	ListAppend(letters, (void *)(intptr_t)'a');
+	ListAppend(letters, (void *)(intptr_t)'b');
+	ListAppend(letters, (void *)(intptr_t)'c');
+	ListPrev(letters);
+	assert(ListContextCheckpoint(context) == 0
+		&& "FAIL: Checkpointing a pool failed\n");
+	ListContextDestroy(context);
+
+	context = ListContextOpen(path, NULL);
+	numbers = ListContextRoot(context, 0);
+	letters = ListContextRoot(context, 7);
+	assert(context != NULL && ListCount(numbers) == 20000 && ListCount(letters) == 3
+		&& "FAIL: Reopening a pool did not bring back its root lists\n");
+	int inOrder = 1;
+	intptr_t expected = 1;
+	for (void *item = ListFirst(numbers); item != NULL; item = ListNext(numbers)) {
+		inOrder &= (intptr_t)item == expected++;
+	}
+	for (void *item = ListLast(numbers); item != NULL; item = ListPrev(numbers)) {
+		inOrder &= (intptr_t)item == --expected;
+	}
+	assert(inOrder && expected == 1
+		&& "FAIL: A reopened root list was out of order in either direction\n");
+	assert((intptr_t)ListCurr(letters) == 'b' && ListIndexOfCurrent(letters) == 1
+		&& "FAIL: A reopened root list lost its current item\n");
+
+	/* Test Case 3 */
+	ListFree(letters, NULL);
+	for (int i = 0; i < 10000; i++) {
+		ListTrim(numbers);
+	}
+	ListContextDestroy(context);
+	stat(path, &fileStat);
+	off_t fileSize = fileStat.st_size;
+
+	context = ListContextOpen(path, NULL);
+	numbers = ListContextRoot(context, 0);
+	assert(ListCount(ListContextRoot(context, 7)) == 0 && ListCount(numbers) == 10000
+		&& "FAIL: A freed root list was still saved, or a trimmed one was not\n");
+	for (int i = 10000; i < 20000; i++) {
+		ListAppend(numbers, (void *)(intptr_t)(i + 1));
+	}
+	ListContextCheckpoint(context);
+	stat(path, &fileStat);
+	assert(fileStat.st_size == fileSize && (intptr_t)ListLast(numbers) == 20000
+		&& "FAIL: Nodes freed before closing a pool were not reused after reopening it\n");
+	ListContextDestroy(context);
+
+	/* Test Case 4 */
+	pid_t child = fork();
+	if (child == 0) {
+		context = ListContextOpen(path, NULL);
+		LIST *crashed = ListContextRoot(context, 2);
+		for (int i = 0; i < 10; i++) {
+			ListAppend(crashed, (void *)(intptr_t)(i + 1));
+		}
+		ListContextCheckpoint(context);
+		for (int i = 10; i < 15; i++) {
+			ListAppend(crashed, (void *)(intptr_t)(i + 1));
+		}
+		_exit(0);
+	}
+	waitpid(child, NULL, 0);
+
+	context = ListContextOpen(path, NULL);
+	LIST *crashed = ListContextRoot(context, 2);
+	assert(context != NULL && ListCount(crashed) == 10 && (intptr_t)ListLast(crashed) == 10
+		&& ListNodeNext(crashed, crashed->tail) == NULL && ListCount(ListContextRoot(context, 0)) == 20000
+		&& "FAIL: A pool opened after a crash did not hold its lists as of the last checkpoint\n");
+	for (int i = 0; i < 15; i++) {
+		ListAppend(crashed, (void *)(intptr_t)(i + 1));
+	}
+	ListContextCheckpoint(context);
+	stat(path, &fileStat);
+	assert(ListCount(crashed) == 25 && fileStat.st_size == fileSize
+		&& "FAIL: Nodes lost in a crash were not free after reopening the pool\n");
+	ListContextDestroy(context);
+
+	/* Test Case 5 */
+	context = ListContextOpen(path, NULL);
+	LIST *scratch = ListCreateIn(context);
+	for (int i = 0; i < 20000; i++) {
+		ListAppend(scratch, (void *)(intptr_t)(i + 1));
+	}
+	ListContextDestroy(context);
+	stat(path, &fileStat);
+	fileSize = fileStat.st_size;
+
+	context = ListContextOpen(path, NULL);
+	crashed = ListContextRoot(context, 2);
+	for (int i = 0; i < 20000; i++) {
+		ListAppend(crashed, (void *)(intptr_t)(i + 1));
+	}
+	ListContextCheckpoint(context);
+	stat(path, &fileStat);
+	assert(ListCount(crashed) == 20025 && fileStat.st_size == fileSize
+		&& "FAIL: Nodes of a list outside the roots were not free after reopening the pool\n");
+	ListContextDestroy(context);
+
+	/* Test Case 6 */
+	FILE *file = fopen(path, "w");
+	fputs("not a list pool", file);
+	fclose(file);
+	assert(ListContextOpen(path, NULL) == NULL
+		&& "FAIL: Opening a file that is not a pool returned non-NULL\n");
+
+	/* Test Case 7: remove the head, trim, remove from the middle, then hand removed nodes to another root */
+	for (int change = 0; change < 4; change++) {
+		context = crashAfterCheckpoint(path, change);
+		LIST *checkpointed = ListContextRoot(context, 0);
+		int intact = ListCount(checkpointed) == 10 && (intptr_t)ListCurr(checkpointed) == 10;
+		expected = 1;
+		for (void *item = ListFirst(checkpointed); item != NULL; item = ListNext(checkpointed)) {
+			intact &= (intptr_t)item == expected++;
+		}
+		assert(intact && expected == 11 && ListCount(ListContextRoot(context, 1)) == 0
+			&& "FAIL: A root changed after the last checkpoint was not as of that checkpoint after a crash\n");
+		ListContextDestroy(context);
+	}
+	char copiesPath[sizeof(path) + sizeof(".roots")];
+	snprintf(copiesPath, sizeof(copiesPath), "%s.roots", path);
+	unlink(path);
+	unlink(copiesPath);
+
+	printf("| ListPool    |       7      |      15      |  PASS  |\n");
+}
+
+/**
+ * Makes a new pool whose root 0 holds the items 1 to 10 and root 1 is empty, then takes a
+ * checkpoint, makes the given change to root 0 and crashes, all in a child process.
+ * Returns the pool reopened after the crash.
+ */
+static LIST_CONTEXT *crashAfterCheckpoint(const char *path, int change) {
+	unlink(path);
+	pid_t child = fork();
+	if (child == 0) {
+		LIST_CONTEXT *context = ListContextOpen(path, NULL);
+		LIST *list = ListContextRoot(context, 0);
+		LIST *other = ListContextRoot(context, 1);
+		for (int i = 0; i < 10; i++) {
+			ListAppend(list, (void *)(intptr_t)(i + 1));
+		}
+		ListContextCheckpoint(context);
+		if (change == 0) {
+			ListFirst(list);
+			ListRemove(list);
+		} else if (change == 1) {
+			ListTrim(list);
+		} else if (change == 2) {
+			ListSeek(list, 5);
+			ListRemove(list);
+		} else {
+			for (int i = 0; i < 5; i++) {
+				ListFirst(list);
+				ListRemove(list);
+				ListAppend(other, (void *)(intptr_t)(100 + i));
+			}
+		}
+		_exit(0);
+	}
+	waitpid(child, NULL, 0);
+	return ListContextOpen(path, NULL);
+}
+#endif
+
+#ifdef LIST_THREAD_SAFE
+/**
+ * 1. Several threads build and tear down their own lists from one shared pool at once.
+ * 2. A thread's cached nodes are returned to a context when it flushes
+ *    (in the lock-free build, released nodes are available to other threads straight away).
+ * 3. Several threads scan one list at once, each with its own cursor.
+ * 4. Under epoch reclamation a removed node is not reused while a reader is inside its epoch.
+ * 5. Readers scan without locks while a writer appends and removes, and released nodes are reused.
+ * 6. Under epoch reclamation the pool runs dry just after a reclaim that frees fewer nodes than a refill needs.
+ */
+static void ListThreadTest() {
+	pthread_t threads[4];
+	LIST *lists[4];
+
+	/* Test Case 1 */
+	for (int i = 0; i < 4; i++) {
+		lists[i] = ListCreate();
+		pthread_create(&threads[i], NULL, listThreadWorker, lists[i]);
+	}
+	for (int i = 0; i < 4; i++) {
+		pthread_join(threads[i], NULL);
+		assert(ListCount(lists[i]) == 1000
+			&& "FAIL: A list lost items while other threads used the node pool\n");
+		int previous = -1;
+		for (int *item = ListFirst(lists[i]); item != NULL; item = ListNext(lists[i])) {
+			assert(*item == previous + 1
+				&& "FAIL: Two threads were handed the same node\n");
+			previous = *item;
+		}
+		ListFree(lists[i], free);
+	}
+
+	/* Test Case 2 */
+	LIST_CONTEXT_CONFIG config = { .maxNodes = 1, .maxLists = 0 };
+	LIST_CONTEXT *context = ListContextCreate(&config);
+	LIST *list = ListCreateIn(context);
+	void *result;
+	int testInt = 0;
+	ListAppend(list, &testInt);
+	ListTrim(list);
+	pthread_create(&threads[0], NULL, listAppendWorker, list);
+	pthread_join(threads[0], &result);
+#ifdef LIST_LOCK_FREE
+	assert(result == list
+		&& "FAIL: A released node was not available to other threads\n");
+#else
+	assert(result == NULL
+		&& "FAIL: A node cached by another thread was handed out\n");
+	ListThreadFlush();
+	pthread_create(&threads[0], NULL, listAppendWorker, list);
+	pthread_join(threads[0], &result);
+	assert(result == list
+		&& "FAIL: Flushing did not return the thread's cached node to its context\n");
+#endif
+	assert(ListAppend(list, &testInt) == 0
+		&& "FAIL: An exiting thread did not return its cached node to its context\n");
+
+	/* Test Case 3 */
+	static int values[10000];
+	LIST *shared = ListCreate();
+	for (int i = 0; i < 10000; i++) {
+		values[i] = i;
+		ListAppend(shared, &values[i]);
+	}
+	ListSeek(shared, 1234);
+	for (int i = 0; i < 4; i++) {
+		pthread_create(&threads[i], NULL, listCursorWorker, shared);
+	}
+	for (int i = 0; i < 4; i++) {
+		pthread_join(threads[i], &result);
+		assert(result == shared
+			&& "FAIL: A cursor scanning alongside others did not see every item in order\n");
+	}
+	assert(ListCurr(shared) == &values[1234]
+		&& "FAIL: Scanning with cursors moved the list's current item\n");
+	ListFree(shared, NULL);
+
+	/* Test Case 4 */
+	LIST_CONTEXT_CONFIG epochConfig = { .maxNodes = 0, .maxLists = 0, .epochReclaim = 1 };
+	LIST_CONTEXT *epochContext = ListContextCreate(&epochConfig);
+	LIST *epochList = ListCreateIn(epochContext);
+	for (int i = 0; i < 3; i++) {
+		ListAppend(epochList, &values[i]);
+	}
+	LIST_CURSOR cursor;
+	ListCursorInit(&cursor, epochList);
+	unsigned epoch = ListEpochEnter(epochList);
+	ListCursorNext(&cursor);
+	ListFirst(epochList);
+	ListRemove(epochList);
+	for (int i = 3; i < 10000; i++) {
+		ListAppend(epochList, &values[i]);
+		ListFirst(epochList);
+		ListRemove(epochList);
+	}
+	assert(ListCursorCurr(&cursor) == &values[0] && ListCursorNext(&cursor) == &values[1]
+		&& "FAIL: A node was reused while a reader was inside its epoch\n");
+	ListEpochExit(epochList, epoch);
+	ListFree(epochList, NULL);
+
+	/* Test Case 5 */
+	epochConfig.maxNodes = 5000;
+	LIST_CONTEXT *limitedContext = ListContextCreate(&epochConfig);
+	epochList = ListCreateIn(limitedContext);
+	pthread_create(&threads[0], NULL, listEpochWriter, epochList);
+	for (int i = 1; i < 4; i++) {
+		pthread_create(&threads[i], NULL, listEpochReader, epochList);
+	}
+	for (int i = 0; i < 4; i++) {
+		pthread_join(threads[i], &result);
+		assert(result == epochList
+			&& "FAIL: A reader saw a reused node, or released nodes were not reused\n");
+	}
+	ListFree(epochList, NULL);
+
+	/* Test Case 6 */
+	epochConfig.maxNodes = 0;
+	LIST_CONTEXT *reclaimContext = ListContextCreate(&epochConfig);
+	epochList = ListCreateIn(reclaimContext);
+	ListAppend(epochList, &values[0]);
+	ListAppend(epochList, &values[1]);
+	epoch = ListEpochEnter(epochList);
+	ListFirst(epochList);
+	ListRemove(epochList);
+	ListRemove(epochList);
+	ListEpochExit(epochList, epoch);
+	int appended = 0;
+	for (int i = 0; i < 10000; i++) {
+		appended += ListAppend(epochList, &values[i]) == 0;
+	}
+	assert(appended == 10000 && ListCount(epochList) == 10000
+		&& "FAIL: Running the pool dry just after a reclaim lost appends\n");
+	ListFree(epochList, NULL);
+
+	/* Cleanup */
+	ListFree(list, NULL);
+	ListThreadFlush();
+	ListContextDestroy(context);
+	ListContextDestroy(epochContext);
+	ListContextDestroy(limitedContext);
+	ListContextDestroy(reclaimContext);
+#ifdef LIST_LOCK_FREE
+	printf("| ListThread  |       6      |     4017     |  PASS  |\n");
+#else
+	printf("| ListThread  |       6      |     4018     |  PASS  |\n");
+#endif
+}
+
+/**
+ * Appends 1000 items to its list while repeatedly building and freeing a scratch list
+ */
+static void *listThreadWorker(void *arg) {
+	LIST *list = arg;
+	for (int i = 0; i < 1000; i++) {
+		int *item = malloc(sizeof(int));
+		*item = i;
+		ListAppend(list, item);
+
+		LIST *scratch = ListCreate();
+		for (int j = 0; j < 100; j++) {
+			ListPrepend(scratch, item);
+		}
+		ListFree(scratch, NULL);
+	}
+	return NULL;
+}
+
+/**
+ * Appends and trims one item, returning the list if the append succeeded and NULL if not
+ */
+static void *listAppendWorker(void *arg) {
+	static int testInt = 0;
+	LIST *list = arg;
+	if (ListAppend(list, &testInt) != 0) {
+		return NULL;
+	}
+	ListTrim(list);
+	return list;
+}
+
+/**
+ * Scans the list forwards and back with a cursor a few times, returning the list if
+ * every pass saw items 0, 1, 2, ... in order and NULL if not
+ */
+static void *listCursorWorker(void *arg) {
+	LIST *list = arg;
+	LIST_CURSOR cursor;
+	ListCursorInit(&cursor, list);
+	for (int pass = 0; pass < 10; pass++) {
+		int expected = 0;
+		for (int *item = ListCursorFirst(&cursor); item != NULL; item = ListCursorNext(&cursor)) {
+			if (*item != expected++) {
+				return NULL;
+			}
+		}
+		for (int *item = ListCursorLast(&cursor); item != NULL; item = ListCursorPrev(&cursor)) {
+			if (*item != --expected) {
+				return NULL;
+			}
+		}
+		if (expected != 0) {
+			return NULL;
+		}
+	}
+	return list;
+}
+
+static int epochWriterDone;
+static int epochValues[100000];
+
+/**
+ * Appends 100000 increasing items, removing from the front to keep the list short,
+ * with the occasional trim and bulk removal. An append that finds the node limit reached
+ * waits for readers to let go of released nodes. Returns the list if every append
+ * eventually succeeded (so released nodes were reused) and NULL if not
+ */
+static void *listEpochWriter(void *arg) {
+	LIST *list = arg;
+	void *result = list;
+	for (int i = 0; i < 100000 && result != NULL; i++) {
+		epochValues[i] = i;
+		for (int attempt = 0; ListAppend(list, &epochValues[i]) != 0; attempt++) {
+			if (attempt == 1000000) {
+				result = NULL;
+				break;
+			}
+			sched_yield();
+		}
+		if (ListCount(list) > 64) {
+			ListFirst(list);
+			ListRemove(list);
+		}
+		if (i % 1000 == 999) {
+			ListTrim(list);
+			ListRemoveIf(list, evenComparator, NULL, NULL);
+		}
+	}
+	__atomic_store_n(&epochWriterDone, 1, __ATOMIC_RELEASE);
+	return result;
+}
+
+/**
+ * Scans the list inside an epoch until the writer is done, returning the list if every
+ * scan saw strictly increasing items and NULL if not
+ */
+static void *listEpochReader(void *arg) {
+	LIST *list = arg;
+	LIST_CURSOR cursor;
+	while (!__atomic_load_n(&epochWriterDone, __ATOMIC_ACQUIRE)) {
+		unsigned epoch = ListEpochEnter(list);
+		int previous = -1;
+		ListCursorInit(&cursor, list);
+		for (int *item = ListCursorNext(&cursor); item != NULL; item = ListCursorNext(&cursor)) {
+			if (*item <= previous) {
+				ListEpochExit(list, epoch);
+				return NULL;
+			}
+			previous = *item;
+		}
+		ListEpochExit(list, epoch);
+	}
+	return list;
+}
+#endif
+
+/***************************************************************
+ * Globals                                                     *
+ ***************************************************************/
+
+int successComparator(void *item1, void *item2) {
+	/* Suppress unused variable warnings */
+	item1 = (int *)item1;
+	item2 = (int *)item2;
+	return 1;
+}
+int failComparator(void *item1, void *item2) {
+	/* Suppress unused variable warnings */
+	item1 = (int *)item1;
+	item2 = (int *)item2;
+	return 0;
+}
+int identityComparator(void *item1, void *item2) {
+	return item1 == item2;
+}
+void countingItemFree(void *item) {
+	(*(int *)item)++;
+}
+int valueComparator(void *item1, void *item2) {
+	return *(int *)item1 == *(int *)item2;
+}
+void *itemKey(void *item) {
+	return item;
+}
+unsigned long valueHash(void *key) {
+	return (unsigned long)(*(int *)key % 37);
+}
+int evenComparator(void *item1, void *item2) {
+	/* Suppress unused variable warnings */
+	item2 = (int *)item2;
+	return *(int *)item1 % 2 == 0;
+}
+
+/**
+ * Checks that the list holds exactly the given items in order, following the links
+ * in both directions.
+ * Returns 1 if it does, 0 if not.
+ */
+int listHoldsItems(LIST *list, void **items, int count) {
+	if (list->size != count) {
+		return 0;
+	}
+	NODE *node = list->head;
+	for (int i = 0; i < count; i++, node = ListNodeNext(list, node)) {
+		if (node == NULL || node->item != items[i]) {
+			return 0;
+		}
+	}
+	node = list->tail;
+	for (int i = count - 1; i >= 0; i--, node = ListNodePrev(list, node)) {
+		if (node == NULL || node->item != items[i]) {
+			return 0;
+		}
+	}
+	return node == NULL;
+}
+void *linkedItem(ILIST_LINK *link) {
+	return link != NULL ? ILIST_ENTRY(link, LINKED_INT, link) : NULL;
+}
+int linkValueComparator(ILIST_LINK *link, void *value) {
+	return ILIST_ENTRY(link, LINKED_INT, link)->value == *(int *)value;
+}
+void countingLinkFree(ILIST_LINK *link) {
+	ILIST_ENTRY(link, LINKED_INT, link)->value++;
+}
+int intItemCompare(void *item1, void *item2) {
+	return (*(int *)item1 > *(int *)item2) - (*(int *)item1 < *(int *)item2);
+}
+int keyedItemCompare(void *item1, void *item2) {
+	return KEYED_COMPARE(*(KEYED_INT *)item1, *(KEYED_INT *)item2);
+}
+size_t stringEncode(void *item, const void **bytes, void *arg) {
+	(void)arg;
+	*bytes = item;
+	return strlen(item);
+}
+void *stringDecode(const void *bytes, size_t length, void *arg) {
+	(void)arg;
+	/* Strings starting with '!' cannot be decoded */
+	if (length > 0 && *(const char *)bytes == '!') {
+		return NULL;
+	}
+	char *string = malloc(length + 1);
+	memcpy(string, bytes, length);
+	string[length] = '\0';
+	stringsLive++;
+	return string;
+}
+void stringFree(void *item) {
+	stringsLive--;
+	free(item);
+}
+
+/**
+ * Checks that the list holds copies of the given strings in order, and that its first item is current.
+ * Returns 1 if it does, 0 if not.
+ */
+int listHoldsStrings(LIST *list, char (*strings)[16], int count) {
+	if (list == NULL || ListCount(list) != count || (count > 0 && ListCurr(list) != list->head->item)) {
+		return 0;
+	}
+	int i = 0;
+	for (NODE *node = list->head; node != NULL; node = ListNodeNext(list, node), i++) {
+		if (strcmp(node->item, strings[i]) != 0) {
+			return 0;
+		}
+	}
+	return i == count;
+}
+
+/**
+ * Checks that two lists hold equal strings in the same order.
+ * Returns 1 if they do, 0 if not.
+ */
+int listsHoldSameStrings(LIST *list1, LIST *list2) {
+	if (list1 == NULL || list2 == NULL || ListCount(list1) != ListCount(list2)) {
+		return 0;
+	}
+	NODE *node2 = list2->head;
+	for (NODE *node1 = list1->head; node1 != NULL; node1 = ListNodeNext(list1, node1)) {
+		if (strcmp(node1->item, node2->item) != 0) {
+			return 0;
+		}
+		node2 = ListNodeNext(list2, node2);
+	}
+	return 1;
+}
+int stringCompare(void *item1, void *item2) {
+	return strcmp(item1, item2);
+}
+int evenLengthComparator(void *item, void *comparisonArg) {
+	(void)comparisonArg;
+	return strlen(item) % 2 == 0;
+}
+
+/**
+ * Checks that the list's items are in ascending order by comparator, with items that
+ * compare equal in sequence order, and that its links agree in both directions.
+ * Returns 1 if they are, 0 if not.
+ */
+int listIsSorted(LIST *list, int (*comparator)(void *, void *)) {
+	int count = 0;
+	NODE *previous = NULL;
+	for (NODE *node = list->head; node != NULL; node = ListNodeNext(list, node)) {
+		if (ListNodePrev(list, node) != previous) {
+			return 0;
+		}
+		if (previous != NULL) {
+			int order = (* comparator)(previous->item, node->item);
+			if (order > 0 || (order == 0 && ((KEYED_INT *)previous->item)->sequence > ((KEYED_INT *)node->item)->sequence)) {
+				return 0;
+			}
+		}
+		previous = node;
+		count++;
+	}
+	return previous == list->tail && count == list->size;
 }
-int failComparator(void *item1, void *item2) {
-	/* Suppress unused variable warnings */
-	item1 = (int *)item1;
-	item2 = (int *)item2;
-	return 0;
-}
\ No newline at end of file
@@ -0,0 +1,349 @@
+#ifndef _LIST_TYPED_H_
+#define _LIST_TYPED_H_
+
+/**
+ * Type-specialised lists, generated by LIST_DEFINE(name, T, cmp).
+ * Nodes hold a T by value, so there is no item pointer to follow, and cmp is expanded
+ * into the search and sort loops instead of being called through a pointer.
+ * Cmp may be a function or a function-like macro taking two T values and returning
+ * less than, equal to or greater than 0, like the comparator of qsort.
+ *
+ * The generated type is called name and its functions nameCreate, nameAppend and so on.
+ * They follow the LIST functions of the same names, except that items are passed in by
+ * value and returned as pointers into the node (valid until the item is removed):
+ *   name *nameCreate(void)
+ *   void nameFree(name *list)
+ *   int nameCount(name *list)
+ *   T *nameFirst(name *list), nameLast, nameNext, namePrev, nameCurr
+ *   int nameAdd(name *list, T item), nameInsert, nameAppend, namePrepend
+ *   int nameRemove(name *list, T *item), nameTrim: copy the removed item out if item is not NULL
+ *   T *nameSearch(name *list, T key): matches items for which cmp(item, key) == 0
+ *   void nameSort(name *list): stable, ascending by cmp; the first item becomes current
+ *
+ * Each list keeps its own nodes, allocated LIST_TYPED_CHUNK_NODES at a time and reused
+ * once removed, and frees them all in nameFree.
+ */
+#include <stdlib.h>
+
+#define LIST_TYPED_CHUNK_NODES 64
+
+#define LIST_DEFINE(name, T, cmp)																\
+																								\
+typedef struct name##_NODE {																	\
+	T item;																						\
+	struct name##_NODE *previous;																\
+	struct name##_NODE *next;																	\
+} name##_NODE;																					\
+																								\
+typedef struct name##_CHUNK {																	\
+	struct name##_CHUNK *next;																	\
+	name##_NODE nodes[LIST_TYPED_CHUNK_NODES];													\
+} name##_CHUNK;																					\
+																								\
+typedef struct name {																			\
+	name##_NODE *current;																		\
+	name##_NODE *head;																			\
+	name##_NODE *tail;																			\
+	int size;																					\
+	int currentIsBeyond; /* 0 if current is not beyond the list boundaries, -1 if before, 1 if after */ \
+	name##_NODE *freeNodes; /* Chained through their next pointers */							\
+	name##_CHUNK *chunks;																		\
+} name;																							\
+																								\
+static inline name *name##Create(void) {														\
+	return calloc(1, sizeof(name));																\
+}																								\
+																								\
+static inline void name##Free(name *list) {														\
+	if (list == NULL) {																			\
+		return;																					\
+	}																							\
+	while (list->chunks != NULL) {																\
+		name##_CHUNK *chunk = list->chunks;														\
+		list->chunks = chunk->next;																\
+		free(chunk);																			\
+	}																							\
+	free(list);																					\
+}																								\
+																								\
+static inline int name##Count(name *list) {														\
+	return list != NULL ? list->size : 0;														\
+}																								\
+																								\
+static inline T *name##First(name *list) {														\
+	if (list == NULL || list->size == 0) {														\
+		return NULL;																			\
+	}																							\
+	list->current = list->head;																	\
+	list->currentIsBeyond = 0;																	\
+	return &list->current->item;																\
+}																								\
+																								\
+static inline T *name##Last(name *list) {														\
+	if (list == NULL || list->size == 0) {														\
+		return NULL;																			\
+	}																							\
+	list->current = list->tail;																	\
+	list->currentIsBeyond = 0;																	\
+	return &list->current->item;																\
+}																								\
+																								\
+static inline T *name##Next(name *list) {														\
+	if (list == NULL) {																			\
+		return NULL;																			\
+	}																							\
+	if (list->currentIsBeyond == 1 || list->current == list->tail || list->size == 0) {			\
+		list->current = NULL;																	\
+		list->currentIsBeyond = 1;																\
+		return NULL;																			\
+	}																							\
+	list->current = list->currentIsBeyond == -1 ? list->head : list->current->next;				\
+	list->currentIsBeyond = 0;																	\
+	return &list->current->item;																\
+}																								\
+																								\
+static inline T *name##Prev(name *list) {														\
+	if (list == NULL) {																			\
+		return NULL;																			\
+	}																							\
+	if (list->currentIsBeyond == -1 || list->current == list->head) {							\
+		list->current = NULL;																	\
+		list->currentIsBeyond = -1;																\
+		return NULL;																			\
+	}																							\
+	list->current = list->currentIsBeyond == 1 ? list->tail : list->current->previous;			\
+	list->currentIsBeyond = 0;																	\
+	return &list->current->item;																\
+}																								\
+																								\
+static inline T *name##Curr(name *list) {														\
+	if (list == NULL || list->current == NULL) {												\
+		return NULL;																			\
+	}																							\
+	return &list->current->item;																\
+}																								\
+																								\
+/* Takes a node from the list's free nodes, adding a chunk if there are none */					\
+static inline name##_NODE *name##AllocNode(name *list, T item) {								\
+	if (list->freeNodes == NULL) {																\
+		name##_CHUNK *chunk = malloc(sizeof(name##_CHUNK));										\
+		if (chunk == NULL) {																	\
+			return NULL;																		\
+		}																						\
+		chunk->next = list->chunks;																\
+		list->chunks = chunk;																	\
+		for (int i = 0; i < LIST_TYPED_CHUNK_NODES; i++) {										\
+			chunk->nodes[i].next = i + 1 < LIST_TYPED_CHUNK_NODES ? &chunk->nodes[i + 1] : NULL; \
+		}																						\
+		list->freeNodes = &chunk->nodes[0];														\
+	}																							\
+	name##_NODE *node = list->freeNodes;														\
+	list->freeNodes = node->next;																\
+	node->item = item;																			\
+	return node;																				\
+}																								\
+																								\
+/* Links a node in after pre, or at the start for a NULL pre, and makes it current */			\
+static inline void name##LinkAfter(name *list, name##_NODE *pre, name##_NODE *node) {			\
+	name##_NODE *post = pre != NULL ? pre->next : list->head;									\
+	node->previous = pre;																		\
+	node->next = post;																			\
+	if (pre != NULL) {																			\
+		pre->next = node;																		\
+	} else {																					\
+		list->head = node;																		\
+	}																							\
+	if (post != NULL) {																			\
+		post->previous = node;																	\
+	} else {																					\
+		list->tail = node;																		\
+	}																							\
+	list->current = node;																		\
+	list->currentIsBeyond = 0;																	\
+	list->size++;																				\
+}																								\
+																								\
+/* Unlinks a node and returns it to the list's free nodes */									\
+static inline void name##Unlink(name *list, name##_NODE *node, T *item) {						\
+	if (item != NULL) {																			\
+		*item = node->item;																		\
+	}																							\
+	if (node->previous != NULL) {																\
+		node->previous->next = node->next;														\
+	} else {																					\
+		list->head = node->next;																\
+	}																							\
+	if (node->next != NULL) {																	\
+		node->next->previous = node->previous;													\
+	} else {																					\
+		list->tail = node->previous;															\
+	}																							\
+	list->size--;																				\
+	node->next = list->freeNodes;																\
+	list->freeNodes = node;																		\
+}																								\
+																								\
+static inline int name##Add(name *list, T item) {												\
+	if (list == NULL) {																			\
+		return -1;																				\
+	}																							\
+	name##_NODE *node = name##AllocNode(list, item);											\
+	if (node == NULL) {																			\
+		return -1;																				\
+	}																							\
+	name##_NODE *pre = list->current;															\
+	if (list->currentIsBeyond == -1) {															\
+		pre = NULL;																				\
+	} else if (list->currentIsBeyond == 1 || pre == NULL) {										\
+		pre = list->tail;																		\
+	}																							\
+	name##LinkAfter(list, pre, node);															\
+	return 0;																					\
+}																								\
+																								\
+static inline int name##Insert(name *list, T item) {											\
+	if (list == NULL) {																			\
+		return -1;																				\
+	}																							\
+	name##_NODE *node = name##AllocNode(list, item);											\
+	if (node == NULL) {																			\
+		return -1;																				\
+	}																							\
+	name##_NODE *pre = NULL;																	\
+	if (list->currentIsBeyond == 1) {															\
+		pre = list->tail;																		\
+	} else if (list->currentIsBeyond == 0 && list->current != NULL) {							\
+		pre = list->current->previous;															\
+	}																							\
+	name##LinkAfter(list, pre, node);															\
+	return 0;																					\
+}																								\
+																								\
+static inline int name##Append(name *list, T item) {											\
+	if (list == NULL) {																			\
+		return -1;																				\
+	}																							\
+	name##_NODE *node = name##AllocNode(list, item);											\
+	if (node == NULL) {																			\
+		return -1;																				\
+	}																							\
+	name##LinkAfter(list, list->tail, node);													\
+	return 0;																					\
+}																								\
+																								\
+static inline int name##Prepend(name *list, T item) {											\
+	if (list == NULL) {																			\
+		return -1;																				\
+	}																							\
+	name##_NODE *node = name##AllocNode(list, item);											\
+	if (node == NULL) {																			\
+		return -1;																				\
+	}																							\
+	name##LinkAfter(list, NULL, node);															\
+	return 0;																					\
+}																								\
+																								\
+/* Removes the current item and makes the next item the current one (the new tail if it was the tail) */ \
+static inline int name##Remove(name *list, T *item) {											\
+	if (list == NULL || list->current == NULL) {												\
+		return -1;																				\
+	}																							\
+	name##_NODE *node = list->current;															\
+	list->current = node->next != NULL ? node->next : node->previous;							\
+	list->currentIsBeyond = 0;																	\
+	name##Unlink(list, node, item);																\
+	return 0;																					\
+}																								\
+																								\
+/* Removes the last item and makes the new last item the current one */							\
+static inline int name##Trim(name *list, T *item) {												\
+	if (list == NULL || list->size == 0) {														\
+		return -1;																				\
+	}																							\
+	name##_NODE *node = list->tail;																\
+	list->current = node->previous;																\
+	list->currentIsBeyond = 0;																	\
+	name##Unlink(list, node, item);																\
+	return 0;																					\
+}																								\
+																								\
+/* Searches from the current item on, as ListSearch does */										\
+static inline T *name##Search(name *list, T key) {												\
+	if (list == NULL || list->size == 0) {														\
+		return NULL;																			\
+	}																							\
+	name##_NODE *node = list->currentIsBeyond == -1 ? list->head : list->current;				\
+	for (; node != NULL; node = node->next) {													\
+		if (cmp(node->item, key) == 0) {														\
+			list->current = node;																\
+			list->currentIsBeyond = 0;															\
+			return &node->item;																	\
+		}																						\
+	}																							\
+	list->current = NULL;																		\
+	list->currentIsBeyond = 1;																	\
+	return NULL;																				\
+}																								\
+																								\
+/* Bottom-up merge sort of the next chain, in runs that double in width; ties keep list order */ \
+static inline void name##Sort(name *list) {														\
+	if (list == NULL || list->size < 2) {														\
+		return;																					\
+	}																							\
+	name##_NODE *head = list->head;																\
+	for (int width = 1; width < list->size; width *= 2) {										\
+		name##_NODE *remaining = head;															\
+		name##_NODE **tailLink = &head;															\
+		while (remaining != NULL) {																\
+			name##_NODE *left = remaining;														\
+			name##_NODE *right = left;															\
+			for (int i = 0; i < width && right != NULL; i++) {									\
+				right = right->next;															\
+			}																					\
+			remaining = right;																	\
+			for (int i = 0; i < width && remaining != NULL; i++) {								\
+				remaining = remaining->next;													\
+			}																					\
+			int leftCount = width;																\
+			int rightCount = width;																\
+			while (leftCount > 0 && left != NULL && rightCount > 0 && right != NULL) {			\
+				if (cmp(right->item, left->item) < 0) {											\
+					*tailLink = right;															\
+					right = right->next;														\
+					rightCount--;																\
+				} else {																		\
+					*tailLink = left;															\
+					left = left->next;															\
+					leftCount--;																\
+				}																				\
+				tailLink = &(*tailLink)->next;													\
+			}																					\
+			while (leftCount > 0 && left != NULL) {												\
+				*tailLink = left;																\
+				left = left->next;																\
+				leftCount--;																	\
+				tailLink = &(*tailLink)->next;													\
+			}																					\
+			while (rightCount > 0 && right != NULL) {												\
+				*tailLink = right;																\
+				right = right->next;															\
+				rightCount--;																	\
+				tailLink = &(*tailLink)->next;													\
+			}																					\
+		}																						\
+		*tailLink = NULL;																		\
+	}																							\
+																								\
+	/* Restore the previous links along the sorted chain */										\
+	name##_NODE *previous = NULL;																\
+	for (name##_NODE *node = head; node != NULL; node = node->next) {							\
+		node->previous = previous;																\
+		previous = node;																		\
+	}																							\
+	list->head = head;																			\
+	list->tail = previous;																		\
+	list->current = head;																		\
+	list->currentIsBeyond = 0;																	\
+}
+
+#endif /* _LIST_TYPED_H_ */
@@ -0,0 +1,650 @@
+/***************************************************************
+ * Implementation of an unrolled list: each block holds a run  *
+ * of item pointers so scans read mostly contiguous memory     *
+ ***************************************************************/
+
+/***************************************************************
+ * Imports                                                     *
+ ***************************************************************/
+#include "list.h"
+#include "ulist.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef LIST_THREAD_SAFE
+#include <pthread.h>
+#endif
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+/***************************************************************
+ * Defines                                                     *
+ ***************************************************************/
+#define UNODE_SLAB_SIZE 256
+#define ULIST_SLAB_SIZE 64
+#define HALF_BLOCK_ITEMS (ULIST_BLOCK_ITEMS / 2)
+
+/* Item pointers are compared a vector at a time when the target has SSE2 or AVX2 and 64-bit pointers */
+#if defined(__SSE2__) && UINTPTR_MAX == UINT64_MAX
+#define ULIST_SCAN_SSE2
+#if defined(__AVX2__)
+#define ULIST_SCAN_AVX2
+#endif
+#endif
+
+#ifdef LIST_THREAD_SAFE
+#define LOCK_POOL()					pthread_mutex_lock(&poolLock)
+#define UNLOCK_POOL()				pthread_mutex_unlock(&poolLock)
+#else
+#define LOCK_POOL()
+#define UNLOCK_POOL()
+#endif
+
+#define LIST_IS_EMPTY				(list->size == 0)
+#define CURRENT_NODE_BEYOND_START	(list->currentIsBeyond == -1)
+#define CURRENT_NODE_BEYOND_END		(list->currentIsBeyond == 1)
+#define CURRENT_ITEM_IS_FIRST		(list->current == list->head && list->currentIndex == 0)
+#define CURRENT_ITEM_IS_LAST		(list->current == list->tail && list->currentIndex == list->tail->count - 1)
+#define CURRENT_ITEM				(list->current->items[list->currentIndex])
+
+/***************************************************************
+ * Statics                                                     *
+ ***************************************************************/
+static UNODE *freeBlocks = NULL; // Chained through their next pointers
+static ULIST **availableListArr = NULL;
+static int numListsAvailable = 0;
+static int numListsAllocated = 0;
+#ifdef LIST_THREAD_SAFE
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static UNODE *allocBlock(void);
+static void releaseBlock(UNODE *block);
+static void linkBlockAfter(ULIST *list, UNODE *pre, UNODE *block);
+static void unlinkBlock(ULIST *list, UNODE *block);
+static void mergeBlocks(ULIST *list, UNODE *into, UNODE *from);
+static int insertItemAt(ULIST *list, UNODE *block, int index, void *item);
+static void *removeItemAt(ULIST *list, UNODE *block, int index);
+static int findItemInBlock(UNODE *block, int index, void *item);
+
+/***************************************************************
+ * Global Functions                                            *
+ ***************************************************************/
+
+/**
+ * Creates a new unrolled list and returns a pointer to it.
+ * Returns NULL if the list pool could not be grown.
+ */
+ULIST *UListCreate(void) {
+	LOCK_POOL();
+	if (numListsAvailable == 0) {
+		ULIST *slab = malloc(ULIST_SLAB_SIZE * sizeof(ULIST));
+		ULIST **newAvailableArr = realloc(availableListArr,
+			(numListsAllocated + ULIST_SLAB_SIZE) * sizeof(ULIST *));
+		if (slab == NULL || newAvailableArr == NULL) {
+			free(slab);
+			if (newAvailableArr != NULL) {
+				availableListArr = newAvailableArr;
+			}
+			UNLOCK_POOL();
+			return NULL;
+		}
+		availableListArr = newAvailableArr;
+		for (int i = ULIST_SLAB_SIZE - 1; i >= 0; i--) {
+			availableListArr[numListsAvailable] = &slab[i];
+			numListsAvailable++;
+		}
+		numListsAllocated += ULIST_SLAB_SIZE;
+	}
+	numListsAvailable--;
+	ULIST *list = availableListArr[numListsAvailable];
+	UNLOCK_POOL();
+
+	list->current = NULL;
+	list->currentIndex = 0;
+	list->head = NULL;
+	list->tail = NULL;
+	list->size = 0;
+	list->currentIsBeyond = 0;
+	return list;
+}
+
+/**
+ * Returns the number of items in the list.
+ */
+int UListCount(ULIST *list) {
+	if (list != NULL) {
+		return list->size;
+	} else {
+		return 0;
+	}
+}
+
+/**
+ * Returns a pointer to the first item in the list and makes it the current item.
+ * Returns NULL if the list is empty.
+ */
+void *UListFirst(ULIST *list) {
+	if (list == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	list->current = list->head;
+	list->currentIndex = 0;
+	list->currentIsBeyond = 0;
+	return CURRENT_ITEM;
+}
+
+/**
+ * Returns the last item in the list and makes it the current item.
+ * Returns NULL if the list is empty.
+ */
+void *UListLast(ULIST *list) {
+	if (list == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	list->current = list->tail;
+	list->currentIndex = list->tail->count - 1;
+	list->currentIsBeyond = 0;
+	return CURRENT_ITEM;
+}
+
+/**
+ * Increments the current item.
+ * Returns a pointer to the new current item.
+ * Returns NULL if the current item advances beyond the end of the list.
+ */
+void *UListNext(ULIST *list) {
+	if (list == NULL) {
+		return NULL;
+	}
+
+	if (CURRENT_NODE_BEYOND_END || LIST_IS_EMPTY || CURRENT_ITEM_IS_LAST) {
+		list->current = NULL;
+		list->currentIsBeyond = 1;
+		return NULL;
+	}
+
+	if (CURRENT_NODE_BEYOND_START) {
+		list->current = list->head;
+		list->currentIndex = 0;
+		list->currentIsBeyond = 0;
+	} else if (list->currentIndex + 1 < list->current->count) {
+		list->currentIndex++;
+	} else {
+		list->current = list->current->next;
+		list->currentIndex = 0;
+	}
+	return CURRENT_ITEM;
+}
+
+/**
+ * Decrements the current item.
+ * Returns a pointer to the new current item.
+ * Returns NULL if the current item advances beyond the start of the list.
+ */
+void *UListPrev(ULIST *list) {
+	if (list == NULL) {
+		return NULL;
+	}
+
+	if (CURRENT_NODE_BEYOND_START || LIST_IS_EMPTY || CURRENT_ITEM_IS_FIRST) {
+		list->current = NULL;
+		list->currentIsBeyond = -1;
+		return NULL;
+	}
+
+	if (CURRENT_NODE_BEYOND_END) {
+		list->current = list->tail;
+		list->currentIndex = list->tail->count - 1;
+		list->currentIsBeyond = 0;
+	} else if (list->currentIndex > 0) {
+		list->currentIndex--;
+	} else {
+		list->current = list->current->previous;
+		list->currentIndex = list->current->count - 1;
+	}
+	return CURRENT_ITEM;
+}
+
+/**
+ * Returns a pointer to the current item in the list
+ */
+void *UListCurr(ULIST *list) {
+	if (list == NULL || LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START || CURRENT_NODE_BEYOND_END) {
+		return NULL;
+	}
+	return CURRENT_ITEM;
+}
+
+/**
+ * Adds the new item to the list directly after the current item and makes it the current item.
+ * If the current pointer is before the start of the list, the item is added to the start.
+ * If the current pointer is after the end of the list, the item is added to the end.
+ * Returns 0 if successful, -1 if failed.
+ */
+int UListAdd(ULIST *list, void *item) {
+	if (list == NULL || item == NULL) {
+		return -1;
+	}
+
+	if (LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START) {
+		return insertItemAt(list, list->head, 0, item);
+	} else if (CURRENT_NODE_BEYOND_END) {
+		return insertItemAt(list, list->tail, list->tail->count, item);
+	} else {
+		return insertItemAt(list, list->current, list->currentIndex + 1, item);
+	}
+}
+
+/**
+ * Adds the new item to the list directly before the current item and makes it the current item.
+ * If the current pointer is before the start of the list, the item is added to the start.
+ * If the current pointer is after the end of the list, the item is added to the end.
+ * Returns 0 if successful, -1 if failed
+ */
+int UListInsert(ULIST *list, void *item) {
+	if (list == NULL || item == NULL) {
+		return -1;
+	}
+
+	if (LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START) {
+		return insertItemAt(list, list->head, 0, item);
+	} else if (CURRENT_NODE_BEYOND_END) {
+		return insertItemAt(list, list->tail, list->tail->count, item);
+	} else {
+		return insertItemAt(list, list->current, list->currentIndex, item);
+	}
+}
+
+/**
+ * Adds item to the end of the list and makes the new item the current one.
+ * Returns 0 if successful, -1 if failed.
+ */
+int UListAppend(ULIST *list, void *item) {
+	if (list == NULL || item == NULL) {
+		return -1;
+	}
+	return insertItemAt(list, list->tail, LIST_IS_EMPTY ? 0 : list->tail->count, item);
+}
+
+/**
+ * Adds item to the front of list, and makes the new item the current one.
+ * Returns 0 on success, -1 on failure.
+ */
+int UListPrepend(ULIST *list, void *item) {
+	if (list == NULL || item == NULL) {
+		return -1;
+	}
+	return insertItemAt(list, list->head, 0, item);
+}
+
+/**
+ * Return current item and take it out of the list.
+ * Make the next item the current one, or the new last item if the last item was removed.
+ */
+void *UListRemove(ULIST *list) {
+	if (list == NULL || LIST_IS_EMPTY || CURRENT_NODE_BEYOND_START || CURRENT_NODE_BEYOND_END) {
+		return NULL;
+	}
+	return removeItemAt(list, list->current, list->currentIndex);
+}
+
+/**
+ * Adds list2 to the end of list1.
+ * The current pointer is set to the current pointer of list1.
+ * List2 no longer exists after the operation.
+ */
+void UListConcat(ULIST *list1, ULIST *list2) {
+	if (list1 == NULL || list2 == NULL || list1 == list2) {
+		return;
+	}
+
+	if (list1->size == 0 && list2->size > 0) {
+		list1->head = list2->head;
+		list1->tail = list2->tail;
+		list1->current = list2->current;
+		list1->currentIndex = list2->currentIndex;
+		list1->currentIsBeyond = list2->currentIsBeyond;
+	} else if (list2->size > 0) {
+		list1->tail->next = list2->head;
+		list2->head->previous = list1->tail;
+		list1->tail = list2->tail;
+	}
+	list1->size += list2->size;
+
+	list2->head = NULL;
+	list2->tail = NULL;
+	list2->current = NULL;
+	list2->size = 0;
+	UListFree(list2, NULL);
+}
+
+/**
+ * Delete list.
+ * ItemFree is a pointer to a routine that frees an item.
+ * It should be invoked (within UListFree) as: (* itemFree)(itemToBeFreed);
+ */
+void UListFree(ULIST *list, void (*itemFree)(void *)) {
+	if (list == NULL) {
+		return;
+	}
+
+	UNODE *block = list->head;
+	while (block != NULL) {
+		if (itemFree != NULL) {
+			for (int i = 0; i < block->count; i++) {
+				(* itemFree)(block->items[i]);
+			}
+		}
+
+		UNODE *oldBlock = block;
+		block = block->next;
+		releaseBlock(oldBlock);
+	}
+
+	list->current = NULL;
+	list->head = NULL;
+	list->tail = NULL;
+	list->size = 0;
+	list->currentIsBeyond = 0;
+
+	LOCK_POOL();
+	availableListArr[numListsAvailable] = list;
+	numListsAvailable++;
+	UNLOCK_POOL();
+}
+
+/**
+ * Return last item and take it out of list.
+ * Make the new last item the current one.
+ */
+void *UListTrim(ULIST *list) {
+	if (list == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+	return removeItemAt(list, list->tail, list->tail->count - 1);
+}
+
+/**
+ * Searches list starting at the current item until the end is reached or a match is found.
+ * Comparator is called as for ListSearch and returns 1 for a match.
+ * If a match is found, the current pointer is left at the matched item and the pointer to that item is returned.
+ * If no match is found, the current pointer is left beyond the end of the list and a NULL pointer is returned.
+ */
+void *UListSearch(ULIST *list, int (*comparator)(void *, void *), void *comparisonArg) {
+	if (list == NULL || comparator == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	UNODE *block = CURRENT_NODE_BEYOND_START ? list->head : list->current;
+	int index = CURRENT_NODE_BEYOND_START ? 0 : list->currentIndex;
+	for (; block != NULL; block = block->next, index = 0) {
+		for (; index < block->count; index++) {
+			if ((* comparator)(block->items[index], comparisonArg) == 1) {
+				list->current = block;
+				list->currentIndex = index;
+				list->currentIsBeyond = 0;
+				return CURRENT_ITEM;
+			}
+		}
+	}
+
+	list->current = NULL;
+	list->currentIsBeyond = 1;
+	return NULL;
+}
+
+/**
+ * Searches list for the exact item pointer, starting at the current item, without a comparator.
+ * The current pointer is left exactly as UListSearch would leave it with a comparator
+ * that matches identical pointers.
+ * Each block is scanned with vector compares where the target supports them.
+ */
+void *UListSearchPtr(ULIST *list, void *item) {
+	if (list == NULL || LIST_IS_EMPTY) {
+		return NULL;
+	}
+
+	UNODE *block = CURRENT_NODE_BEYOND_START ? list->head : list->current;
+	int index = CURRENT_NODE_BEYOND_START ? 0 : list->currentIndex;
+	for (; block != NULL; block = block->next, index = 0) {
+		index = findItemInBlock(block, index, item);
+		if (index >= 0) {
+			list->current = block;
+			list->currentIndex = index;
+			list->currentIsBeyond = 0;
+			return CURRENT_ITEM;
+		}
+	}
+
+	list->current = NULL;
+	list->currentIsBeyond = 1;
+	return NULL;
+}
+
+/***************************************************************
+ * Static Functions                                            *
+ ***************************************************************/
+
+/**
+ * Takes an empty block from the block pool, adding a slab of blocks if there are none.
+ * Returns NULL if the pool could not be grown.
+ */
+static UNODE *allocBlock(void) {
+	LOCK_POOL();
+	if (freeBlocks == NULL) {
+		UNODE *slab = malloc(UNODE_SLAB_SIZE * sizeof(UNODE));
+		if (slab == NULL) {
+			UNLOCK_POOL();
+			return NULL;
+		}
+		for (int i = 0; i < UNODE_SLAB_SIZE; i++) {
+			slab[i].next = i + 1 < UNODE_SLAB_SIZE ? &slab[i + 1] : NULL;
+		}
+		freeBlocks = slab;
+	}
+	UNODE *block = freeBlocks;
+	freeBlocks = block->next;
+	UNLOCK_POOL();
+
+	block->previous = NULL;
+	block->next = NULL;
+	block->count = 0;
+	return block;
+}
+
+/**
+ * Returns a block to the block pool
+ */
+static void releaseBlock(UNODE *block) {
+	LOCK_POOL();
+	block->next = freeBlocks;
+	freeBlocks = block;
+	UNLOCK_POOL();
+}
+
+/**
+ * Links a block into the list after pre, or as the only block if pre is NULL
+ */
+static void linkBlockAfter(ULIST *list, UNODE *pre, UNODE *block) {
+	block->previous = pre;
+	block->next = pre != NULL ? pre->next : NULL;
+	if (block->next != NULL) {
+		block->next->previous = block;
+	} else {
+		list->tail = block;
+	}
+	if (pre != NULL) {
+		pre->next = block;
+	} else {
+		list->head = block;
+	}
+}
+
+/**
+ * Unlinks a block from the list
+ */
+static void unlinkBlock(ULIST *list, UNODE *block) {
+	if (block->previous != NULL) {
+		block->previous->next = block->next;
+	} else {
+		list->head = block->next;
+	}
+	if (block->next != NULL) {
+		block->next->previous = block->previous;
+	} else {
+		list->tail = block->previous;
+	}
+}
+
+/**
+ * Moves all items of a block into the block before it and releases the emptied block
+ */
+static void mergeBlocks(ULIST *list, UNODE *into, UNODE *from) {
+	memcpy(&into->items[into->count], from->items, from->count * sizeof(void *));
+	if (list->current == from) {
+		list->current = into;
+		list->currentIndex += into->count;
+	}
+	into->count += from->count;
+
+	unlinkBlock(list, from);
+	releaseBlock(from);
+}
+
+/**
+ * Inserts an item so that it ends up at the given index of the block, and makes it the current item.
+ * A NULL block means the list is empty. A full block is split in half, unless the item
+ * belongs at one of its ends and can go in a neighbouring block instead.
+ * Returns 0 if successful, -1 if a block was needed and could not be allocated.
+ */
+static int insertItemAt(ULIST *list, UNODE *block, int index, void *item) {
+	if (block == NULL) {
+		block = allocBlock();
+		if (block == NULL) {
+			return -1;
+		}
+		linkBlockAfter(list, NULL, block);
+		index = 0;
+	} else if (block->count == ULIST_BLOCK_ITEMS) {
+		if (index == 0 && block->previous != NULL && block->previous->count < ULIST_BLOCK_ITEMS) {
+			block = block->previous;
+			index = block->count;
+		} else if (index == ULIST_BLOCK_ITEMS && block->next != NULL
+				&& block->next->count < ULIST_BLOCK_ITEMS) {
+			block = block->next;
+			index = 0;
+		} else {
+			UNODE *newBlock = allocBlock();
+			if (newBlock == NULL) {
+				return -1;
+			}
+			linkBlockAfter(list, block, newBlock);
+
+			if (index == ULIST_BLOCK_ITEMS) {
+				block = newBlock;
+				index = 0;
+			} else {
+				memcpy(newBlock->items, &block->items[HALF_BLOCK_ITEMS],
+					(ULIST_BLOCK_ITEMS - HALF_BLOCK_ITEMS) * sizeof(void *));
+				newBlock->count = ULIST_BLOCK_ITEMS - HALF_BLOCK_ITEMS;
+				block->count = HALF_BLOCK_ITEMS;
+				if (index > HALF_BLOCK_ITEMS) {
+					block = newBlock;
+					index -= HALF_BLOCK_ITEMS;
+				}
+			}
+		}
+	}
+
+	memmove(&block->items[index + 1], &block->items[index], (block->count - index) * sizeof(void *));
+	block->items[index] = item;
+	block->count++;
+
+	list->current = block;
+	list->currentIndex = index;
+	list->currentIsBeyond = 0;
+	list->size++;
+	return 0;
+}
+
+/**
+ * Removes the item at the given index of the block and returns it.
+ * The item after it becomes the current item, or the new last item if it was the last.
+ * Blocks that fall below half full are merged with a neighbour when the items fit.
+ */
+static void *removeItemAt(ULIST *list, UNODE *block, int index) {
+	void *item = block->items[index];
+	int wasLast = block == list->tail && index == block->count - 1;
+
+	memmove(&block->items[index], &block->items[index + 1], (block->count - index - 1) * sizeof(void *));
+	block->count--;
+	list->size--;
+	list->currentIsBeyond = 0;
+
+	if (LIST_IS_EMPTY) {
+		list->current = NULL;
+		list->currentIndex = 0;
+	} else if (wasLast) {
+		list->current = block->count > 0 ? block : block->previous;
+		list->currentIndex = list->current->count - 1;
+	} else if (index < block->count) {
+		list->current = block;
+		list->currentIndex = index;
+	} else {
+		list->current = block->next;
+		list->currentIndex = 0;
+	}
+
+	if (block->count == 0) {
+		unlinkBlock(list, block);
+		releaseBlock(block);
+	} else if (block->count < HALF_BLOCK_ITEMS) {
+		if (block->next != NULL && block->count + block->next->count <= ULIST_BLOCK_ITEMS) {
+			mergeBlocks(list, block, block->next);
+		} else if (block->previous != NULL && block->previous->count + block->count <= ULIST_BLOCK_ITEMS) {
+			mergeBlocks(list, block->previous, block);
+		}
+	}
+	return item;
+}
+
+/**
+ * Returns the index of the first slot of the block from index on that holds item, or -1 if none does.
+ */
+static int findItemInBlock(UNODE *block, int index, void *item) {
+	void **items = block->items;
+	int count = block->count;
+
+#ifdef ULIST_SCAN_AVX2
+	__m256i needle4 = _mm256_set1_epi64x((long long)(uintptr_t)item);
+	for (; index + 4 <= count; index += 4) {
+		__m256i equal = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)&items[index]), needle4);
+		int mask = _mm256_movemask_pd(_mm256_castsi256_pd(equal));
+		if (mask != 0) {
+			return index + __builtin_ctz(mask);
+		}
+	}
+#endif
+#ifdef ULIST_SCAN_SSE2
+	/* SSE2 has no 64-bit compare, so a pointer matches when both of its 32-bit halves do */
+	__m128i needle2 = _mm_set1_epi64x((long long)(uintptr_t)item);
+	for (; index + 2 <= count; index += 2) {
+		__m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)&items[index]), needle2);
+		equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+		int mask = _mm_movemask_pd(_mm_castsi128_pd(equal));
+		if (mask != 0) {
+			return index + __builtin_ctz(mask);
+		}
+	}
+#endif
+
+	for (; index < count; index++) {
+		if (items[index] == item) {
+			return index;
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,50 @@
+#ifndef _ULIST_H_
+#define _ULIST_H_
+
+/**
+ * Unrolled lists: each block holds up to ULIST_BLOCK_ITEMS item pointers in order,
+ * so walking the list mostly reads contiguous memory. The current item is a block
+ * and an index into it, with the same semantics as the current item of a LIST.
+ */
+#define ULIST_BLOCK_ITEMS 13
+
+/**
+ * Structs
+ */
+typedef struct UNODE {
+	void *items[ULIST_BLOCK_ITEMS];
+	struct UNODE *previous;
+	struct UNODE *next;
+	int count; // Number of items in use, always at least 1 for a block in a list
+} UNODE;
+typedef struct ULIST {
+	UNODE *current;
+	int currentIndex; // Index of the current item within the current block
+	UNODE *head;
+	UNODE *tail;
+	int size;
+	int currentIsBeyond; // 0 if current is not beyond the list boundaries, -1 if before, 1 if after
+} ULIST;
+
+/**
+ * Function prototypes
+ */
+ULIST *UListCreate(void);
+int UListCount(ULIST *list);
+void *UListFirst(ULIST *list);
+void *UListLast(ULIST *list);
+void *UListNext(ULIST *list);
+void *UListPrev(ULIST *list);
+void *UListCurr(ULIST *list);
+int UListAdd(ULIST *list, void *item);
+int UListInsert(ULIST *list, void *item);
+int UListAppend(ULIST *list, void *item);
+int UListPrepend(ULIST *list, void *item);
+void *UListRemove(ULIST *list);
+void UListConcat(ULIST *list1, ULIST *list2);
+void UListFree(ULIST *list, void (*itemFree)(void *));
+void *UListTrim(ULIST *list);
+void *UListSearch(ULIST *list, int (*comparator)(void *, void *), void *comparisonArg);
+void *UListSearchPtr(ULIST *list, void *item);
+
+#endif /* _ULIST_H_ */